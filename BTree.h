@@ -0,0 +1,545 @@
+#ifndef REDBLACKTREE_BTREE_H
+#define REDBLACKTREE_BTREE_H
+
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+#include <cstddef>
+
+/**
+ * Picks the minimum degree of a B-tree so that the keys of a full node fill a few cache lines
+ * A node then costs a handful of sequential cache misses instead of one miss per binary tree level
+ */
+template<class Type>
+struct BTreeDefaultDegree
+{
+    static const int CacheLineBytes = 64;
+    static const int CacheLinesPerNode = 4;
+
+    static const int KeysPerNode = CacheLineBytes * CacheLinesPerNode / sizeof(Type);
+    static const int Value = KeysPerNode < 4 ? 2 : (KeysPerNode + 1) / 2;
+};
+
+
+/**
+ * Container for a single node of a B-tree, holding between MinDegree - 1 and 2 * MinDegree - 1 sorted keys
+ * (only the root may hold fewer), and one more child than keys unless it is a leaf
+ */
+template<class Type, int MinDegree>
+struct BTreeNode
+{
+    static const int MaxKeys = 2 * MinDegree - 1;
+
+    BTreeNode(bool Leaf)
+    {
+        NumKeys = 0;
+        IsLeaf = Leaf;
+        std::fill(Children, Children + MaxKeys + 1, nullptr);
+    }
+
+    ~BTreeNode()
+    {
+        if (!IsLeaf)
+        {
+            for (int i = 0; i <= NumKeys; i++)
+            {
+                delete Children[i];
+            }
+        }
+    }
+
+    /** Position of the first key that is not smaller than the key passed as parameter */
+    int LowerBound(const Type &KeyToFind) const
+    {
+        return static_cast<int>(std::lower_bound(Keys, Keys + NumKeys, KeyToFind) - Keys);
+    }
+
+    /** Is this node holding as many keys as it can? */
+    bool IsFull() const
+    {
+        return NumKeys == MaxKeys;
+    }
+
+    int NumKeys;
+    bool IsLeaf;
+    Type Keys[MaxKeys];
+    BTreeNode* Children[MaxKeys + 1];
+
+};  //end BTreeNode definition
+
+
+/**
+ * B-tree with the same public interface as RedBlackTree, so either can be used behind a template alias such as
+ *     template<class Type> using OrderedSet = BTree<Type>;
+ * Keys are stored sorted inside wide nodes, so a search touches O(log n / log MinDegree) nodes
+ * Insertion splits full nodes and deletion refills minimal nodes on the way down, so both make a single pass
+ *
+ * Assumes that any templated type is default constructible and has valid comparison operators
+ * @tparam MinDegree Every node but the root holds at least MinDegree - 1 and at most 2 * MinDegree - 1 keys
+ */
+template<class Type, int MinDegree = BTreeDefaultDegree<Type>::Value>
+class BTree
+{
+    static_assert(MinDegree >= 2, "A B-tree needs a minimum degree of at least 2");
+
+public:
+    BTree();
+
+    ~BTree();
+
+    /**
+     * Inserts the given key into the tree, if it is not already in the tree
+     * @param NewKey The new key to insert into the tree
+     */
+    void Insert(const Type NewKey);
+
+    /**
+     * Removes the given key from the tree, if it exists in the tree
+     * @param KeyToDelete The key to delete from the tree
+     */
+    void Delete(const Type KeyToDelete);
+
+    /**
+     * Finds the key passed as parameter in the tree, if it exists
+     * @param KeyToFind The key to search for in the tree
+     * @return true if key is in the tree, false otherwise
+     */
+    bool Find(const Type KeyToFind) const;
+
+    /**
+     * Finds the smallest key in the tree
+     * @return The smallest key in the tree
+     * @throws std::out_of_range if the tree is empty
+     */
+    Type FindMin() const;
+
+    /**
+     * Finds the largest key in the tree
+     * @return The largest key in the tree
+     * @throws std::out_of_range if the tree is empty
+     */
+    Type FindMax() const;
+
+    /***
+     * Makes and returns a sorted array of all elements in the tree
+     * @return A pointer to the first element of the newly created array
+     */
+    Type* MakeArray() const;
+
+    /** Getter function to retrieve size of the tree */
+    std::size_t GetSize() const;
+
+    /** Number of edges on the path from the root to any leaf; every leaf is at the same depth */
+    int GetHeight() const;
+
+private:
+    /**
+     * Splits the full child at the given position in two, moving its middle key up into the parent
+     * Assumes that the parent is not full
+     * @param Par Parent of the child to split
+     * @param ChildIndex Position of the child in its parent
+     */
+    void SplitChild(BTreeNode<Type, MinDegree>* Par, int ChildIndex);
+
+    /**
+     * Merges the child at the given position with its right sibling, pulling the key between them down
+     * Assumes that both children hold MinDegree - 1 keys
+     * @param Par Parent of the children to merge
+     * @param ChildIndex Position of the left child in its parent
+     */
+    void MergeChildren(BTreeNode<Type, MinDegree>* Par, int ChildIndex);
+
+    /**
+     * Makes sure the child at the given position holds at least MinDegree keys before the deletion descends into it,
+     * borrowing a key from a sibling or merging with one
+     * @param Par Parent of the child
+     * @param ChildIndex Position of the child in its parent
+     * @return Position of the child to descend into, which moves left if it was merged into its left sibling
+     */
+    int FillChild(BTreeNode<Type, MinDegree>* Par, int ChildIndex);
+
+    /**
+     * Removes the key from the subtree rooted at the node passed as parameter
+     * Assumes that the node holds at least MinDegree keys, or is the root
+     * @param A Root of the subtree
+     * @param KeyToDelete The key to delete from the subtree
+     */
+    void DeleteIntl(BTreeNode<Type, MinDegree>* A, const Type &KeyToDelete);
+
+    /**
+     * Performs an in order traversal of the tree, filling an array with each element as needed
+     * @param A Current node for recursive fill
+     * @param Arr Array containing the sorted keys; is assumed to be of size at least equal to the tree size
+     * @param CurrElement Counter for which position we are currently filling in the array
+     */
+    void InOrderFill(BTreeNode<Type, MinDegree>* A, Type* Arr, std::size_t &CurrElement) const;
+
+    /** Root node in the tree */
+    BTreeNode<Type, MinDegree>* Root;
+
+    /** The current number of keys stored in the tree */
+    std::size_t Size;
+
+};  //end BTree definition
+
+
+
+template<class Type, int MinDegree>
+BTree<Type, MinDegree>::BTree()
+{
+    Root = nullptr;
+    Size = 0;
+}
+
+template<class Type, int MinDegree>
+BTree<Type, MinDegree>::~BTree()
+{
+    delete Root;
+}
+
+template<class Type, int MinDegree>
+void BTree<Type, MinDegree>::Insert(const Type NewKey)
+{
+    if (!Root)
+    {
+        Root = new BTreeNode<Type, MinDegree>(true);
+    }
+
+    //a full root is split first, which is the only way the tree grows taller
+    if (Root->IsFull())
+    {
+        BTreeNode<Type, MinDegree>* NewRoot = new BTreeNode<Type, MinDegree>(false);
+        NewRoot->Children[0] = Root;
+        Root = NewRoot;
+        SplitChild(Root, 0);
+    }
+
+    BTreeNode<Type, MinDegree>* CurrNode = Root;
+    while (true)
+    {
+        int i = CurrNode->LowerBound(NewKey);
+        if (i < CurrNode->NumKeys && CurrNode->Keys[i] == NewKey)
+        {
+            return;
+        }
+
+        if (CurrNode->IsLeaf)
+        {
+            std::copy_backward(CurrNode->Keys + i, CurrNode->Keys + CurrNode->NumKeys,
+                               CurrNode->Keys + CurrNode->NumKeys + 1);
+            CurrNode->Keys[i] = NewKey;
+            CurrNode->NumKeys++;
+            Size++;
+            return;
+        }
+
+        //split a full child before stepping into it, so there is always room for a key coming up from below
+        if (CurrNode->Children[i]->IsFull())
+        {
+            SplitChild(CurrNode, i);
+            if (CurrNode->Keys[i] == NewKey)
+            {
+                return;
+            }
+            if (CurrNode->Keys[i] < NewKey)
+            {
+                i++;
+            }
+        }
+
+        CurrNode = CurrNode->Children[i];
+    }
+}
+
+template<class Type, int MinDegree>
+void BTree<Type, MinDegree>::Delete(const Type KeyToDelete)
+{
+    if (!Root)
+    {
+        return;
+    }
+
+    DeleteIntl(Root, KeyToDelete);
+
+    //an empty root either means the tree is empty, or that its only child becomes the new root
+    if (Root->NumKeys == 0)
+    {
+        BTreeNode<Type, MinDegree>* OldRoot = Root;
+        Root = Root->IsLeaf ? nullptr : Root->Children[0];
+
+        OldRoot->IsLeaf = true;
+        delete OldRoot;
+    }
+}
+
+template<class Type, int MinDegree>
+bool BTree<Type, MinDegree>::Find(const Type KeyToFind) const
+{
+    BTreeNode<Type, MinDegree>* CurrNode = Root;
+    while (CurrNode)
+    {
+        int i = CurrNode->LowerBound(KeyToFind);
+        if (i < CurrNode->NumKeys && CurrNode->Keys[i] == KeyToFind)
+        {
+            return true;
+        }
+
+        CurrNode = CurrNode->IsLeaf ? nullptr : CurrNode->Children[i];
+    }
+    return false;
+}
+
+template<class Type, int MinDegree>
+Type BTree<Type, MinDegree>::FindMin() const
+{
+    if (Size == 0)
+    {
+        throw std::out_of_range("FindMin called on an empty BTree");
+    }
+
+    BTreeNode<Type, MinDegree>* CurrNode = Root;
+    while (!CurrNode->IsLeaf)
+    {
+        CurrNode = CurrNode->Children[0];
+    }
+    return CurrNode->Keys[0];
+}
+
+template<class Type, int MinDegree>
+Type BTree<Type, MinDegree>::FindMax() const
+{
+    if (Size == 0)
+    {
+        throw std::out_of_range("FindMax called on an empty BTree");
+    }
+
+    BTreeNode<Type, MinDegree>* CurrNode = Root;
+    while (!CurrNode->IsLeaf)
+    {
+        CurrNode = CurrNode->Children[CurrNode->NumKeys];
+    }
+    return CurrNode->Keys[CurrNode->NumKeys - 1];
+}
+
+template<class Type, int MinDegree>
+Type* BTree<Type, MinDegree>::MakeArray() const
+{
+    Type* Arr = new Type[this->Size];
+    std::size_t x = 0;
+    InOrderFill(this->Root, Arr, x);
+    return Arr;
+}
+
+template<class Type, int MinDegree>
+std::size_t BTree<Type, MinDegree>::GetSize() const
+{
+    return Size;
+}
+
+template<class Type, int MinDegree>
+int BTree<Type, MinDegree>::GetHeight() const
+{
+    if (!Root)
+    {
+        return -1;
+    }
+
+    int Height = 0;
+    for (BTreeNode<Type, MinDegree>* CurrNode = Root; !CurrNode->IsLeaf; CurrNode = CurrNode->Children[0])
+    {
+        Height++;
+    }
+    return Height;
+}
+
+template<class Type, int MinDegree>
+void BTree<Type, MinDegree>::SplitChild(BTreeNode<Type, MinDegree>* Par, int ChildIndex)
+{
+    BTreeNode<Type, MinDegree>* Left = Par->Children[ChildIndex];
+    BTreeNode<Type, MinDegree>* Right = new BTreeNode<Type, MinDegree>(Left->IsLeaf);
+
+    //the upper MinDegree - 1 keys, and the children around them, move to the new right node
+    std::copy(Left->Keys + MinDegree, Left->Keys + Left->NumKeys, Right->Keys);
+    if (!Left->IsLeaf)
+    {
+        std::copy(Left->Children + MinDegree, Left->Children + Left->NumKeys + 1, Right->Children);
+    }
+    Right->NumKeys = MinDegree - 1;
+    Left->NumKeys = MinDegree - 1;
+
+    //make room in the parent for the middle key and the new child
+    std::copy_backward(Par->Keys + ChildIndex, Par->Keys + Par->NumKeys, Par->Keys + Par->NumKeys + 1);
+    std::copy_backward(Par->Children + ChildIndex + 1, Par->Children + Par->NumKeys + 1,
+                       Par->Children + Par->NumKeys + 2);
+
+    Par->Keys[ChildIndex] = Left->Keys[MinDegree - 1];
+    Par->Children[ChildIndex + 1] = Right;
+    Par->NumKeys++;
+}
+
+template<class Type, int MinDegree>
+void BTree<Type, MinDegree>::MergeChildren(BTreeNode<Type, MinDegree>* Par, int ChildIndex)
+{
+    BTreeNode<Type, MinDegree>* Left = Par->Children[ChildIndex];
+    BTreeNode<Type, MinDegree>* Right = Par->Children[ChildIndex + 1];
+
+    Left->Keys[Left->NumKeys] = Par->Keys[ChildIndex];
+    std::copy(Right->Keys, Right->Keys + Right->NumKeys, Left->Keys + Left->NumKeys + 1);
+    if (!Left->IsLeaf)
+    {
+        std::copy(Right->Children, Right->Children + Right->NumKeys + 1, Left->Children + Left->NumKeys + 1);
+    }
+    Left->NumKeys += Right->NumKeys + 1;
+
+    //close the gap the key and the right child leave in the parent
+    std::copy(Par->Keys + ChildIndex + 1, Par->Keys + Par->NumKeys, Par->Keys + ChildIndex);
+    std::copy(Par->Children + ChildIndex + 2, Par->Children + Par->NumKeys + 1, Par->Children + ChildIndex + 1);
+    Par->NumKeys--;
+
+    //the right node's children now belong to the left one, so it must not free them
+    Right->IsLeaf = true;
+    delete Right;
+}
+
+template<class Type, int MinDegree>
+int BTree<Type, MinDegree>::FillChild(BTreeNode<Type, MinDegree>* Par, int ChildIndex)
+{
+    BTreeNode<Type, MinDegree>* Child = Par->Children[ChildIndex];
+
+    //borrow the largest key of the left sibling, rotating it through the parent
+    if (ChildIndex > 0 && Par->Children[ChildIndex - 1]->NumKeys >= MinDegree)
+    {
+        BTreeNode<Type, MinDegree>* Sibling = Par->Children[ChildIndex - 1];
+
+        std::copy_backward(Child->Keys, Child->Keys + Child->NumKeys, Child->Keys + Child->NumKeys + 1);
+        Child->Keys[0] = Par->Keys[ChildIndex - 1];
+        if (!Child->IsLeaf)
+        {
+            std::copy_backward(Child->Children, Child->Children + Child->NumKeys + 1,
+                               Child->Children + Child->NumKeys + 2);
+            Child->Children[0] = Sibling->Children[Sibling->NumKeys];
+        }
+        Child->NumKeys++;
+
+        Par->Keys[ChildIndex - 1] = Sibling->Keys[Sibling->NumKeys - 1];
+        Sibling->NumKeys--;
+        return ChildIndex;
+    }
+
+    //borrow the smallest key of the right sibling, rotating it through the parent
+    if (ChildIndex < Par->NumKeys && Par->Children[ChildIndex + 1]->NumKeys >= MinDegree)
+    {
+        BTreeNode<Type, MinDegree>* Sibling = Par->Children[ChildIndex + 1];
+
+        Child->Keys[Child->NumKeys] = Par->Keys[ChildIndex];
+        if (!Child->IsLeaf)
+        {
+            Child->Children[Child->NumKeys + 1] = Sibling->Children[0];
+            std::copy(Sibling->Children + 1, Sibling->Children + Sibling->NumKeys + 1, Sibling->Children);
+        }
+        Child->NumKeys++;
+
+        Par->Keys[ChildIndex] = Sibling->Keys[0];
+        std::copy(Sibling->Keys + 1, Sibling->Keys + Sibling->NumKeys, Sibling->Keys);
+        Sibling->NumKeys--;
+        return ChildIndex;
+    }
+
+    //both siblings are minimal, so merge with one of them
+    if (ChildIndex < Par->NumKeys)
+    {
+        MergeChildren(Par, ChildIndex);
+        return ChildIndex;
+    }
+
+    MergeChildren(Par, ChildIndex - 1);
+    return ChildIndex - 1;
+}
+
+template<class Type, int MinDegree>
+void BTree<Type, MinDegree>::DeleteIntl(BTreeNode<Type, MinDegree>* A, const Type &KeyToDelete)
+{
+    int i = A->LowerBound(KeyToDelete);
+    bool InThisNode = i < A->NumKeys && A->Keys[i] == KeyToDelete;
+
+    //case 1: the key is in a leaf, which is known to have a key to spare
+    if (A->IsLeaf)
+    {
+        if (InThisNode)
+        {
+            std::copy(A->Keys + i + 1, A->Keys + A->NumKeys, A->Keys + i);
+            A->NumKeys--;
+            Size--;
+        }
+        return;
+    }
+
+    if (InThisNode)
+    {
+        BTreeNode<Type, MinDegree>* Left = A->Children[i];
+        BTreeNode<Type, MinDegree>* Right = A->Children[i + 1];
+
+        //case 2a: replace the key with its predecessor, then delete the predecessor from the left child
+        if (Left->NumKeys >= MinDegree)
+        {
+            BTreeNode<Type, MinDegree>* Pred = Left;
+            while (!Pred->IsLeaf)
+            {
+                Pred = Pred->Children[Pred->NumKeys];
+            }
+            A->Keys[i] = Pred->Keys[Pred->NumKeys - 1];
+            DeleteIntl(Left, A->Keys[i]);
+        }
+            //case 2b: replace the key with its successor, then delete the successor from the right child
+        else if (Right->NumKeys >= MinDegree)
+        {
+            BTreeNode<Type, MinDegree>* Succ = Right;
+            while (!Succ->IsLeaf)
+            {
+                Succ = Succ->Children[0];
+            }
+            A->Keys[i] = Succ->Keys[0];
+            DeleteIntl(Right, A->Keys[i]);
+        }
+            //case 2c: both children are minimal; merge them around the key and delete it from the merged node
+        else
+        {
+            MergeChildren(A, i);
+            DeleteIntl(Left, KeyToDelete);
+        }
+        return;
+    }
+
+    //case 3: the key can only be below child i; make sure that child can lose a key before descending
+    if (A->Children[i]->NumKeys < MinDegree)
+    {
+        i = FillChild(A, i);
+    }
+    DeleteIntl(A->Children[i], KeyToDelete);
+}
+
+template<class Type, int MinDegree>
+void BTree<Type, MinDegree>::InOrderFill(BTreeNode<Type, MinDegree>* A, Type* Arr, std::size_t &CurrElement) const
+{
+    if (!A)
+    {
+        return;
+    }
+
+    for (int i = 0; i < A->NumKeys; i++)
+    {
+        if (!A->IsLeaf)
+        {
+            InOrderFill(A->Children[i], Arr, CurrElement);
+        }
+        Arr[CurrElement] = A->Keys[i];
+        CurrElement++;
+    }
+
+    if (!A->IsLeaf)
+    {
+        InOrderFill(A->Children[A->NumKeys], Arr, CurrElement);
+    }
+}
+
+#endif //REDBLACKTREE_BTREE_H
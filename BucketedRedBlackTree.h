@@ -0,0 +1,542 @@
+#ifndef REDBLACKTREE_BUCKETEDREDBLACKTREE_H
+#define REDBLACKTREE_BUCKETEDREDBLACKTREE_H
+
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+#include <cstddef>
+#include "RedBlackTree.h"
+
+/**
+ * Container for a single node of a bucketed red black tree: a small sorted array of keys, its colour, its parent,
+ * and two siblings
+ * Every key in the left subtree is smaller than Keys[0], and every key in the right subtree is larger than
+ * Keys[Count - 1]
+ */
+template<class Type, int Capacity>
+struct BucketNode
+{
+    enum NodeColour
+    {
+        Red, Black
+    };
+
+    BucketNode()
+    {
+        Parent = RChild = LChild = nullptr;
+        Count = 0;
+    }
+
+    ~BucketNode()
+    {
+        delete RChild;
+        delete LChild;
+    }
+
+    /** Tests to see if this node is black */
+    static bool TestColourBlack(const BucketNode* TestNode)
+    {
+        return !TestNode || TestNode->Colour == NodeColour::Black;
+    }
+
+    /** Tests to see if this node is red */
+    static bool TestColourRed(const BucketNode* TestNode)
+    {
+        return TestNode && TestNode->Colour == NodeColour::Red;
+    }
+
+    /**
+     * Position of the first key that is not smaller than the key passed as parameter
+     * Counts the smaller keys without branching on them, so the scan can be vectorized for arithmetic keys
+     */
+    int LowerBound(const Type &KeyToFind) const
+    {
+        int Pos = 0;
+        for (int i = 0; i < Count; i++)
+        {
+            Pos += Keys[i] < KeyToFind;
+        }
+        return Pos;
+    }
+
+    /** Inserts the key at the given position, shifting the larger keys up; assumes the bucket is not full */
+    void InsertAt(int Pos, const Type &NewKey)
+    {
+        std::copy_backward(Keys + Pos, Keys + Count, Keys + Count + 1);
+        Keys[Pos] = NewKey;
+        Count++;
+    }
+
+    /** Removes the key at the given position, shifting the larger keys down */
+    void RemoveAt(int Pos)
+    {
+        std::copy(Keys + Pos + 1, Keys + Count, Keys + Pos);
+        Count--;
+    }
+
+    BucketNode* Parent;
+    BucketNode* RChild;
+    BucketNode* LChild;
+    NodeColour Colour;
+    int Count;
+    Type Keys[Capacity];
+
+};  //end BucketNode definition
+
+
+/**
+ * Red black tree whose nodes each hold a sorted bucket of up to BucketCapacity keys
+ * Pointer overhead and tree height shrink by roughly the bucket occupancy, while balancing is still done by the
+ * shared red black algorithms, one node per bucket
+ * A full bucket splits in two on insertion; a bucket that falls below a quarter full on deletion is emptied into
+ * a neighbouring bucket when that neighbour has room, and an empty bucket is removed from the tree
+ *
+ * Assumes that any templated type is default constructible and has valid comparison operators
+ */
+template<class Type, int BucketCapacity = 32>
+class BucketedRedBlackTree
+{
+    static_assert(BucketCapacity >= 2, "A bucket needs room for at least two keys to be split");
+
+public:
+    BucketedRedBlackTree();
+
+    ~BucketedRedBlackTree();
+
+    /**
+     * Inserts the given key into the tree, if it is not already in the tree
+     * @param NewKey The new key to insert into the tree
+     */
+    void Insert(const Type NewKey);
+
+    /**
+     * Removes the given key from the tree, if it exists in the tree
+     * @param KeyToDelete The key to delete from the tree
+     */
+    void Delete(const Type KeyToDelete);
+
+    /**
+     * Finds the key passed as parameter in the tree, if it exists
+     * @param KeyToFind The key to search for in the tree
+     * @return true if key is in the tree, false otherwise
+     */
+    bool Find(const Type KeyToFind) const;
+
+    /**
+     * Finds the smallest key in the tree
+     * @return The smallest key in the tree
+     * @throws std::out_of_range if the tree is empty
+     */
+    Type FindMin() const;
+
+    /**
+     * Finds the largest key in the tree
+     * @return The largest key in the tree
+     * @throws std::out_of_range if the tree is empty
+     */
+    Type FindMax() const;
+
+    /***
+     * Makes and returns a sorted array of all elements in the tree
+     * Each bucket is copied as one contiguous block
+     * @return A pointer to the first element of the newly created array
+     */
+    Type* MakeArray() const;
+
+    /** Getter function to retrieve size of the tree */
+    std::size_t GetSize() const;
+
+    /** Getter function to retrieve the number of buckets, which is the number of nodes in the tree */
+    std::size_t GetBucketCount() const;
+
+    int GetHeight() const;
+    int GetBlackHeight() const;
+
+private:
+    typedef BucketNode<Type, BucketCapacity> Bucket;
+    typedef RedBlackAlgorithms<Bucket> Algorithms;
+
+    /**
+     * Returns the bucket whose key range covers the key passed as parameter
+     * If no bucket covers it, then the bucket the search stopped at is returned; it is next to the key in sorted
+     * order, so the key can be added to either end of it without breaking the order of the tree
+     * Assumes that the tree is not empty
+     * @param KeyToFind The key to search for
+     * @return The bucket covering the key, or the bucket the key should be added to
+     */
+    Bucket* FindIntl(const Type KeyToFind) const;
+
+    /**
+     * Moves the upper half of a full bucket into a new bucket, which is linked in as its in order successor
+     * @param Full The bucket to split
+     * @return The new bucket holding the upper half
+     */
+    Bucket* SplitBucket(Bucket* Full);
+
+    /**
+     * Removes an under-full bucket by moving its keys into a neighbouring bucket, if either neighbour has room
+     * An empty bucket is always removed
+     * @param Sparse The bucket to try to remove
+     */
+    void AbsorbBucket(Bucket* Sparse);
+
+    /**
+     * Unlinks a bucket from the tree and frees it
+     * @param BucketToRemove The bucket to remove; its keys are discarded
+     */
+    void RemoveBucket(Bucket* BucketToRemove);
+
+    /** Returns the bucket following the one passed as parameter in sorted order, or nullptr if it is the last */
+    static Bucket* NextBucket(Bucket* Curr);
+
+    /** Returns the bucket preceding the one passed as parameter in sorted order, or nullptr if it is the first */
+    static Bucket* PrevBucket(Bucket* Curr);
+
+    int GetHeightIntl(Bucket* Curr) const;
+    int GetBlackHeightIntl(Bucket* Curr) const;
+
+    /**
+     * Performs an in order traversal of the tree, copying each bucket into the array as needed
+     * @param A Current bucket for recursive fill
+     * @param Arr Array containing the sorted keys; is assumed to be of size at least equal to the tree size
+     * @param CurrElement Counter for which position we are currently filling in the array
+     */
+    void InOrderFill(Bucket* A, Type* Arr, std::size_t &CurrElement) const;
+
+    /** Root bucket in the tree */
+    Bucket* Root;
+
+    /** The current number of keys stored in the tree */
+    std::size_t Size;
+
+    /** The current number of buckets in the tree */
+    std::size_t BucketCount;
+
+};  //end BucketedRedBlackTree definition
+
+
+
+template<class Type, int BucketCapacity>
+BucketedRedBlackTree<Type, BucketCapacity>::BucketedRedBlackTree()
+{
+    Root = nullptr;
+    Size = BucketCount = 0;
+}
+
+template<class Type, int BucketCapacity>
+BucketedRedBlackTree<Type, BucketCapacity>::~BucketedRedBlackTree()
+{
+    delete Root;
+}
+
+template<class Type, int BucketCapacity>
+void BucketedRedBlackTree<Type, BucketCapacity>::Insert(const Type NewKey)
+{
+    //if the root is null, then the key starts the first bucket, which becomes the black root
+    if (!Root)
+    {
+        Root = new Bucket();
+        Root->Colour = Bucket::NodeColour::Black;
+        Root->InsertAt(0, NewKey);
+        Size = BucketCount = 1;
+        return;
+    }
+
+    Bucket* Target = FindIntl(NewKey);
+    int Pos = Target->LowerBound(NewKey);
+    if (Pos < Target->Count && Target->Keys[Pos] == NewKey)
+    {
+        return;
+    }
+
+    if (Target->Count == BucketCapacity)
+    {
+        Bucket* Upper = SplitBucket(Target);
+        if (Pos > Target->Count)
+        {
+            Pos -= Target->Count;
+            Target = Upper;
+        }
+    }
+
+    Target->InsertAt(Pos, NewKey);
+    Size++;
+}
+
+template<class Type, int BucketCapacity>
+void BucketedRedBlackTree<Type, BucketCapacity>::Delete(const Type KeyToDelete)
+{
+    if (!Root)
+    {
+        return;
+    }
+
+    Bucket* Target = FindIntl(KeyToDelete);
+    int Pos = Target->LowerBound(KeyToDelete);
+    if (Pos == Target->Count || Target->Keys[Pos] != KeyToDelete)
+    {
+        return;
+    }
+
+    Target->RemoveAt(Pos);
+    Size--;
+
+    if (Target->Count < BucketCapacity / 4 || Target->Count == 0)
+    {
+        AbsorbBucket(Target);
+    }
+}
+
+template<class Type, int BucketCapacity>
+bool BucketedRedBlackTree<Type, BucketCapacity>::Find(const Type KeyToFind) const
+{
+    if (!Root)
+    {
+        return false;
+    }
+
+    Bucket* Target = FindIntl(KeyToFind);
+    int Pos = Target->LowerBound(KeyToFind);
+    return Pos < Target->Count && Target->Keys[Pos] == KeyToFind;
+}
+
+template<class Type, int BucketCapacity>
+Type BucketedRedBlackTree<Type, BucketCapacity>::FindMin() const
+{
+    if (Size == 0)
+    {
+        throw std::out_of_range("FindMin called on an empty BucketedRedBlackTree");
+    }
+
+    Bucket* CurrNode = Root;
+    while (CurrNode->LChild)
+    {
+        CurrNode = CurrNode->LChild;
+    }
+    return CurrNode->Keys[0];
+}
+
+template<class Type, int BucketCapacity>
+Type BucketedRedBlackTree<Type, BucketCapacity>::FindMax() const
+{
+    if (Size == 0)
+    {
+        throw std::out_of_range("FindMax called on an empty BucketedRedBlackTree");
+    }
+
+    Bucket* CurrNode = Root;
+    while (CurrNode->RChild)
+    {
+        CurrNode = CurrNode->RChild;
+    }
+    return CurrNode->Keys[CurrNode->Count - 1];
+}
+
+template<class Type, int BucketCapacity>
+Type* BucketedRedBlackTree<Type, BucketCapacity>::MakeArray() const
+{
+    Type* Arr = new Type[this->Size];
+    std::size_t x = 0;
+    InOrderFill(this->Root, Arr, x);
+    return Arr;
+}
+
+template<class Type, int BucketCapacity>
+std::size_t BucketedRedBlackTree<Type, BucketCapacity>::GetSize() const
+{
+    return Size;
+}
+
+template<class Type, int BucketCapacity>
+std::size_t BucketedRedBlackTree<Type, BucketCapacity>::GetBucketCount() const
+{
+    return BucketCount;
+}
+
+template<class Type, int BucketCapacity>
+int BucketedRedBlackTree<Type, BucketCapacity>::GetHeight() const
+{
+    return GetHeightIntl(Root);
+}
+
+template<class Type, int BucketCapacity>
+int BucketedRedBlackTree<Type, BucketCapacity>::GetBlackHeight() const
+{
+    return GetBlackHeightIntl(Root);
+}
+
+template<class Type, int BucketCapacity>
+typename BucketedRedBlackTree<Type, BucketCapacity>::Bucket*
+BucketedRedBlackTree<Type, BucketCapacity>::FindIntl(const Type KeyToFind) const
+{
+    Bucket* Par = nullptr;
+    Bucket* CurrNode = Root;
+    while (CurrNode)
+    {
+        Par = CurrNode;
+        if (KeyToFind < CurrNode->Keys[0])
+        {
+            CurrNode = CurrNode->LChild;
+        }
+        else if (CurrNode->Keys[CurrNode->Count - 1] < KeyToFind)
+        {
+            CurrNode = CurrNode->RChild;
+        }
+        else
+        {
+            return CurrNode;
+        }
+    }
+
+    return Par;
+}
+
+template<class Type, int BucketCapacity>
+typename BucketedRedBlackTree<Type, BucketCapacity>::Bucket*
+BucketedRedBlackTree<Type, BucketCapacity>::SplitBucket(Bucket* Full)
+{
+    Bucket* Upper = new Bucket();
+    int Half = Full->Count / 2;
+    std::copy(Full->Keys + Half, Full->Keys + Full->Count, Upper->Keys);
+    Upper->Count = Full->Count - Half;
+    Full->Count = Half;
+
+    //the successor slot is the right child, or else the left child of the smallest bucket in the right subtree
+    if (!Full->RChild)
+    {
+        Full->RChild = Upper;
+        Upper->Parent = Full;
+    }
+    else
+    {
+        Bucket* Par = Full->RChild;
+        while (Par->LChild)
+        {
+            Par = Par->LChild;
+        }
+        Par->LChild = Upper;
+        Upper->Parent = Par;
+    }
+
+    Upper->Colour = Bucket::NodeColour::Red;
+    BucketCount++;
+    Algorithms::FixInsertion(Upper, Root);
+    return Upper;
+}
+
+template<class Type, int BucketCapacity>
+void BucketedRedBlackTree<Type, BucketCapacity>::AbsorbBucket(Bucket* Sparse)
+{
+    if (Sparse->Count > 0)
+    {
+        //every key of the bucket falls between its neighbours, so it can join the front of the next bucket
+        //or the back of the previous one without any of them moving past another
+        Bucket* Next = NextBucket(Sparse);
+        Bucket* Prev = PrevBucket(Sparse);
+        if (Next && Next->Count + Sparse->Count <= BucketCapacity)
+        {
+            std::copy_backward(Next->Keys, Next->Keys + Next->Count, Next->Keys + Next->Count + Sparse->Count);
+            std::copy(Sparse->Keys, Sparse->Keys + Sparse->Count, Next->Keys);
+            Next->Count += Sparse->Count;
+        }
+        else if (Prev && Prev->Count + Sparse->Count <= BucketCapacity)
+        {
+            std::copy(Sparse->Keys, Sparse->Keys + Sparse->Count, Prev->Keys + Prev->Count);
+            Prev->Count += Sparse->Count;
+        }
+        else
+        {
+            return;
+        }
+    }
+
+    RemoveBucket(Sparse);
+}
+
+template<class Type, int BucketCapacity>
+void BucketedRedBlackTree<Type, BucketCapacity>::RemoveBucket(Bucket* BucketToRemove)
+{
+    Algorithms::Erase(BucketToRemove, Root);
+    delete BucketToRemove;
+    BucketCount--;
+}
+
+template<class Type, int BucketCapacity>
+typename BucketedRedBlackTree<Type, BucketCapacity>::Bucket*
+BucketedRedBlackTree<Type, BucketCapacity>::NextBucket(Bucket* Curr)
+{
+    if (Curr->RChild)
+    {
+        Curr = Curr->RChild;
+        while (Curr->LChild)
+        {
+            Curr = Curr->LChild;
+        }
+        return Curr;
+    }
+
+    while (Curr->Parent && Curr->Parent->RChild == Curr)
+    {
+        Curr = Curr->Parent;
+    }
+    return Curr->Parent;
+}
+
+template<class Type, int BucketCapacity>
+typename BucketedRedBlackTree<Type, BucketCapacity>::Bucket*
+BucketedRedBlackTree<Type, BucketCapacity>::PrevBucket(Bucket* Curr)
+{
+    if (Curr->LChild)
+    {
+        Curr = Curr->LChild;
+        while (Curr->RChild)
+        {
+            Curr = Curr->RChild;
+        }
+        return Curr;
+    }
+
+    while (Curr->Parent && Curr->Parent->LChild == Curr)
+    {
+        Curr = Curr->Parent;
+    }
+    return Curr->Parent;
+}
+
+template<class Type, int BucketCapacity>
+int BucketedRedBlackTree<Type, BucketCapacity>::GetHeightIntl(Bucket* Curr) const
+{
+    if (!Curr)
+    {
+        return -1;
+    }
+
+    return std::max(GetHeightIntl(Curr->LChild), GetHeightIntl(Curr->RChild)) + 1;
+}
+
+template<class Type, int BucketCapacity>
+int BucketedRedBlackTree<Type, BucketCapacity>::GetBlackHeightIntl(Bucket* Curr) const
+{
+    if (!Curr)
+    {
+        return 0;
+    }
+
+    return GetBlackHeightIntl(Curr->LChild) + (Bucket::TestColourBlack(Curr) ? 1 : 0);
+}
+
+template<class Type, int BucketCapacity>
+void BucketedRedBlackTree<Type, BucketCapacity>::InOrderFill(Bucket* A, Type* Arr, std::size_t &CurrElement) const
+{
+    if (!A)
+    {
+        return;
+    }
+
+    InOrderFill(A->LChild, Arr, CurrElement);
+    std::copy(A->Keys, A->Keys + A->Count, Arr + CurrElement);
+    CurrElement += A->Count;
+    InOrderFill(A->RChild, Arr, CurrElement);
+}
+
+#endif //REDBLACKTREE_BUCKETEDREDBLACKTREE_H
@@ -0,0 +1,284 @@
+#ifndef REDBLACKTREE_BUFFEREDREDBLACKTREE_H
+#define REDBLACKTREE_BUFFEREDREDBLACKTREE_H
+
+#include <iostream>
+#include <algorithm>
+#include <functional>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "RedBlackTree.h"
+
+/**
+ * Write-optimized red black tree in the style of a log-structured merge tree
+ * Inserts and deletes first go into a small in-memory buffer, made of two small red black trees holding the keys
+ * waiting to be inserted and the keys waiting to be deleted. Once the buffer fills, it is merged into the main tree
+ * in sorted order, so consecutive updates walk down shared, already cached paths instead of each taking its own
+ * cache-missing descent from the root; an insert and a delete of the same key cancel out in the buffer and never
+ * touch the main tree at all
+ *
+ * Find checks the buffer before the main tree, but first asks a small Bloom filter of every key buffered since the
+ * last merge, and only searches the two buffer trees for keys the filter may hold. With about 16 filter bits per
+ * buffered key, both probe bits in one 64 bit word, a find for an unbuffered key costs one extra cache line and a
+ * hash on top of the main tree's search, and only about one in fifty also searches the buffer
+ * Queries over the whole tree merge the buffer first, so they see every update
+ *
+ * Assumes that any templated type has valid comparison operators and a std::hash specialization
+ */
+template<class Type, class Summary = NoSummary>
+class BufferedRedBlackTree
+{
+public:
+    /**
+     * @param BufferCapacity How many buffered updates trigger a merge into the main tree; larger buffers make merges
+     *                       share more of their paths, at the cost of a slightly deeper buffer for Find to check
+     */
+    explicit BufferedRedBlackTree(std::size_t BufferCapacity = 1 << 16);
+
+    /**
+     * Inserts the given key into the tree, if it is not already in the tree
+     * @param NewKey The new key to insert into the tree
+     */
+    void Insert(const Type NewKey);
+
+    /**
+     * Removes the given key from the tree, if it exists in the tree
+     * @param KeyToDelete The key to delete from the tree
+     */
+    void Delete(const Type KeyToDelete);
+
+    /**
+     * Finds the key passed as parameter in the tree, if it exists
+     * @param KeyToFind The key to search for in the tree
+     * @return true if key is in the tree, false otherwise
+     */
+    bool Find(const Type KeyToFind) const;
+
+    /**
+     * Finds the smallest key in the tree, merging the buffer first
+     * @return The smallest key in the tree
+     * @throws std::out_of_range if the tree is empty
+     */
+    Type FindMin();
+
+    /**
+     * Finds the largest key in the tree, merging the buffer first
+     * @return The largest key in the tree
+     * @throws std::out_of_range if the tree is empty
+     */
+    Type FindMax();
+
+    /***
+     * Makes and returns a sorted array of all elements in the tree, merging the buffer first
+     * @return A pointer to the first element of the newly created array
+     */
+    Type* MakeArray();
+
+    /** Merges every buffered update into the main tree, in sorted order */
+    void Flush();
+
+    /** Getter function to retrieve size of the tree, merging the buffer first */
+    std::size_t GetSize();
+
+    /** Getter function to retrieve the number of updates waiting in the buffer */
+    std::size_t GetBufferedCount() const;
+
+    int GetHeight() const;
+
+private:
+    /**
+     * Applies every key of a buffer to the main tree in sorted order, then empties the buffer
+     * @param Buffer The buffer to drain
+     * @param InsertKeys Should the keys be inserted into the main tree, rather than deleted from it?
+     */
+    void Drain(RedBlackTree<Type> &Buffer, bool InsertKeys);
+
+    /** Returns the filter word of a key and sets Mask to its two bits in that word */
+    std::size_t FilterWordOf(const Type &Key, std::uint64_t &Mask) const;
+
+    /** Adds a key to the filter of buffered keys */
+    void AddToFilter(const Type &Key);
+
+    /** Could the key passed as parameter be in the buffer? Never false for a buffered key */
+    bool MayBeBuffered(const Type &Key) const;
+
+    RedBlackTree<Type, Summary> Tree;
+
+    /** Keys waiting to be inserted into Tree, and keys waiting to be deleted from it; never share a key */
+    RedBlackTree<Type> PendingInserts;
+    RedBlackTree<Type> PendingDeletes;
+
+    std::size_t BufferCapacity;
+
+    /** Bloom filter of every key buffered since the last merge; keys cancelled in the buffer stay in it */
+    std::vector<std::uint64_t> Filter;
+
+    /** The number of bits needed to index a filter word */
+    int FilterWordBits;
+
+};  //end BufferedRedBlackTree definition
+
+template<class Type, class Summary>
+BufferedRedBlackTree<Type, Summary>::BufferedRedBlackTree(std::size_t BufferCapacity)
+{
+    this->BufferCapacity = BufferCapacity;
+
+    //16 bits per buffered key, in a power of two number of words
+    FilterWordBits = 0;
+    while (((std::size_t) 64 << FilterWordBits) < BufferCapacity * 16)
+    {
+        FilterWordBits++;
+    }
+    Filter.assign((std::size_t) 1 << FilterWordBits, 0);
+}
+
+template<class Type, class Summary>
+void BufferedRedBlackTree<Type, Summary>::Insert(const Type NewKey)
+{
+    PendingDeletes.Delete(NewKey);
+    PendingInserts.Insert(NewKey);
+    AddToFilter(NewKey);
+
+    if (GetBufferedCount() >= BufferCapacity)
+    {
+        Flush();
+    }
+}
+
+template<class Type, class Summary>
+void BufferedRedBlackTree<Type, Summary>::Delete(const Type KeyToDelete)
+{
+    PendingInserts.Delete(KeyToDelete);
+    PendingDeletes.Insert(KeyToDelete);
+    AddToFilter(KeyToDelete);
+
+    if (GetBufferedCount() >= BufferCapacity)
+    {
+        Flush();
+    }
+}
+
+template<class Type, class Summary>
+bool BufferedRedBlackTree<Type, Summary>::Find(const Type KeyToFind) const
+{
+    if (!MayBeBuffered(KeyToFind))
+    {
+        return Tree.Find(KeyToFind);
+    }
+
+    //the buffer holds the newest update of a key, if it holds one at all
+    if (PendingInserts.Find(KeyToFind))
+    {
+        return true;
+    }
+    if (PendingDeletes.Find(KeyToFind))
+    {
+        return false;
+    }
+    return Tree.Find(KeyToFind);
+}
+
+template<class Type, class Summary>
+Type BufferedRedBlackTree<Type, Summary>::FindMin()
+{
+    Flush();
+    return Tree.FindMin();
+}
+
+template<class Type, class Summary>
+Type BufferedRedBlackTree<Type, Summary>::FindMax()
+{
+    Flush();
+    return Tree.FindMax();
+}
+
+template<class Type, class Summary>
+Type* BufferedRedBlackTree<Type, Summary>::MakeArray()
+{
+    Flush();
+    return Tree.MakeArray();
+}
+
+template<class Type, class Summary>
+void BufferedRedBlackTree<Type, Summary>::Flush()
+{
+    //the two buffers never share a key, so the order they are drained in does not matter
+    Drain(PendingDeletes, false);
+    Drain(PendingInserts, true);
+    std::fill(Filter.begin(), Filter.end(), 0);
+}
+
+template<class Type, class Summary>
+std::size_t BufferedRedBlackTree<Type, Summary>::GetSize()
+{
+    Flush();
+    return Tree.GetSize();
+}
+
+template<class Type, class Summary>
+std::size_t BufferedRedBlackTree<Type, Summary>::GetBufferedCount() const
+{
+    return PendingInserts.GetSize() + PendingDeletes.GetSize();
+}
+
+template<class Type, class Summary>
+int BufferedRedBlackTree<Type, Summary>::GetHeight() const
+{
+    return Tree.GetHeight();
+}
+
+template<class Type, class Summary>
+void BufferedRedBlackTree<Type, Summary>::Drain(RedBlackTree<Type> &Buffer, bool InsertKeys)
+{
+    std::size_t Count = Buffer.GetSize();
+    if (Count == 0)
+    {
+        return;
+    }
+
+    Type* Keys = Buffer.MakeArray();
+    for (std::size_t i = 0; i < Count; i++)
+    {
+        if (InsertKeys)
+        {
+            Tree.Insert(Keys[i]);
+        }
+        else
+        {
+            Tree.Delete(Keys[i]);
+        }
+    }
+
+    Buffer.EraseRange(Keys[0], Keys[Count - 1]);
+    delete[] Keys;
+}
+
+template<class Type, class Summary>
+std::size_t BufferedRedBlackTree<Type, Summary>::FilterWordOf(const Type &Key, std::uint64_t &Mask) const
+{
+    //std::hash is the identity for integers, so spread the hash with a multiplicative step, whose top bits pick the
+    //word. A bit of the product only depends on the key bits at or below it, so the two bits within the word come
+    //from the top of a second mix rather than from the low bits, which aligned or strided keys all share
+    std::uint64_t Hash = (std::uint64_t) std::hash<Type>()(Key) * 0x9E3779B97F4A7C15ull;
+    std::uint64_t Bits = ((Hash ^ (Hash >> 32)) * 0xD6E8FEB86659FD93ull) >> 52;
+    Mask = ((std::uint64_t) 1 << (Bits & 63)) | ((std::uint64_t) 1 << ((Bits >> 6) & 63));
+    return FilterWordBits ? (std::size_t) (Hash >> (64 - FilterWordBits)) : 0;
+}
+
+template<class Type, class Summary>
+void BufferedRedBlackTree<Type, Summary>::AddToFilter(const Type &Key)
+{
+    std::uint64_t Mask;
+    std::size_t Word = FilterWordOf(Key, Mask);
+    Filter[Word] |= Mask;
+}
+
+template<class Type, class Summary>
+bool BufferedRedBlackTree<Type, Summary>::MayBeBuffered(const Type &Key) const
+{
+    std::uint64_t Mask;
+    std::size_t Word = FilterWordOf(Key, Mask);
+    return (Filter[Word] & Mask) == Mask;
+}
+
+#endif //REDBLACKTREE_BUFFEREDREDBLACKTREE_H
@@ -0,0 +1,289 @@
+#ifndef REDBLACKTREE_CACHEDREDBLACKTREE_H
+#define REDBLACKTREE_CACHEDREDBLACKTREE_H
+
+#include <iostream>
+#include <algorithm>
+#include <functional>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "RedBlackTree.h"
+
+/**
+ * Red black tree with a small direct-mapped cache of recently found keys in front of Find
+ * Each cache slot points straight at the node holding a key, so a hit on a hot key skips the whole descent from the
+ * root; on skewed workloads most lookups hit a handful of keys, which then stay cached
+ *
+ * Nodes never move while they are in the tree (a deletion relinks the successor rather than copying its key), so a
+ * cached pointer stays valid until its own key is deleted; Delete, Extract, PopMin and PopMax clear that one slot,
+ * and the bulk operations that detach many nodes at once (EraseRange, AssignSorted, SplitOffAbove, SplitOffBelow)
+ * clear the whole cache
+ * Nodes can also leave the tree behind this class's back: through a RedBlackTree reference, as CompressedSnapshot
+ * and KeyFileLoader rebuild a tree with AssignSorted, or by handing the tree to another tree's Concatenate or Merge.
+ * RedBlackTree counts every such removal in its RemovalEpoch, and Find clears the whole cache before using it
+ * whenever the epoch moved since the cache was last known to be good
+ *
+ * Assumes that any templated type has valid comparison operators and a std::hash specialization
+ */
+template<class Type, class Summary = NoSummary>
+class CachedRedBlackTree : public RedBlackTree<Type, Summary>
+{
+public:
+    /**
+     * @param CacheSlots How many keys the cache can hold at most; rounded up to a power of two
+     */
+    explicit CachedRedBlackTree(std::size_t CacheSlots = 4096);
+
+    /**
+     * Removes the given key from the tree, if it exists in the tree, and drops it from the cache
+     * @param KeyToDelete The key to delete from the tree
+     */
+    void Delete(const Type KeyToDelete);
+
+    /**
+     * Removes every key in the closed range [Low, High] from the tree, and clears the cache
+     * @param Low Smallest key to remove
+     * @param High Largest key to remove
+     * @return The number of keys removed
+     */
+    std::size_t EraseRange(const Type Low, const Type High);
+
+    /**
+     * Replaces the contents of the tree with keys given in strictly ascending order, and clears the cache
+     * @param Keys The new keys, in strictly ascending order
+     * @param Count How many keys there are
+     */
+    void AssignSorted(const Type* Keys, std::size_t Count);
+
+    /**
+     * Unlinks the node holding the given key and hands it over, and drops the key from the cache
+     * @param KeyToExtract The key to take out of the tree
+     * @return A handle holding the node, or an empty handle if the key is not in the tree
+     */
+    typename RedBlackTree<Type, Summary>::NodeHandle Extract(const Type KeyToExtract);
+
+    /** Removes and returns the smallest key in the tree, and drops it from the cache */
+    Type PopMin();
+
+    /** Removes and returns the largest key in the tree, and drops it from the cache */
+    Type PopMax();
+
+    /** Moves every key not smaller than SplitKey into another tree, and clears the cache */
+    void SplitOffAbove(const Type SplitKey, RedBlackTree<Type, Summary> &Upper);
+
+    /** Moves every key smaller than SplitKey into another tree, and clears the cache */
+    void SplitOffBelow(const Type SplitKey, RedBlackTree<Type, Summary> &Lower);
+
+    /**
+     * Finds the key passed as parameter in the tree, if it exists, checking the cache first
+     * A key found in the tree replaces whatever key its cache slot held
+     * @param KeyToFind The key to search for in the tree
+     * @return true if key is in the tree, false otherwise
+     */
+    bool Find(const Type KeyToFind) const;
+
+    /** Forgets every cached key */
+    void ClearCache();
+
+    /** Getter function to retrieve the number of lookups answered by the cache */
+    std::size_t GetCacheHits() const;
+
+    /** Getter function to retrieve the number of lookups that had to search the tree */
+    std::size_t GetCacheMisses() const;
+
+private:
+    /** Returns the cache slot the key passed as parameter maps to */
+    std::size_t SlotOf(const Type &Key) const;
+
+    /** Empties the slot of the key passed as parameter, if the slot holds that key */
+    void Forget(const Type &Key);
+
+    /** Clears the whole cache if nodes left the tree since it was last known to be good */
+    void DropStaleSlots() const;
+
+    /** Marks the cache as good as of the tree's current removal epoch */
+    void MarkCacheCurrent() const;
+
+    /** Nodes of recently found keys, or nullptr for an empty slot; a node is only ever cached in its key's slot */
+    mutable std::vector<Node<Type, Summary>*> Slots;
+
+    /** The number of bits needed to index a slot */
+    int SlotBits;
+
+    /** The removal epoch of the tree when the cache was last known to be good */
+    mutable std::size_t SeenEpoch;
+
+    mutable std::size_t Hits;
+    mutable std::size_t Misses;
+
+};  //end CachedRedBlackTree definition
+
+template<class Type, class Summary>
+CachedRedBlackTree<Type, Summary>::CachedRedBlackTree(std::size_t CacheSlots)
+{
+    SlotBits = 0;
+    while (((std::size_t) 1 << SlotBits) < CacheSlots)
+    {
+        SlotBits++;
+    }
+    Slots.assign((std::size_t) 1 << SlotBits, nullptr);
+    SeenEpoch = this->RemovalEpoch;
+    Hits = Misses = 0;
+}
+
+template<class Type, class Summary>
+void CachedRedBlackTree<Type, Summary>::Delete(const Type KeyToDelete)
+{
+    DropStaleSlots();
+    Forget(KeyToDelete);
+    RedBlackTree<Type, Summary>::Delete(KeyToDelete);
+    MarkCacheCurrent();
+}
+
+template<class Type, class Summary>
+std::size_t CachedRedBlackTree<Type, Summary>::EraseRange(const Type Low, const Type High)
+{
+    std::size_t Erased = RedBlackTree<Type, Summary>::EraseRange(Low, High);
+    ClearCache();
+    return Erased;
+}
+
+template<class Type, class Summary>
+void CachedRedBlackTree<Type, Summary>::AssignSorted(const Type* Keys, std::size_t Count)
+{
+    RedBlackTree<Type, Summary>::AssignSorted(Keys, Count);
+    ClearCache();
+}
+
+template<class Type, class Summary>
+typename RedBlackTree<Type, Summary>::NodeHandle CachedRedBlackTree<Type, Summary>::Extract(const Type KeyToExtract)
+{
+    DropStaleSlots();
+    Forget(KeyToExtract);
+    typename RedBlackTree<Type, Summary>::NodeHandle Handle = RedBlackTree<Type, Summary>::Extract(KeyToExtract);
+    MarkCacheCurrent();
+    return Handle;
+}
+
+template<class Type, class Summary>
+Type CachedRedBlackTree<Type, Summary>::PopMin()
+{
+    DropStaleSlots();
+    if (this->Size != 0)
+    {
+        Forget(this->FindMin());
+    }
+    Type Popped = RedBlackTree<Type, Summary>::PopMin();
+    MarkCacheCurrent();
+    return Popped;
+}
+
+template<class Type, class Summary>
+Type CachedRedBlackTree<Type, Summary>::PopMax()
+{
+    DropStaleSlots();
+    if (this->Size != 0)
+    {
+        Forget(this->FindMax());
+    }
+    Type Popped = RedBlackTree<Type, Summary>::PopMax();
+    MarkCacheCurrent();
+    return Popped;
+}
+
+template<class Type, class Summary>
+void CachedRedBlackTree<Type, Summary>::SplitOffAbove(const Type SplitKey, RedBlackTree<Type, Summary> &Upper)
+{
+    RedBlackTree<Type, Summary>::SplitOffAbove(SplitKey, Upper);
+    ClearCache();
+}
+
+template<class Type, class Summary>
+void CachedRedBlackTree<Type, Summary>::SplitOffBelow(const Type SplitKey, RedBlackTree<Type, Summary> &Lower)
+{
+    RedBlackTree<Type, Summary>::SplitOffBelow(SplitKey, Lower);
+    ClearCache();
+}
+
+template<class Type, class Summary>
+bool CachedRedBlackTree<Type, Summary>::Find(const Type KeyToFind) const
+{
+    DropStaleSlots();
+
+    Node<Type, Summary>*& Slot = Slots[SlotOf(KeyToFind)];
+    if (Slot && Slot->Key == KeyToFind)
+    {
+        Hits++;
+        return true;
+    }
+
+    Misses++;
+    if (this->Size == 0)
+    {
+        return false;
+    }
+
+    Node<Type, Summary>* FoundNode = this->FindIntl(KeyToFind);
+    if (FoundNode->Key != KeyToFind)
+    {
+        return false;
+    }
+
+    Slot = FoundNode;
+    return true;
+}
+
+template<class Type, class Summary>
+void CachedRedBlackTree<Type, Summary>::ClearCache()
+{
+    std::fill(Slots.begin(), Slots.end(), nullptr);
+    MarkCacheCurrent();
+}
+
+template<class Type, class Summary>
+std::size_t CachedRedBlackTree<Type, Summary>::GetCacheHits() const
+{
+    return Hits;
+}
+
+template<class Type, class Summary>
+std::size_t CachedRedBlackTree<Type, Summary>::GetCacheMisses() const
+{
+    return Misses;
+}
+
+template<class Type, class Summary>
+std::size_t CachedRedBlackTree<Type, Summary>::SlotOf(const Type &Key) const
+{
+    //std::hash is the identity for integers, so spread the hash with a multiplicative step and keep its top bits
+    std::uint64_t Hash = (std::uint64_t) std::hash<Type>()(Key) * 0x9E3779B97F4A7C15ull;
+    return SlotBits ? (std::size_t) (Hash >> (64 - SlotBits)) : 0;
+}
+
+template<class Type, class Summary>
+void CachedRedBlackTree<Type, Summary>::Forget(const Type &Key)
+{
+    Node<Type, Summary>*& Slot = Slots[SlotOf(Key)];
+    if (Slot && Slot->Key == Key)
+    {
+        Slot = nullptr;
+    }
+}
+
+template<class Type, class Summary>
+void CachedRedBlackTree<Type, Summary>::DropStaleSlots() const
+{
+    if (SeenEpoch != this->RemovalEpoch)
+    {
+        std::fill(Slots.begin(), Slots.end(), nullptr);
+        MarkCacheCurrent();
+    }
+}
+
+template<class Type, class Summary>
+void CachedRedBlackTree<Type, Summary>::MarkCacheCurrent() const
+{
+    SeenEpoch = this->RemovalEpoch;
+}
+
+#endif //REDBLACKTREE_CACHEDREDBLACKTREE_H
@@ -0,0 +1,312 @@
+#ifndef REDBLACKTREE_COMPRESSEDSNAPSHOT_H
+#define REDBLACKTREE_COMPRESSEDSNAPSHOT_H
+
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "RedBlackTree.h"
+
+/**
+ * Compact binary snapshots of red black trees holding integers
+ * The sorted keys of the tree are delta encoded: each key is stored as its distance to the key before it, and on
+ * dense or clustered sets these distances are far smaller than the keys themselves. The deltas are cut into blocks
+ * of BlockKeys; each full block stores the bit width of its largest delta and then every delta packed at that width,
+ * so a block decodes with the same shift and mask for every key and no branch per key, a loop compilers can
+ * vectorize. The short block at the end is stored as LEB128 varints instead
+ *
+ * Loading decodes the keys into a sorted array and builds the tree from it in linear time with AssignSorted,
+ * rather than inserting the keys one by one
+ *
+ * Layout, all integers little endian:
+ * - "RBTZ", a format version byte, the key size in bytes, a signedness byte and a reserved zero byte
+ * - the number of keys and the smallest key, as 8 bytes each
+ * - for every full block: one width byte, then BlockKeys deltas packed at that many bits each
+ * - for the last, partial block: one varint per delta
+ * The first delta of the first block is always 0, so blocks line up with runs of BlockKeys keys
+ *
+ * Assumes that Type is an integral type other than bool
+ */
+template<class Type>
+class CompressedSnapshot
+{
+    static_assert(std::is_integral<Type>::value && !std::is_same<Type, bool>::value,
+                  "CompressedSnapshot only stores integer keys");
+
+public:
+    /** The number of keys per bit-packed block */
+    static constexpr std::size_t BlockKeys = 128;
+
+    /**
+     * Writes a compressed snapshot of every key of the tree to a stream
+     * Failures are reported through the stream's state, as with any other stream output
+     * @param Tree The tree to save
+     * @param Out The stream to write to; should be opened in binary mode
+     */
+    template<class Summary, class Allocator>
+    static void Save(const RedBlackTree<Type, Summary, Allocator> &Tree, std::ostream &Out);
+
+    /**
+     * Replaces the contents of a tree with the keys of a compressed snapshot read from a stream
+     * Throws std::runtime_error if the stream does not hold a valid snapshot of the same key type
+     * @param In The stream to read from; should be opened in binary mode
+     * @param Tree The tree to load the keys into
+     */
+    template<class Summary, class Allocator>
+    static void Load(std::istream &In, RedBlackTree<Type, Summary, Allocator> &Tree);
+
+private:
+    typedef typename std::make_unsigned<Type>::type Delta;
+
+    static constexpr unsigned char FormatVersion = 1;
+
+    /** Largest packed width whose values are always read with a single 8 byte load; wider blocks store 64 bits */
+    static constexpr unsigned MaxPackedWidth = 56;
+
+    /**
+     * Appends one block of deltas to Bytes, packed at the width of its largest delta
+     * @param Deltas BlockKeys deltas
+     * @param Bytes The output to append to
+     */
+    static void PackBlock(const Delta* Deltas, std::vector<unsigned char> &Bytes);
+
+    /**
+     * Unpacks one block of deltas
+     * @param Packed The packed deltas; must be followed by at least 8 readable bytes
+     * @param Width The bit width the block was packed at
+     * @param Deltas Where to write BlockKeys deltas
+     */
+    static void UnpackBlock(const unsigned char* Packed, unsigned Width, Delta* Deltas);
+
+    static void AppendVarint(std::uint64_t Value, std::vector<unsigned char> &Bytes);
+    static std::uint64_t ReadVarint(std::istream &In);
+
+    static void StoreLittleEndian64(std::uint64_t Value, unsigned char* Bytes);
+    static std::uint64_t LoadLittleEndian64(const unsigned char* Bytes);
+
+    /** Reads exactly Count bytes, or throws */
+    static void ReadExactly(std::istream &In, unsigned char* Bytes, std::size_t Count);
+
+};  //end CompressedSnapshot definition
+
+template<class Type>
+template<class Summary, class Allocator>
+void CompressedSnapshot<Type>::Save(const RedBlackTree<Type, Summary, Allocator> &Tree, std::ostream &Out)
+{
+    unsigned char Header[24] = {'R', 'B', 'T', 'Z', FormatVersion, (unsigned char) sizeof(Type),
+                                (unsigned char) std::is_signed<Type>::value, 0};
+    StoreLittleEndian64(Tree.GetSize(), Header + 8);
+    StoreLittleEndian64(Tree.GetSize() ? (std::uint64_t) (Delta) Tree.FindMin() : 0, Header + 16);
+    Out.write((const char*) Header, sizeof(Header));
+
+    if (Tree.GetSize() == 0)
+    {
+        return;
+    }
+
+    //deltas are taken in the unsigned type, whose wrap-around makes them exact even across zero for signed keys
+    Delta Previous = (Delta) Tree.FindMin();
+    Delta Deltas[BlockKeys];
+    std::vector<unsigned char> Bytes;
+    Bytes.reserve(1 + BlockKeys * 8 + 8);
+
+    Tree.ExportChunks(BlockKeys, [&](const Type* Keys, std::size_t Count)
+    {
+        for (std::size_t i = 0; i < Count; i++)
+        {
+            Deltas[i] = (Delta) Keys[i] - Previous;
+            Previous = (Delta) Keys[i];
+        }
+
+        Bytes.clear();
+        if (Count == BlockKeys)
+        {
+            PackBlock(Deltas, Bytes);
+        }
+        else
+        {
+            for (std::size_t i = 0; i < Count; i++)
+            {
+                AppendVarint(Deltas[i], Bytes);
+            }
+        }
+        Out.write((const char*) Bytes.data(), (std::streamsize) Bytes.size());
+    });
+}
+
+template<class Type>
+template<class Summary, class Allocator>
+void CompressedSnapshot<Type>::Load(std::istream &In, RedBlackTree<Type, Summary, Allocator> &Tree)
+{
+    unsigned char Header[24];
+    ReadExactly(In, Header, sizeof(Header));
+    if (Header[0] != 'R' || Header[1] != 'B' || Header[2] != 'T' || Header[3] != 'Z' || Header[4] != FormatVersion)
+    {
+        throw std::runtime_error("Not a compressed red black tree snapshot");
+    }
+    if (Header[5] != sizeof(Type) || Header[6] != (unsigned char) std::is_signed<Type>::value)
+    {
+        throw std::runtime_error("Snapshot holds keys of a different type");
+    }
+
+    //the key count is not trusted for the allocation: a corrupt header would otherwise allocate far more than the
+    //stream holds before the truncation shows, so the keys grow as blocks decode and at most one block is reserved
+    std::uint64_t Count = LoadLittleEndian64(Header + 8);
+    std::vector<Type> Keys;
+    Keys.reserve((std::size_t) std::min<std::uint64_t>(Count, BlockKeys));
+    Delta Previous = (Delta) LoadLittleEndian64(Header + 16);
+
+    //room for the widest block plus the slack the 8 byte loads of UnpackBlock may read past its end
+    unsigned char Packed[BlockKeys * 8 + 8] = {};
+    Delta Deltas[BlockKeys];
+
+    std::size_t Decoded = 0;
+    while (Decoded < Count)
+    {
+        std::size_t BlockCount = (std::size_t) std::min<std::uint64_t>(BlockKeys, Count - Decoded);
+        if (BlockCount == BlockKeys)
+        {
+            unsigned char Width;
+            ReadExactly(In, &Width, 1);
+            if (Width > sizeof(Delta) * 8 || (Width > MaxPackedWidth && Width != 64))
+            {
+                throw std::runtime_error("Corrupt snapshot block");
+            }
+            ReadExactly(In, Packed, BlockKeys * Width / 8);
+            UnpackBlock(Packed, Width, Deltas);
+        }
+        else
+        {
+            for (std::size_t i = 0; i < BlockCount; i++)
+            {
+                Deltas[i] = (Delta) ReadVarint(In);
+            }
+        }
+
+        //the very first delta is always zero, and every other key must be larger than the one before it, which
+        //AssignSorted relies on; a delta that wraps around in the unsigned type would give a smaller key
+        for (std::size_t i = 0; i < BlockCount; i++)
+        {
+            Delta Next = Previous + Deltas[i];
+            if (Decoded + i == 0 ? Deltas[i] != 0 : !((Type) Previous < (Type) Next))
+            {
+                throw std::runtime_error("Corrupt snapshot: keys out of order");
+            }
+            Previous = Next;
+            Keys.push_back((Type) Previous);
+        }
+        Decoded += BlockCount;
+    }
+
+    Tree.AssignSorted(Keys.data(), Keys.size());
+}
+
+template<class Type>
+void CompressedSnapshot<Type>::PackBlock(const Delta* Deltas, std::vector<unsigned char> &Bytes)
+{
+    Delta Bits = 0;
+    for (std::size_t i = 0; i < BlockKeys; i++)
+    {
+        Bits |= Deltas[i];
+    }
+
+    unsigned Width = 0;
+    while (Width < sizeof(Delta) * 8 && (Bits >> Width) != 0)
+    {
+        Width++;
+    }
+    if (Width > MaxPackedWidth)
+    {
+        Width = 64;
+    }
+
+    Bytes.push_back((unsigned char) Width);
+    std::size_t Start = Bytes.size();
+    Bytes.resize(Start + BlockKeys * Width / 8, 0);
+
+    for (std::size_t i = 0; i < BlockKeys; i++)
+    {
+        std::uint64_t Value = Deltas[i];
+        std::size_t Bit = i * Width;
+        for (unsigned Written = 0; Written < Width; Written += 8 - (unsigned) ((Bit + Written) % 8))
+        {
+            std::size_t Position = Bit + Written;
+            Bytes[Start + Position / 8] |= (unsigned char) ((Value >> Written) << (Position % 8));
+        }
+    }
+}
+
+template<class Type>
+void CompressedSnapshot<Type>::UnpackBlock(const unsigned char* Packed, unsigned Width, Delta* Deltas)
+{
+    //every value sits within one 8 byte window at a fixed stride, so all of them unpack independently
+    std::uint64_t Mask = Width == 64 ? ~(std::uint64_t) 0 : ((std::uint64_t) 1 << Width) - 1;
+    for (std::size_t i = 0; i < BlockKeys; i++)
+    {
+        std::size_t Bit = i * Width;
+        Deltas[i] = (Delta) ((LoadLittleEndian64(Packed + Bit / 8) >> (Bit % 8)) & Mask);
+    }
+}
+
+template<class Type>
+void CompressedSnapshot<Type>::AppendVarint(std::uint64_t Value, std::vector<unsigned char> &Bytes)
+{
+    while (Value >= 0x80)
+    {
+        Bytes.push_back((unsigned char) (Value | 0x80));
+        Value >>= 7;
+    }
+    Bytes.push_back((unsigned char) Value);
+}
+
+template<class Type>
+std::uint64_t CompressedSnapshot<Type>::ReadVarint(std::istream &In)
+{
+    std::uint64_t Value = 0;
+    for (unsigned Shift = 0; Shift < 64; Shift += 7)
+    {
+        unsigned char Byte;
+        ReadExactly(In, &Byte, 1);
+        Value |= (std::uint64_t) (Byte & 0x7F) << Shift;
+        if (!(Byte & 0x80))
+        {
+            return Value;
+        }
+    }
+    throw std::runtime_error("Corrupt snapshot varint");
+}
+
+template<class Type>
+void CompressedSnapshot<Type>::StoreLittleEndian64(std::uint64_t Value, unsigned char* Bytes)
+{
+    for (int i = 0; i < 8; i++)
+    {
+        Bytes[i] = (unsigned char) (Value >> (8 * i));
+    }
+}
+
+template<class Type>
+std::uint64_t CompressedSnapshot<Type>::LoadLittleEndian64(const unsigned char* Bytes)
+{
+    //compilers fold this into a single load on little endian machines
+    std::uint64_t Value = 0;
+    for (int i = 0; i < 8; i++)
+    {
+        Value |= (std::uint64_t) Bytes[i] << (8 * i);
+    }
+    return Value;
+}
+
+template<class Type>
+void CompressedSnapshot<Type>::ReadExactly(std::istream &In, unsigned char* Bytes, std::size_t Count)
+{
+    if (!In.read((char*) Bytes, (std::streamsize) Count))
+    {
+        throw std::runtime_error("Truncated snapshot");
+    }
+}
+
+#endif //REDBLACKTREE_COMPRESSEDSNAPSHOT_H
@@ -0,0 +1,1031 @@
+#ifndef REDBLACKTREE_CONCURRENTCHROMATICTREE_H
+#define REDBLACKTREE_CONCURRENTCHROMATICTREE_H
+
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <initializer_list>
+#include <stdexcept>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Container for a single node of a chromatic tree: a key, a weight, two children and a small lock
+ * Weight 0 is red, 1 is black, and anything heavier is an overweight violation still to be pushed up the tree
+ * The key and weight never change; a node whose weight or position changes is replaced by a fresh copy instead,
+ * so readers walking through a node that was just replaced still see a consistent, older piece of the tree
+ */
+template<class Type>
+struct ChromaticNode
+{
+    ChromaticNode(const Type &NodeKey, int NodeWeight, ChromaticNode* Left, ChromaticNode* Right)
+            : Key(NodeKey), Weight(NodeWeight)
+    {
+        Child[0].store(Left, std::memory_order_relaxed);
+        Child[1].store(Right, std::memory_order_relaxed);
+        Locked.store(false, std::memory_order_relaxed);
+        Removed = false;
+        NextRetired = nullptr;
+    }
+
+    /** Leaves hold the keys of the tree; every other node routes searches and always has two children */
+    bool IsLeaf() const
+    {
+        return !Child[0].load(std::memory_order_acquire);
+    }
+
+    /** Takes the lock of this node if nobody else holds it */
+    bool TryLock()
+    {
+        return !Locked.exchange(true, std::memory_order_acquire);
+    }
+
+    void Unlock()
+    {
+        Locked.store(false, std::memory_order_release);
+    }
+
+    const Type Key;
+    const int Weight;
+    std::atomic<ChromaticNode*> Child[2];
+
+    /** Held by a writer while it checks and replaces the piece of tree this node belongs to */
+    std::atomic<bool> Locked;
+
+    /** Set, under the lock, once the node has been replaced; a removed node's children never change again */
+    bool Removed;
+
+    /** Next node in the retired list the node waits in until no search can still be reading it */
+    ChromaticNode* NextRetired;
+
+};  //end ChromaticNode definition
+
+
+/**
+ * Ordered set that many threads can update at once, balanced as a chromatic tree
+ * A chromatic tree is a leaf-oriented red black tree with relaxed balance: an update only makes a local change and
+ * may leave a red-red or overweight violation behind, which the updating thread then removes with small local
+ * rotations and recolourings, each of which only touches a handful of nodes near the violation
+ *
+ * Find takes no locks. Every change, whether an update or a rebalancing step, try-locks the few nodes it replaces
+ * together with their parent, checks that they are still linked together, then swings the parent's child pointer
+ * to a freshly built replacement in one atomic store. A writer that finds a node already locked backs off and
+ * retries, so writers never wait on each other while holding locks
+ *
+ * Replaced nodes may still be read by concurrent searches, so they are reclaimed by epochs: every operation
+ * announces the global epoch it started in, replaced nodes are retired into the list of the epoch they were
+ * replaced in, and the epoch only moves on once no operation is left in the epoch before it. A node retired in
+ * epoch e can therefore no longer be reached once the epoch reaches e + 2, and its list is freed then. Updates try
+ * to move the epoch on as soon as ReclaimThreshold nodes are waiting, so memory stays bounded while writers run;
+ * only an operation that stalls inside the tree holds reclamation back
+ * Threads announce their epoch in one of ReaderSlotCount slots; threads sharing a slot just add to its count
+ *
+ * Assumes that any templated type is default constructible and has valid comparison operators
+ */
+template<class Type>
+class ConcurrentChromaticTree
+{
+public:
+    ConcurrentChromaticTree();
+
+    ~ConcurrentChromaticTree();
+
+    /**
+     * Inserts the given key into the tree, if it is not already in the tree
+     * Safe to call from any number of threads at once
+     * @param NewKey The new key to insert into the tree
+     * @return true if the key was inserted, false if it was already in the tree
+     */
+    bool Insert(const Type NewKey);
+
+    /**
+     * Removes the given key from the tree, if it exists in the tree
+     * Safe to call from any number of threads at once
+     * @param KeyToDelete The key to delete from the tree
+     * @return true if the key was removed, false if it was not in the tree
+     */
+    bool Delete(const Type KeyToDelete);
+
+    /**
+     * Finds the key passed as parameter in the tree, if it exists, without taking any lock
+     * @param KeyToFind The key to search for in the tree
+     * @return true if key is in the tree, false otherwise
+     */
+    bool Find(const Type KeyToFind) const;
+
+    /**
+     * Finds the smallest key in the tree
+     * @return The smallest key in the tree
+     * @throws std::out_of_range if the tree is empty
+     */
+    Type FindMin() const;
+
+    /**
+     * Finds the largest key in the tree
+     * @return The largest key in the tree
+     * @throws std::out_of_range if the tree is empty
+     */
+    Type FindMax() const;
+
+    /***
+     * Makes and returns a sorted array of all elements in the tree
+     * Only consistent while no other thread is updating the tree
+     * @return A pointer to the first element of the newly created array
+     */
+    Type* MakeArray() const;
+
+    /** Getter function to retrieve size of the tree */
+    std::size_t GetSize() const;
+
+    /** Height of the tree; only meaningful while no other thread is updating the tree */
+    int GetHeight() const;
+
+    /**
+     * Counts the red-red and overweight violations left in the tree
+     * Every update removes the violations it creates before returning, so this is 0 whenever no update is running
+     */
+    std::size_t CountViolations() const;
+
+    /**
+     * Frees every node that has been replaced so far, without waiting for the epochs to move on
+     * Must only be called while no other thread is using the tree, since searches may still be reading them
+     */
+    void ReclaimRetired();
+
+    /** Getter function to retrieve the number of replaced nodes that are not freed yet */
+    std::size_t GetRetiredCount() const;
+
+private:
+    typedef ChromaticNode<Type> Node;
+
+    /** The number of slots operations announce their epoch in */
+    static const std::size_t ReaderSlotCount = 64;
+
+    /** How many retired nodes may wait before updates start moving the epoch on to free them */
+    static const std::size_t ReclaimThreshold = 1024;
+
+    /** The number of operations running in each of the last three epochs; on its own cache line */
+    struct alignas(64) ReaderSlot
+    {
+        std::atomic<std::size_t> Active[3];
+    };
+
+    /** Announces the current epoch in the calling thread's slot for as long as it is in scope */
+    class EpochGuard
+    {
+    public:
+        explicit EpochGuard(const ConcurrentChromaticTree &Tree);
+        ~EpochGuard();
+
+        EpochGuard(const EpochGuard &) = delete;
+        EpochGuard &operator=(const EpochGuard &) = delete;
+
+    private:
+        std::atomic<std::size_t>* Counter;
+    };
+
+    /** Try-locks the nodes of a patch, and releases every lock it took when it goes out of scope */
+    class PatchLock
+    {
+    public:
+        PatchLock()
+        {
+            Count = 0;
+        }
+
+        ~PatchLock()
+        {
+            for (int i = 0; i < Count; i++)
+            {
+                Nodes[i]->Unlock();
+            }
+        }
+
+        /** Locks the node if nobody else holds it; fails if it is held, or if it has been removed from the tree */
+        bool Add(Node* A)
+        {
+            if (!A->TryLock())
+            {
+                return false;
+            }
+            Nodes[Count++] = A;
+            return !A->Removed;
+        }
+
+    private:
+        Node* Nodes[6];
+        int Count;
+    };
+
+    /**
+     * Finds which child of the parent the node is
+     * @param Par The parent node, assumed to be locked so its children are stable
+     * @param Ch The node expected to be a child of Par
+     * @param Dir Set to the side of Par that Ch hangs from
+     * @return true if Ch is still a child of Par
+     */
+    static bool ChildDir(Node* Par, Node* Ch, int &Dir);
+
+    /**
+     * Builds a node with the given child on the given side, and the other child on the opposite side
+     * @param Key Key of the new node
+     * @param Weight Weight of the new node
+     * @param Dir Side of the new node that DirChild hangs from
+     * @param DirChild Child on side Dir
+     * @param OtherChild Child on the opposite side
+     */
+    static Node* NewNode(const Type &Key, int Weight, int Dir, Node* DirChild, Node* OtherChild);
+
+    /** Builds a copy of a locked node with the same children and a new weight */
+    static Node* CopyNode(Node* A, int Weight);
+
+    /** The weight a node hanging from Top should take; the root always takes weight 1, which no leaf depends on */
+    int WeightUnder(Node* Top, int Weight) const;
+
+    /**
+     * Swings Top's child from a patch of nodes to its replacement, then retires the replaced nodes
+     * Assumes that Top and every replaced node are locked
+     * @param Top The node whose child pointer changes
+     * @param Dir Side of Top the patch hangs from
+     * @param NewChild Root of the replacement patch
+     * @param Replaced The nodes that are no longer in the tree
+     */
+    void ReplacePatch(Node* Top, int Dir, Node* NewChild, std::initializer_list<Node*> Replaced);
+
+    /**
+     * Queues a chain of removed nodes, linked through NextRetired, in the retired list of the current epoch
+     * Assumes that the nodes are already unlinked from the tree
+     * @param First First node of the chain
+     * @param Last Last node of the chain
+     * @param Count The number of nodes in the chain
+     */
+    void Retire(Node* First, Node* Last, std::size_t Count);
+
+    /**
+     * Moves the epoch on if no operation is left in the epoch before the current one, and frees the list of nodes
+     * that became unreachable by doing so; does nothing if another thread moved the epoch on first
+     * Must be called outside of any EpochGuard of the calling thread, or the thread may hold the epoch back itself
+     */
+    void TryAdvanceEpoch();
+
+    /** The slot the calling thread announces its epoch in; threads are numbered as they first use a tree */
+    static std::size_t HomeSlot();
+
+    bool InsertIntl(const Type &NewKey);
+    bool DeleteIntl(const Type &KeyToDelete);
+
+    /**
+     * Removes every violation on the search path of the key passed as parameter, top down, retrying until none is left
+     * @param KeyToFix Key of the update that may have left violations behind
+     */
+    void Cleanup(const Type &KeyToFix);
+
+    /**
+     * Fixes a red-red violation between X and its parent P, by recolouring or by a single or double rotation
+     * Assumes that the grandparent G is not red
+     * @param Top Parent of G
+     * @param G Grandparent of X
+     * @param P Parent of X
+     * @param X The lower of the two red nodes
+     * @return false if some node was locked by another thread or the tree changed underneath, so the caller retries
+     */
+    bool FixRedRed(Node* Top, Node* G, Node* P, Node* X);
+
+    /**
+     * Takes one unit of weight off the overweight node X, by pushing it up to its parent or rotating it into
+     * its sibling's subtree; red-red violations next to X are fixed first, so no rotation creates new ones
+     * @param GG Grandparent of P; may be null when P is the root or the entry node
+     * @param G Parent of P; null when P is the entry node
+     * @param P Parent of X
+     * @param X The overweight node
+     * @return false if some node was locked by another thread or the tree changed underneath, so the caller retries
+     */
+    bool FixOverweight(Node* GG, Node* G, Node* P, Node* X);
+
+    /** Frees every node of the subtree rooted at the node passed as parameter */
+    static void DeleteSubtree(Node* A);
+
+    int GetHeightIntl(Node* Curr) const;
+    std::size_t CountViolationsIntl(Node* Curr, Node* Par) const;
+
+    /**
+     * Performs an in order traversal of the tree, filling an array with the key of each leaf as needed
+     * @param A Current node for recursive fill
+     * @param Arr Array containing the sorted keys; is assumed to be of size at least equal to the tree size
+     * @param CurrElement Counter for which position we are currently filling in the array
+     */
+    void InOrderFill(Node* A, Type* Arr, std::size_t &CurrElement) const;
+
+    /** Node above the root that is never replaced; the root hangs from its left child, which is null when empty */
+    Node* Entry;
+
+    /** The current number of keys stored in the tree */
+    std::atomic<std::size_t> Size;
+
+    /** The global epoch; only ever moves forward, one step at a time */
+    std::atomic<std::uint64_t> Epoch;
+
+    /** Held by the thread moving the epoch on, until it has taken the list that became free */
+    std::atomic<bool> Advancing;
+
+    /** Stacks of the nodes replaced in each of the last three epochs, chained through NextRetired */
+    std::atomic<Node*> Retired[3];
+
+    /** The number of nodes in the retired stacks */
+    std::atomic<std::size_t> RetiredCount;
+
+    mutable ReaderSlot Readers[ReaderSlotCount];
+
+};  //end ConcurrentChromaticTree definition
+
+
+
+template<class Type>
+ConcurrentChromaticTree<Type>::ConcurrentChromaticTree()
+{
+    Entry = new Node(Type(), 1, nullptr, nullptr);
+    Size.store(0);
+    Epoch.store(0);
+    Advancing.store(false);
+    for (std::atomic<Node*> &List : Retired)
+    {
+        List.store(nullptr);
+    }
+    RetiredCount.store(0);
+    for (ReaderSlot &Slot : Readers)
+    {
+        for (std::atomic<std::size_t> &Count : Slot.Active)
+        {
+            Count.store(0);
+        }
+    }
+}
+
+template<class Type>
+ConcurrentChromaticTree<Type>::~ConcurrentChromaticTree()
+{
+    ReclaimRetired();
+    DeleteSubtree(Entry->Child[0].load());
+    delete Entry;
+}
+
+template<class Type>
+bool ConcurrentChromaticTree<Type>::Insert(const Type NewKey)
+{
+    bool Inserted;
+    {
+        EpochGuard Guard(*this);
+        Inserted = InsertIntl(NewKey);
+    }
+
+    if (RetiredCount.load(std::memory_order_relaxed) >= ReclaimThreshold)
+    {
+        TryAdvanceEpoch();
+    }
+    return Inserted;
+}
+
+template<class Type>
+bool ConcurrentChromaticTree<Type>::Delete(const Type KeyToDelete)
+{
+    bool Deleted;
+    {
+        EpochGuard Guard(*this);
+        Deleted = DeleteIntl(KeyToDelete);
+    }
+
+    if (RetiredCount.load(std::memory_order_relaxed) >= ReclaimThreshold)
+    {
+        TryAdvanceEpoch();
+    }
+    return Deleted;
+}
+
+template<class Type>
+bool ConcurrentChromaticTree<Type>::InsertIntl(const Type &NewKey)
+{
+    while (true)
+    {
+        Node* Par = Entry;
+        int Dir = 0;
+        Node* Leaf = Entry->Child[0].load(std::memory_order_acquire);
+        while (Leaf && !Leaf->IsLeaf())
+        {
+            Par = Leaf;
+            Dir = NewKey < Leaf->Key ? 0 : 1;
+            Leaf = Leaf->Child[Dir].load(std::memory_order_acquire);
+        }
+
+        if (Leaf && Leaf->Key == NewKey)
+        {
+            return false;
+        }
+
+        Node* NewInternal = nullptr;
+        {
+            PatchLock Patch;
+            if (!Patch.Add(Par) || Par->Child[Dir].load(std::memory_order_relaxed) != Leaf ||
+                (Leaf && !Patch.Add(Leaf)))
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            //if the tree is empty, then the key becomes the root leaf
+            if (!Leaf)
+            {
+                ReplacePatch(Par, Dir, new Node(NewKey, 1, nullptr, nullptr), {});
+                Size.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+
+            //the leaf is replaced by a node routing between it and the new leaf, one unit of weight lighter,
+            //so every leaf below keeps the same weighted depth
+            Node* NewLeaf = new Node(NewKey, 1, nullptr, nullptr);
+            Node* OldLeaf = CopyNode(Leaf, 1);
+            if (NewKey < Leaf->Key)
+            {
+                NewInternal = new Node(Leaf->Key, WeightUnder(Par, Leaf->Weight - 1), NewLeaf, OldLeaf);
+            }
+            else
+            {
+                NewInternal = new Node(NewKey, WeightUnder(Par, Leaf->Weight - 1), OldLeaf, NewLeaf);
+            }
+            ReplacePatch(Par, Dir, NewInternal, {Leaf});
+        }
+
+        Size.fetch_add(1, std::memory_order_relaxed);
+        if (NewInternal->Weight == 0 && Par->Weight == 0)
+        {
+            Cleanup(NewKey);
+        }
+        return true;
+    }
+}
+
+template<class Type>
+bool ConcurrentChromaticTree<Type>::DeleteIntl(const Type &KeyToDelete)
+{
+    while (true)
+    {
+        Node* GrandPar = nullptr;
+        Node* Par = Entry;
+        int ParDir = 0;
+        int Dir = 0;
+        Node* Leaf = Entry->Child[0].load(std::memory_order_acquire);
+        while (Leaf && !Leaf->IsLeaf())
+        {
+            GrandPar = Par;
+            ParDir = Dir;
+            Par = Leaf;
+            Dir = KeyToDelete < Leaf->Key ? 0 : 1;
+            Leaf = Leaf->Child[Dir].load(std::memory_order_acquire);
+        }
+
+        if (!Leaf || Leaf->Key != KeyToDelete)
+        {
+            return false;
+        }
+
+        Node* NewSibling = nullptr;
+        {
+            PatchLock Patch;
+
+            //if the leaf is the root, then the tree becomes empty
+            if (Par == Entry)
+            {
+                if (!Patch.Add(Entry) || Entry->Child[0].load(std::memory_order_relaxed) != Leaf || !Patch.Add(Leaf))
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                ReplacePatch(Entry, 0, nullptr, {Leaf});
+                Size.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+
+            if (!Patch.Add(GrandPar) || GrandPar->Child[ParDir].load(std::memory_order_relaxed) != Par ||
+                !Patch.Add(Par) || Par->Child[Dir].load(std::memory_order_relaxed) != Leaf || !Patch.Add(Leaf))
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            Node* Sibling = Par->Child[1 - Dir].load(std::memory_order_relaxed);
+            if (!Patch.Add(Sibling))
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            //the parent and the leaf go, and the sibling takes their place carrying the parent's weight too
+            NewSibling = CopyNode(Sibling, WeightUnder(GrandPar, Par->Weight + Sibling->Weight));
+            ReplacePatch(GrandPar, ParDir, NewSibling, {Par, Leaf, Sibling});
+        }
+
+        Size.fetch_sub(1, std::memory_order_relaxed);
+        if (NewSibling->Weight > 1 || (NewSibling->Weight == 0 && GrandPar->Weight == 0))
+        {
+            Cleanup(KeyToDelete);
+        }
+        return true;
+    }
+}
+
+template<class Type>
+bool ConcurrentChromaticTree<Type>::Find(const Type KeyToFind) const
+{
+    EpochGuard Guard(*this);
+    Node* CurrNode = Entry->Child[0].load(std::memory_order_acquire);
+    while (CurrNode && !CurrNode->IsLeaf())
+    {
+        CurrNode = CurrNode->Child[KeyToFind < CurrNode->Key ? 0 : 1].load(std::memory_order_acquire);
+    }
+
+    return CurrNode && CurrNode->Key == KeyToFind;
+}
+
+template<class Type>
+Type ConcurrentChromaticTree<Type>::FindMin() const
+{
+    EpochGuard Guard(*this);
+    Node* CurrNode = Entry->Child[0].load(std::memory_order_acquire);
+    if (!CurrNode)
+    {
+        throw std::out_of_range("FindMin called on an empty ConcurrentChromaticTree");
+    }
+
+    while (!CurrNode->IsLeaf())
+    {
+        CurrNode = CurrNode->Child[0].load(std::memory_order_acquire);
+    }
+    return CurrNode->Key;
+}
+
+template<class Type>
+Type ConcurrentChromaticTree<Type>::FindMax() const
+{
+    EpochGuard Guard(*this);
+    Node* CurrNode = Entry->Child[0].load(std::memory_order_acquire);
+    if (!CurrNode)
+    {
+        throw std::out_of_range("FindMax called on an empty ConcurrentChromaticTree");
+    }
+
+    while (!CurrNode->IsLeaf())
+    {
+        CurrNode = CurrNode->Child[1].load(std::memory_order_acquire);
+    }
+    return CurrNode->Key;
+}
+
+template<class Type>
+Type* ConcurrentChromaticTree<Type>::MakeArray() const
+{
+    Type* Arr = new Type[GetSize()];
+    std::size_t x = 0;
+    InOrderFill(Entry->Child[0].load(), Arr, x);
+    return Arr;
+}
+
+template<class Type>
+std::size_t ConcurrentChromaticTree<Type>::GetSize() const
+{
+    return Size.load(std::memory_order_relaxed);
+}
+
+template<class Type>
+int ConcurrentChromaticTree<Type>::GetHeight() const
+{
+    return GetHeightIntl(Entry->Child[0].load());
+}
+
+template<class Type>
+std::size_t ConcurrentChromaticTree<Type>::CountViolations() const
+{
+    return CountViolationsIntl(Entry->Child[0].load(), Entry);
+}
+
+template<class Type>
+void ConcurrentChromaticTree<Type>::ReclaimRetired()
+{
+    for (std::atomic<Node*> &List : Retired)
+    {
+        Node* CurrNode = List.exchange(nullptr);
+        while (CurrNode)
+        {
+            Node* Next = CurrNode->NextRetired;
+            delete CurrNode;
+            CurrNode = Next;
+        }
+    }
+    RetiredCount.store(0);
+}
+
+template<class Type>
+std::size_t ConcurrentChromaticTree<Type>::GetRetiredCount() const
+{
+    return RetiredCount.load(std::memory_order_relaxed);
+}
+
+template<class Type>
+ConcurrentChromaticTree<Type>::EpochGuard::EpochGuard(const ConcurrentChromaticTree &Tree)
+{
+    ReaderSlot &Slot = Tree.Readers[HomeSlot()];
+
+    //the epoch is read again after announcing it: if it moved on in between, a thread moving it on may already have
+    //checked this slot, so the announcement is withdrawn and made again in the new epoch
+    while (true)
+    {
+        std::uint64_t Current = Tree.Epoch.load();
+        Counter = &Slot.Active[Current % 3];
+        Counter->fetch_add(1);
+        if (Tree.Epoch.load() == Current)
+        {
+            return;
+        }
+        Counter->fetch_sub(1);
+    }
+}
+
+template<class Type>
+ConcurrentChromaticTree<Type>::EpochGuard::~EpochGuard()
+{
+    Counter->fetch_sub(1, std::memory_order_release);
+}
+
+template<class Type>
+bool ConcurrentChromaticTree<Type>::ChildDir(Node* Par, Node* Ch, int &Dir)
+{
+    if (Par->Child[0].load(std::memory_order_relaxed) == Ch)
+    {
+        Dir = 0;
+        return true;
+    }
+    if (Par->Child[1].load(std::memory_order_relaxed) == Ch)
+    {
+        Dir = 1;
+        return true;
+    }
+    return false;
+}
+
+template<class Type>
+ChromaticNode<Type>* ConcurrentChromaticTree<Type>::NewNode(const Type &Key, int Weight, int Dir, Node* DirChild,
+                                                           Node* OtherChild)
+{
+    return Dir == 0 ? new Node(Key, Weight, DirChild, OtherChild) : new Node(Key, Weight, OtherChild, DirChild);
+}
+
+template<class Type>
+ChromaticNode<Type>* ConcurrentChromaticTree<Type>::CopyNode(Node* A, int Weight)
+{
+    return new Node(A->Key, Weight, A->Child[0].load(std::memory_order_relaxed),
+                    A->Child[1].load(std::memory_order_relaxed));
+}
+
+template<class Type>
+int ConcurrentChromaticTree<Type>::WeightUnder(Node* Top, int Weight) const
+{
+    return Top == Entry ? 1 : Weight;
+}
+
+template<class Type>
+void ConcurrentChromaticTree<Type>::ReplacePatch(Node* Top, int Dir, Node* NewChild,
+                                                 std::initializer_list<Node*> Replaced)
+{
+    Top->Child[Dir].store(NewChild, std::memory_order_release);
+    if (Replaced.size() == 0)
+    {
+        return;
+    }
+
+    //chain the replaced nodes together, so the whole patch is retired with a single push
+    Node* Last = nullptr;
+    for (Node* OldNode : Replaced)
+    {
+        OldNode->Removed = true;
+        OldNode->NextRetired = Last;
+        Last = OldNode;
+    }
+    Retire(Last, *Replaced.begin(), Replaced.size());
+}
+
+template<class Type>
+void ConcurrentChromaticTree<Type>::Retire(Node* First, Node* Last, std::size_t Count)
+{
+    //the epoch is read only after the nodes were unlinked, so no operation that starts in it can reach them
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::atomic<Node*> &List = Retired[Epoch.load() % 3];
+
+    Last->NextRetired = List.load(std::memory_order_relaxed);
+    while (!List.compare_exchange_weak(Last->NextRetired, First, std::memory_order_release,
+                                       std::memory_order_relaxed))
+    {
+    }
+    RetiredCount.fetch_add(Count, std::memory_order_relaxed);
+}
+
+template<class Type>
+void ConcurrentChromaticTree<Type>::TryAdvanceEpoch()
+{
+    if (Advancing.exchange(true, std::memory_order_acquire))
+    {
+        return;
+    }
+
+    //operations still running in the epoch before the current one may hold nodes retired in it, so wait for them
+    std::uint64_t Current = Epoch.load();
+    std::size_t Previous = (Current + 2) % 3;
+    for (const ReaderSlot &Slot : Readers)
+    {
+        if (Slot.Active[Previous].load() != 0)
+        {
+            Advancing.store(false, std::memory_order_release);
+            return;
+        }
+    }
+
+    //every operation now started in epoch Current or later, after the nodes retired in Current - 1 were unlinked;
+    //their list is also the one epoch Current + 2 will use, so it is taken before the epoch can move on again
+    Epoch.store(Current + 1);
+    Node* CurrNode = Retired[Previous].exchange(nullptr, std::memory_order_acquire);
+    Advancing.store(false, std::memory_order_release);
+
+    std::size_t Freed = 0;
+    while (CurrNode)
+    {
+        Node* Next = CurrNode->NextRetired;
+        delete CurrNode;
+        CurrNode = Next;
+        Freed++;
+    }
+    RetiredCount.fetch_sub(Freed, std::memory_order_relaxed);
+}
+
+template<class Type>
+std::size_t ConcurrentChromaticTree<Type>::HomeSlot()
+{
+    static std::atomic<std::size_t> NextThread(0);
+    thread_local std::size_t Home = NextThread.fetch_add(1, std::memory_order_relaxed) % ReaderSlotCount;
+    return Home;
+}
+
+template<class Type>
+void ConcurrentChromaticTree<Type>::Cleanup(const Type &KeyToFix)
+{
+    while (true)
+    {
+        Node* GG = nullptr;
+        Node* G = nullptr;
+        Node* P = Entry;
+        Node* X = Entry->Child[0].load(std::memory_order_acquire);
+
+        //walk down to the topmost violation on the path, so the nodes above it are known to be valid
+        while (X)
+        {
+            if (X->Weight > 1 || (X->Weight == 0 && P->Weight == 0))
+            {
+                break;
+            }
+            if (X->IsLeaf())
+            {
+                return;
+            }
+
+            GG = G;
+            G = P;
+            P = X;
+            X = X->Child[KeyToFix < X->Key ? 0 : 1].load(std::memory_order_acquire);
+        }
+
+        if (!X)
+        {
+            return;
+        }
+
+        bool Fixed = X->Weight > 1 ? FixOverweight(GG, G, P, X) : FixRedRed(GG, G, P, X);
+        if (!Fixed)
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+template<class Type>
+bool ConcurrentChromaticTree<Type>::FixRedRed(Node* Top, Node* G, Node* P, Node* X)
+{
+    //the red parent can not be the root, which is always black, so the grandparent is a real node
+    if (!Top || G == Entry)
+    {
+        return false;
+    }
+
+    PatchLock Patch;
+    int TopDir, GDir, PDir;
+    if (!Patch.Add(Top) || !ChildDir(Top, G, TopDir) || !Patch.Add(G) || !ChildDir(G, P, GDir) ||
+        !Patch.Add(P) || !ChildDir(P, X, PDir) || G->Weight == 0)
+    {
+        return false;
+    }
+
+    Node* Uncle = G->Child[1 - GDir].load(std::memory_order_relaxed);
+
+    //BLK: both children of the grandparent are red, so push their redness up into the grandparent
+    if (Uncle->Weight == 0)
+    {
+        if (!Patch.Add(Uncle))
+        {
+            return false;
+        }
+
+        Node* NewG = NewNode(G->Key, WeightUnder(Top, G->Weight - 1), GDir, CopyNode(P, 1), CopyNode(Uncle, 1));
+        ReplacePatch(Top, TopDir, NewG, {G, P, Uncle});
+        return true;
+    }
+
+    //RB1: X is an outer grandchild, so a single rotation at the grandparent lifts the parent above it
+    if (PDir == GDir)
+    {
+        Node* NewG = NewNode(G->Key, 0, GDir, P->Child[1 - GDir].load(std::memory_order_relaxed), Uncle);
+        Node* NewP = NewNode(P->Key, WeightUnder(Top, G->Weight), GDir, X, NewG);
+        ReplacePatch(Top, TopDir, NewP, {G, P});
+        return true;
+    }
+
+    //RB2: X is an inner grandchild, so a double rotation lifts X above both its parent and grandparent
+    if (!Patch.Add(X))
+    {
+        return false;
+    }
+
+    Node* NewP = NewNode(P->Key, 0, GDir, P->Child[GDir].load(std::memory_order_relaxed),
+                         X->Child[GDir].load(std::memory_order_relaxed));
+    Node* NewG = NewNode(G->Key, 0, GDir, X->Child[1 - GDir].load(std::memory_order_relaxed), Uncle);
+    Node* NewX = NewNode(X->Key, WeightUnder(Top, G->Weight), GDir, NewP, NewG);
+    ReplacePatch(Top, TopDir, NewX, {G, P, X});
+    return true;
+}
+
+template<class Type>
+bool ConcurrentChromaticTree<Type>::FixOverweight(Node* GG, Node* G, Node* P, Node* X)
+{
+    Node* Sibling;
+    Node* NearNephew;
+    Node* FarNephew;
+    {
+        PatchLock Patch;
+
+        //an overweight root simply drops its extra weight, since every leaf loses it equally
+        if (P == Entry)
+        {
+            if (!Patch.Add(Entry) || Entry->Child[0].load(std::memory_order_relaxed) != X || !Patch.Add(X))
+            {
+                return false;
+            }
+
+            ReplacePatch(Entry, 0, CopyNode(X, 1), {X});
+            return true;
+        }
+
+        int PDir, Dir;
+        if (!Patch.Add(G) || !ChildDir(G, P, PDir) || !Patch.Add(P) || !ChildDir(P, X, Dir) || !Patch.Add(X))
+        {
+            return false;
+        }
+
+        Sibling = P->Child[1 - Dir].load(std::memory_order_relaxed);
+        if (!Patch.Add(Sibling))
+        {
+            return false;
+        }
+
+        //PUSH: a sibling with no red child to rotate in shares a unit of weight with X and hands it to the parent
+        if (Sibling->Weight >= 2 || Sibling->IsLeaf())
+        {
+            Node* NewP = NewNode(P->Key, WeightUnder(G, P->Weight + 1), Dir, CopyNode(X, X->Weight - 1),
+                                 CopyNode(Sibling, Sibling->Weight - 1));
+            ReplacePatch(G, PDir, NewP, {P, X, Sibling});
+            return true;
+        }
+
+        NearNephew = Sibling->Child[Dir].load(std::memory_order_relaxed);
+        FarNephew = Sibling->Child[1 - Dir].load(std::memory_order_relaxed);
+
+        if (Sibling->Weight == 1)
+        {
+            //W-far: rotate the sibling up and blacken its red far child, which moves a unit of weight off X
+            if (FarNephew->Weight == 0)
+            {
+                if (!Patch.Add(FarNephew))
+                {
+                    return false;
+                }
+
+                Node* NewP = NewNode(P->Key, 1, Dir, CopyNode(X, X->Weight - 1), NearNephew);
+                Node* NewSibling = NewNode(Sibling->Key, WeightUnder(G, P->Weight), Dir, NewP,
+                                           CopyNode(FarNephew, 1));
+                ReplacePatch(G, PDir, NewSibling, {P, X, Sibling, FarNephew});
+                return true;
+            }
+
+            //W-near: double rotate the sibling's red near child up, which moves a unit of weight off X
+            if (NearNephew->Weight == 0)
+            {
+                if (!Patch.Add(NearNephew))
+                {
+                    return false;
+                }
+
+                Node* NewP = NewNode(P->Key, 1, Dir, CopyNode(X, X->Weight - 1),
+                                     NearNephew->Child[Dir].load(std::memory_order_relaxed));
+                Node* NewSibling = NewNode(Sibling->Key, 1, Dir,
+                                           NearNephew->Child[1 - Dir].load(std::memory_order_relaxed), FarNephew);
+                Node* NewNear = NewNode(NearNephew->Key, WeightUnder(G, P->Weight), Dir, NewP, NewSibling);
+                ReplacePatch(G, PDir, NewNear, {P, X, Sibling, NearNephew});
+                return true;
+            }
+
+            Node* NewP = NewNode(P->Key, WeightUnder(G, P->Weight + 1), Dir, CopyNode(X, X->Weight - 1),
+                                 CopyNode(Sibling, 0));
+            ReplacePatch(G, PDir, NewP, {P, X, Sibling});
+            return true;
+        }
+
+        //W-red: rotate the red sibling up so X gets a black sibling, unless red-red violations are in the way
+        if (P->Weight != 0 && NearNephew->Weight != 0 && FarNephew->Weight != 0)
+        {
+            Node* NewP = NewNode(P->Key, 0, Dir, X, NearNephew);
+            Node* NewSibling = NewNode(Sibling->Key, WeightUnder(G, P->Weight), Dir, NewP, FarNephew);
+            ReplacePatch(G, PDir, NewSibling, {P, Sibling});
+            return true;
+        }
+    }
+
+    //the red sibling is part of a red-red violation; fix that one first, with every lock above released
+    if (P->Weight == 0)
+    {
+        return FixRedRed(GG, G, P, Sibling);
+    }
+    return FixRedRed(G, P, Sibling, NearNephew->Weight == 0 ? NearNephew : FarNephew);
+}
+
+template<class Type>
+void ConcurrentChromaticTree<Type>::DeleteSubtree(Node* A)
+{
+    if (!A)
+    {
+        return;
+    }
+
+    DeleteSubtree(A->Child[0].load());
+    DeleteSubtree(A->Child[1].load());
+    delete A;
+}
+
+template<class Type>
+int ConcurrentChromaticTree<Type>::GetHeightIntl(Node* Curr) const
+{
+    if (!Curr)
+    {
+        return -1;
+    }
+
+    return std::max(GetHeightIntl(Curr->Child[0].load()), GetHeightIntl(Curr->Child[1].load())) + 1;
+}
+
+template<class Type>
+std::size_t ConcurrentChromaticTree<Type>::CountViolationsIntl(Node* Curr, Node* Par) const
+{
+    if (!Curr)
+    {
+        return 0;
+    }
+
+    std::size_t Violations = (Curr->Weight > 1 || (Curr->Weight == 0 && Par->Weight == 0)) ? 1 : 0;
+    return Violations + CountViolationsIntl(Curr->Child[0].load(), Curr) +
+           CountViolationsIntl(Curr->Child[1].load(), Curr);
+}
+
+template<class Type>
+void ConcurrentChromaticTree<Type>::InOrderFill(Node* A, Type* Arr, std::size_t &CurrElement) const
+{
+    if (!A)
+    {
+        return;
+    }
+
+    if (A->IsLeaf())
+    {
+        Arr[CurrElement] = A->Key;
+        CurrElement++;
+        return;
+    }
+
+    InOrderFill(A->Child[0].load(), Arr, CurrElement);
+    InOrderFill(A->Child[1].load(), Arr, CurrElement);
+}
+
+#endif //REDBLACKTREE_CONCURRENTCHROMATICTREE_H
@@ -0,0 +1,330 @@
+#ifndef REDBLACKTREE_FLATCOMBININGREDBLACKTREE_H
+#define REDBLACKTREE_FLATCOMBININGREDBLACKTREE_H
+
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include "RedBlackTree.h"
+
+/**
+ * Red black tree shared between threads through flat combining
+ * Instead of every thread taking a lock and walking the tree itself, each thread publishes its operation in a slot
+ * of its own and waits; whichever thread manages to become the combiner collects every pending operation, sorts them
+ * by key so that consecutive operations walk down the same, already cached paths, applies them all and hands back
+ * the results. The combiner's lock is taken once per batch rather than once per operation, so under contention the
+ * lock's cache line stops bouncing between cores. A thread that finds nobody combining skips publishing and applies
+ * its own operation directly, so a lone thread pays little more than it would for an uncontended lock
+ *
+ * Operations published at the same time may be applied in any order relative to each other, since none of them
+ * has finished before the others started
+ *
+ * Assumes that any templated type is default constructible and has valid comparison operators
+ */
+template<class Type, class Summary = NoSummary>
+class FlatCombiningRedBlackTree
+{
+public:
+    FlatCombiningRedBlackTree();
+
+    /**
+     * Inserts the given key into the tree, if it is not already in the tree
+     * @param NewKey The new key to insert into the tree
+     */
+    void Insert(const Type NewKey);
+
+    /**
+     * Removes the given key from the tree, if it exists in the tree
+     * @param KeyToDelete The key to delete from the tree
+     */
+    void Delete(const Type KeyToDelete);
+
+    /**
+     * Finds the key passed as parameter in the tree, if it exists
+     * @param KeyToFind The key to search for in the tree
+     * @return true if key is in the tree, false otherwise
+     */
+    bool Find(const Type KeyToFind);
+
+    /***
+     * Makes and returns a sorted array of all elements in the tree
+     * @return A pointer to the first element of the newly created array
+     */
+    Type* MakeArray();
+
+    /** Getter function to retrieve size of the tree; exact whenever no operation is running */
+    std::size_t GetSize() const;
+
+    /** Getter function to retrieve the average number of operations applied per combining pass so far */
+    double GetAverageBatchSize() const;
+
+private:
+    enum Operation {InsertOp, DeleteOp, FindOp};
+
+    /** Free slots can be claimed by any thread; a claimed slot is being filled in by its thread */
+    enum SlotState {Free, Claimed, Pending, Done};
+
+    /** One published operation; each sits on its own cache line so that threads filling in slots do not collide */
+    struct alignas(64) PublicationSlot
+    {
+        std::atomic<int> State;
+        Operation Op;
+        Type Key;
+        bool Result;
+    };
+
+    /** The number of publication slots; threads beyond this share slots and take turns */
+    static const std::size_t SlotCount = 128;
+
+    /**
+     * Publishes an operation, waits until a combiner applied it, and takes back its result
+     * @param Op The operation to apply
+     * @param Key The key to apply it to
+     * @return The result of the operation; only meaningful for Find
+     */
+    bool Publish(Operation Op, const Type &Key);
+
+    /**
+     * Applies one operation to the tree; assumes that the combiner lock is held
+     * @return The result of the operation; only meaningful for Find
+     */
+    bool Apply(Operation Op, const Type &Key);
+
+    /**
+     * Applies every pending operation in key order; assumes that the combiner lock is held
+     * @param AppliedDirectly How many operations the combiner already applied itself during this pass, for statistics
+     */
+    void Combine(std::size_t AppliedDirectly);
+
+    /** Takes the combiner lock if nobody else holds it */
+    bool TryLockCombiner();
+
+    /** Waits for and takes the combiner lock */
+    void LockCombiner();
+
+    void UnlockCombiner();
+
+    /** The slot the calling thread tries first; threads are numbered as they first publish, so they rarely share */
+    static std::size_t HomeSlot();
+
+    RedBlackTree<Type, Summary> Tree;
+    PublicationSlot Slots[SlotCount];
+
+    /** One past the highest slot ever claimed; the combiner never looks beyond it */
+    std::atomic<std::size_t> SlotsInUse;
+
+    /** Held by whichever thread is currently applying operations to Tree */
+    std::atomic<bool> CombinerLocked;
+
+    /** The pending slots of the current combining pass; only used with the combiner lock held */
+    std::vector<PublicationSlot*> Batch;
+
+    std::atomic<std::size_t> Size;
+    std::atomic<std::size_t> Batches;
+    std::atomic<std::size_t> CombinedOperations;
+
+};  //end FlatCombiningRedBlackTree definition
+
+template<class Type, class Summary>
+FlatCombiningRedBlackTree<Type, Summary>::FlatCombiningRedBlackTree()
+{
+    for (PublicationSlot &Slot : Slots)
+    {
+        Slot.State.store(Free, std::memory_order_relaxed);
+    }
+    SlotsInUse.store(0, std::memory_order_relaxed);
+    CombinerLocked.store(false, std::memory_order_relaxed);
+    Batch.reserve(SlotCount);
+    Size.store(0, std::memory_order_relaxed);
+    Batches.store(0, std::memory_order_relaxed);
+    CombinedOperations.store(0, std::memory_order_relaxed);
+}
+
+template<class Type, class Summary>
+void FlatCombiningRedBlackTree<Type, Summary>::Insert(const Type NewKey)
+{
+    Publish(InsertOp, NewKey);
+}
+
+template<class Type, class Summary>
+void FlatCombiningRedBlackTree<Type, Summary>::Delete(const Type KeyToDelete)
+{
+    Publish(DeleteOp, KeyToDelete);
+}
+
+template<class Type, class Summary>
+bool FlatCombiningRedBlackTree<Type, Summary>::Find(const Type KeyToFind)
+{
+    return Publish(FindOp, KeyToFind);
+}
+
+template<class Type, class Summary>
+Type* FlatCombiningRedBlackTree<Type, Summary>::MakeArray()
+{
+    LockCombiner();
+    Type* Array = Tree.MakeArray();
+    UnlockCombiner();
+    return Array;
+}
+
+template<class Type, class Summary>
+std::size_t FlatCombiningRedBlackTree<Type, Summary>::GetSize() const
+{
+    return Size.load(std::memory_order_relaxed);
+}
+
+template<class Type, class Summary>
+double FlatCombiningRedBlackTree<Type, Summary>::GetAverageBatchSize() const
+{
+    std::size_t NumBatches = Batches.load(std::memory_order_relaxed);
+    return NumBatches ? (double) CombinedOperations.load(std::memory_order_relaxed) / NumBatches : 0.0;
+}
+
+template<class Type, class Summary>
+bool FlatCombiningRedBlackTree<Type, Summary>::Publish(Operation Op, const Type &Key)
+{
+    //with nobody else combining there is nothing to batch with, so apply the operation straight away,
+    //then pick up whatever other threads published in the meantime
+    if (TryLockCombiner())
+    {
+        bool Result = Apply(Op, Key);
+        Combine(1);
+        UnlockCombiner();
+        return Result;
+    }
+
+    //claim the first free slot from this thread's own onwards
+    PublicationSlot* Slot = nullptr;
+    for (std::size_t Probes = 0; !Slot; Probes++)
+    {
+        std::size_t Index = (HomeSlot() + Probes) % SlotCount;
+        int Expected = Free;
+        if (Slots[Index].State.load(std::memory_order_relaxed) == Free &&
+            Slots[Index].State.compare_exchange_strong(Expected, Claimed, std::memory_order_acquire))
+        {
+            Slot = &Slots[Index];
+
+            //a combiner that still reads the old mark misses this slot, but then this thread combines it itself
+            std::size_t InUse = SlotsInUse.load(std::memory_order_relaxed);
+            while (InUse <= Index)
+            {
+                if (SlotsInUse.compare_exchange_weak(InUse, Index + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+        }
+        else if (Probes % SlotCount == SlotCount - 1)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    Slot->Op = Op;
+    Slot->Key = Key;
+    Slot->State.store(Pending, std::memory_order_release);
+
+    //either some combiner picks the operation up, or this thread becomes the combiner and applies it itself
+    while (Slot->State.load(std::memory_order_acquire) != Done)
+    {
+        if (TryLockCombiner())
+        {
+            Combine(0);
+            UnlockCombiner();
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    bool Result = Slot->Result;
+    Slot->State.store(Free, std::memory_order_release);
+    return Result;
+}
+
+template<class Type, class Summary>
+bool FlatCombiningRedBlackTree<Type, Summary>::Apply(Operation Op, const Type &Key)
+{
+    switch (Op)
+    {
+        case InsertOp:
+            Tree.Insert(Key);
+            return false;
+        case DeleteOp:
+            Tree.Delete(Key);
+            return false;
+        default:
+            return Tree.Find(Key);
+    }
+}
+
+template<class Type, class Summary>
+void FlatCombiningRedBlackTree<Type, Summary>::Combine(std::size_t AppliedDirectly)
+{
+    Batch.clear();
+    std::size_t InUse = SlotsInUse.load(std::memory_order_relaxed);
+    for (std::size_t i = 0; i < InUse; i++)
+    {
+        if (Slots[i].State.load(std::memory_order_acquire) == Pending)
+        {
+            Batch.push_back(&Slots[i]);
+        }
+    }
+
+    std::sort(Batch.begin(), Batch.end(), [](const PublicationSlot* A, const PublicationSlot* B)
+    {
+        return A->Key < B->Key;
+    });
+
+    for (PublicationSlot* Slot : Batch)
+    {
+        Slot->Result = Apply(Slot->Op, Slot->Key);
+    }
+
+    //publish the new size before any waiting thread can return
+    Size.store(Tree.GetSize(), std::memory_order_relaxed);
+    Batches.store(Batches.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    CombinedOperations.store(CombinedOperations.load(std::memory_order_relaxed) + AppliedDirectly + Batch.size(),
+                             std::memory_order_relaxed);
+
+    for (PublicationSlot* Slot : Batch)
+    {
+        Slot->State.store(Done, std::memory_order_release);
+    }
+}
+
+template<class Type, class Summary>
+bool FlatCombiningRedBlackTree<Type, Summary>::TryLockCombiner()
+{
+    //test before exchanging, so that waiting threads only read the lock's cache line while a combiner holds it
+    return !CombinerLocked.load(std::memory_order_relaxed) &&
+           !CombinerLocked.exchange(true, std::memory_order_acquire);
+}
+
+template<class Type, class Summary>
+void FlatCombiningRedBlackTree<Type, Summary>::LockCombiner()
+{
+    while (!TryLockCombiner())
+    {
+        std::this_thread::yield();
+    }
+}
+
+template<class Type, class Summary>
+void FlatCombiningRedBlackTree<Type, Summary>::UnlockCombiner()
+{
+    CombinerLocked.store(false, std::memory_order_release);
+}
+
+template<class Type, class Summary>
+std::size_t FlatCombiningRedBlackTree<Type, Summary>::HomeSlot()
+{
+    static std::atomic<std::size_t> NextThread(0);
+    thread_local std::size_t Home = NextThread.fetch_add(1, std::memory_order_relaxed) % SlotCount;
+    return Home;
+}
+
+#endif //REDBLACKTREE_FLATCOMBININGREDBLACKTREE_H
@@ -0,0 +1,578 @@
+#ifndef REDBLACKTREE_INDEXEDREDBLACKALGORITHMS_H
+#define REDBLACKTREE_INDEXEDREDBLACKALGORITHMS_H
+
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+
+/**
+ * The red black tree algorithms for trees whose nodes link to each other by position in a node store instead of by
+ * pointer, shared by IndexedRedBlackTree and StaticRedBlackTree
+ * NodeStore is anything indexed with [], such as a std::vector or a fixed array of nodes with Key, Parent, LChild,
+ * RChild and Colour members and a NodeColour enum; IndexType is the type of the links, whose largest value stands for
+ * a missing node
+ * Every function is constexpr, so a tree over a fixed array can run all of them at compile time. None of them
+ * allocate: taking new nodes is left to the tree, and freed nodes are chained into a free list through their right
+ * child index
+ */
+template<class NodeStore, class IndexType>
+struct IndexedRedBlackAlgorithms
+{
+    typedef typename std::remove_reference<decltype(std::declval<NodeStore &>()[0])>::type NodeType;
+
+    /** Index used for a missing child or parent, the same way RedBlackTree uses nullptr */
+    static constexpr IndexType NullIndex = static_cast<IndexType>(-1);
+
+    /**
+     * Returns the index of the node with a key matching the key passed as parameter
+     * If no node in the tree has a matching key, then the parent of where the key should be is returned
+     * @param Nodes The node store
+     * @param Root Root of the tree
+     * @param KeyToFind The key to search for
+     * @return The node matching the key, the parent of the node where the key should go, or NullIndex if the tree
+     *         is empty
+     */
+    template<class Type>
+    static constexpr IndexType Find(const NodeStore &Nodes, IndexType Root, const Type &KeyToFind);
+
+    /**
+     * Links a new node into the tree below the parent Find returned for its key, and rebalances the tree
+     * @param Nodes The node store
+     * @param NewNode The unlinked node to add
+     * @param Par Parent of the new node, or NullIndex if the tree is empty
+     * @param Root Root of the tree
+     */
+    static constexpr void Link(NodeStore &Nodes, IndexType NewNode, IndexType Par, IndexType &Root);
+
+    /**
+     * Unlinks a node from the tree and rebalances it
+     * A node with two children is replaced by relinking its successor into its place, so no other node changes index
+     * @param Nodes The node store
+     * @param Z Node to remove; it can be freed afterwards
+     * @param Root Root of the tree
+     */
+    static constexpr void Erase(NodeStore &Nodes, IndexType Z, IndexType &Root);
+
+    /**
+     * Stores a key in a node about to be linked into the tree, leaving it red and unlinked
+     * @param Nodes The node store
+     * @param NewNode Index of the node
+     * @param NewKey Key of the node
+     */
+    template<class Type>
+    static constexpr void InitNode(NodeStore &Nodes, IndexType NewNode, const Type &NewKey);
+
+    /**
+     * Takes the first node from the free list
+     * @param Nodes The node store
+     * @param FreeList First node on the free list
+     * @return The node taken, or NullIndex if the free list is empty
+     */
+    static constexpr IndexType TakeFreeNode(NodeStore &Nodes, IndexType &FreeList);
+
+    /**
+     * Puts a node that is no longer linked into the tree on the free list
+     * @param Nodes The node store
+     * @param NodeToFree Index of the node to free
+     * @param FreeList First node on the free list
+     */
+    static constexpr void FreeNode(NodeStore &Nodes, IndexType NodeToFree, IndexType &FreeList);
+
+    /** Returns the node with the smallest key in the subtree rooted at StartNode, which must not be NullIndex */
+    static constexpr IndexType Minimum(const NodeStore &Nodes, IndexType StartNode);
+
+    /** Returns the node with the largest key in the subtree rooted at StartNode, which must not be NullIndex */
+    static constexpr IndexType Maximum(const NodeStore &Nodes, IndexType StartNode);
+
+    /** Returns the node following CurrNode in sorted order, or NullIndex if it is the last; needs no stack */
+    static constexpr IndexType Next(const NodeStore &Nodes, IndexType CurrNode);
+
+    static constexpr int Height(const NodeStore &Nodes, IndexType Curr);
+    static constexpr int BlackHeight(const NodeStore &Nodes, IndexType Curr);
+
+    /**
+     * Fixes the tree after an insertion so that the red-black properties are obeyed
+     * @param Nodes The node store
+     * @param X Node that was inserted; assumed to be coloured red
+     * @param Root Root of the tree
+     */
+    static constexpr void FixInsertion(NodeStore &Nodes, IndexType X, IndexType &Root);
+
+    /**
+     * Fixes the tree after a black node was removed so that the red-black properties are obeyed
+     * @param Nodes The node store
+     * @param X Node that took the removed node's place; may be NullIndex
+     * @param XParent Parent of X; needed since X may be NullIndex
+     * @param Root Root of the tree
+     */
+    static constexpr void FixDeletion(NodeStore &Nodes, IndexType X, IndexType XParent, IndexType &Root);
+
+    /**
+     * Performs a left rotation in the tree at node X
+     * Assumes that X has a right child
+     * @param Nodes The node store
+     * @param X Node to perform the left rotation on
+     * @param Root Root of the tree; updated if X was the root
+     */
+    static constexpr void LeftRotation(NodeStore &Nodes, IndexType X, IndexType &Root);
+
+    /**
+     * Performs a right rotation in the tree at node X
+     * Assumes that X has a left child
+     * @param Nodes The node store
+     * @param X Node to perform the right rotation on
+     * @param Root Root of the tree; updated if X was the root
+     */
+    static constexpr void RightRotation(NodeStore &Nodes, IndexType X, IndexType &Root);
+
+    /**
+     * Replaces the subtree rooted at OldChild with the one rooted at NewChild in OldChild's parent
+     * @param Nodes The node store
+     * @param OldChild Node being replaced
+     * @param NewChild Node taking its place; may be NullIndex
+     * @param Root Root of the tree; updated if OldChild was the root
+     */
+    static constexpr void Transplant(NodeStore &Nodes, IndexType OldChild, IndexType NewChild, IndexType &Root);
+
+    /** Tests to see if this node is black; NullIndex is black */
+    static constexpr bool TestColourBlack(const NodeStore &Nodes, IndexType TestNode);
+
+    /** Tests to see if this node is red */
+    static constexpr bool TestColourRed(const NodeStore &Nodes, IndexType TestNode);
+
+};  //end IndexedRedBlackAlgorithms definition
+
+
+
+template<class NodeStore, class IndexType>
+template<class Type>
+constexpr IndexType IndexedRedBlackAlgorithms<NodeStore, IndexType>::Find(const NodeStore &Nodes, IndexType Root,
+                                                                          const Type &KeyToFind)
+{
+    IndexType Par = NullIndex;
+    IndexType CurrNode = Root;
+    while (CurrNode != NullIndex)
+    {
+        const NodeType &Curr = Nodes[CurrNode];
+        if (KeyToFind == Curr.Key)
+        {
+            return CurrNode;
+        }
+
+        Par = CurrNode;
+        CurrNode = (KeyToFind < Curr.Key) ? Curr.LChild : Curr.RChild;
+    }
+
+    return Par;
+}
+
+template<class NodeStore, class IndexType>
+constexpr void IndexedRedBlackAlgorithms<NodeStore, IndexType>::Link(NodeStore &Nodes, IndexType NewNode,
+                                                                     IndexType Par, IndexType &Root)
+{
+    //if the tree is empty, then the node becomes the root and is coloured black
+    if (Par == NullIndex)
+    {
+        Root = NewNode;
+        Nodes[Root].Colour = NodeType::NodeColour::Black;
+        return;
+    }
+
+    if (Nodes[NewNode].Key < Nodes[Par].Key)
+    {
+        Nodes[Par].LChild = NewNode;
+    }
+    else
+    {
+        Nodes[Par].RChild = NewNode;
+    }
+    Nodes[NewNode].Parent = Par;
+
+    FixInsertion(Nodes, NewNode, Root);
+}
+
+template<class NodeStore, class IndexType>
+constexpr void IndexedRedBlackAlgorithms<NodeStore, IndexType>::Erase(NodeStore &Nodes, IndexType Z, IndexType &Root)
+{
+    typename NodeType::NodeColour RemovedColour = Nodes[Z].Colour;
+    IndexType X = NullIndex;
+    IndexType XParent = NullIndex;
+
+    //case 1 and 2: the node has at most one child, which takes its place
+    if (Nodes[Z].LChild == NullIndex || Nodes[Z].RChild == NullIndex)
+    {
+        X = (Nodes[Z].LChild != NullIndex) ? Nodes[Z].LChild : Nodes[Z].RChild;
+        XParent = Nodes[Z].Parent;
+        Transplant(Nodes, Z, X, Root);
+    }
+        //case 3: the node has two children; its successor is relinked into its place
+    else
+    {
+        IndexType Successor = Minimum(Nodes, Nodes[Z].RChild);
+
+        RemovedColour = Nodes[Successor].Colour;
+        X = Nodes[Successor].RChild;
+
+        if (Nodes[Successor].Parent == Z)
+        {
+            XParent = Successor;
+        }
+        else
+        {
+            XParent = Nodes[Successor].Parent;
+            Transplant(Nodes, Successor, X, Root);
+            Nodes[Successor].RChild = Nodes[Z].RChild;
+            Nodes[Nodes[Successor].RChild].Parent = Successor;
+        }
+
+        Transplant(Nodes, Z, Successor, Root);
+        Nodes[Successor].LChild = Nodes[Z].LChild;
+        Nodes[Nodes[Successor].LChild].Parent = Successor;
+        Nodes[Successor].Colour = Nodes[Z].Colour;
+    }
+
+    if (RemovedColour == NodeType::NodeColour::Black)
+    {
+        FixDeletion(Nodes, X, XParent, Root);
+    }
+}
+
+template<class NodeStore, class IndexType>
+template<class Type>
+constexpr void IndexedRedBlackAlgorithms<NodeStore, IndexType>::InitNode(NodeStore &Nodes, IndexType NewNode,
+                                                                         const Type &NewKey)
+{
+    NodeType &Created = Nodes[NewNode];
+    Created.Key = NewKey;
+    Created.Parent = Created.RChild = Created.LChild = NullIndex;
+    Created.Colour = NodeType::NodeColour::Red;
+}
+
+template<class NodeStore, class IndexType>
+constexpr IndexType IndexedRedBlackAlgorithms<NodeStore, IndexType>::TakeFreeNode(NodeStore &Nodes,
+                                                                                  IndexType &FreeList)
+{
+    IndexType Taken = FreeList;
+    if (Taken != NullIndex)
+    {
+        FreeList = Nodes[Taken].RChild;
+    }
+    return Taken;
+}
+
+template<class NodeStore, class IndexType>
+constexpr void IndexedRedBlackAlgorithms<NodeStore, IndexType>::FreeNode(NodeStore &Nodes, IndexType NodeToFree,
+                                                                         IndexType &FreeList)
+{
+    Nodes[NodeToFree].Parent = Nodes[NodeToFree].LChild = NullIndex;
+    Nodes[NodeToFree].RChild = FreeList;
+    FreeList = NodeToFree;
+}
+
+template<class NodeStore, class IndexType>
+constexpr IndexType IndexedRedBlackAlgorithms<NodeStore, IndexType>::Minimum(const NodeStore &Nodes,
+                                                                             IndexType StartNode)
+{
+    IndexType CurrNode = StartNode;
+    while (Nodes[CurrNode].LChild != NullIndex)
+    {
+        CurrNode = Nodes[CurrNode].LChild;
+    }
+    return CurrNode;
+}
+
+template<class NodeStore, class IndexType>
+constexpr IndexType IndexedRedBlackAlgorithms<NodeStore, IndexType>::Maximum(const NodeStore &Nodes,
+                                                                             IndexType StartNode)
+{
+    IndexType CurrNode = StartNode;
+    while (Nodes[CurrNode].RChild != NullIndex)
+    {
+        CurrNode = Nodes[CurrNode].RChild;
+    }
+    return CurrNode;
+}
+
+template<class NodeStore, class IndexType>
+constexpr IndexType IndexedRedBlackAlgorithms<NodeStore, IndexType>::Next(const NodeStore &Nodes, IndexType CurrNode)
+{
+    if (Nodes[CurrNode].RChild != NullIndex)
+    {
+        return Minimum(Nodes, Nodes[CurrNode].RChild);
+    }
+
+    //otherwise climb until we come up from a left child
+    IndexType Par = Nodes[CurrNode].Parent;
+    while (Par != NullIndex && CurrNode == Nodes[Par].RChild)
+    {
+        CurrNode = Par;
+        Par = Nodes[Par].Parent;
+    }
+    return Par;
+}
+
+template<class NodeStore, class IndexType>
+constexpr int IndexedRedBlackAlgorithms<NodeStore, IndexType>::Height(const NodeStore &Nodes, IndexType Curr)
+{
+    if (Curr == NullIndex)
+    {
+        return -1;
+    }
+
+    return std::max(Height(Nodes, Nodes[Curr].LChild), Height(Nodes, Nodes[Curr].RChild)) + 1;
+}
+
+template<class NodeStore, class IndexType>
+constexpr int IndexedRedBlackAlgorithms<NodeStore, IndexType>::BlackHeight(const NodeStore &Nodes, IndexType Curr)
+{
+    int Black = 0;
+    for (IndexType CurrNode = Curr; CurrNode != NullIndex; CurrNode = Nodes[CurrNode].LChild)
+    {
+        if (Nodes[CurrNode].Colour == NodeType::NodeColour::Black)
+        {
+            Black++;
+        }
+    }
+    return Black;
+}
+
+template<class NodeStore, class IndexType>
+constexpr void IndexedRedBlackAlgorithms<NodeStore, IndexType>::FixInsertion(NodeStore &Nodes, IndexType X,
+                                                                             IndexType &Root)
+{
+    IndexType CurrNode = X;
+
+//we assume the current node is coloured red; only do this loop while our parent is also coloured red
+    while (TestColourRed(Nodes, Nodes[CurrNode].Parent))
+    {
+        IndexType Par = Nodes[CurrNode].Parent;
+        IndexType Grand = Nodes[Par].Parent;
+
+//Is Par a left child of its parent?
+        if (Par == Nodes[Grand].LChild)
+        {
+            IndexType Y = Nodes[Grand].RChild;
+            if (TestColourBlack(Nodes, Y))
+            {
+                if (CurrNode == Nodes[Par].RChild)
+                {
+                    CurrNode = Par;
+                    LeftRotation(Nodes, CurrNode, Root);
+                }
+
+                Nodes[Nodes[CurrNode].Parent].Colour = NodeType::NodeColour::Black;
+                Nodes[Grand].Colour = NodeType::NodeColour::Red;
+                RightRotation(Nodes, Grand, Root);
+            }
+            else //we are going to recolour the nodes
+            {
+                Nodes[Par].Colour = NodeType::NodeColour::Black;
+                Nodes[Y].Colour = NodeType::NodeColour::Black;
+                Nodes[Grand].Colour = NodeType::NodeColour::Red;
+                CurrNode = Grand;
+            }
+        }
+        else  //We know Par is a right child of its parent
+        {
+            IndexType Y = Nodes[Grand].LChild;
+            if (TestColourBlack(Nodes, Y))
+            {
+                if (CurrNode == Nodes[Par].LChild)
+                {
+                    CurrNode = Par;
+                    RightRotation(Nodes, CurrNode, Root);
+                }
+
+                Nodes[Nodes[CurrNode].Parent].Colour = NodeType::NodeColour::Black;
+                Nodes[Grand].Colour = NodeType::NodeColour::Red;
+                LeftRotation(Nodes, Grand, Root);
+            }
+            else //we are going to recolour the nodes
+            {
+                Nodes[Par].Colour = NodeType::NodeColour::Black;
+                Nodes[Y].Colour = NodeType::NodeColour::Black;
+                Nodes[Grand].Colour = NodeType::NodeColour::Red;
+                CurrNode = Grand;
+            }
+        }
+    }
+    Nodes[Root].Colour = NodeType::NodeColour::Black;
+}
+
+template<class NodeStore, class IndexType>
+constexpr void IndexedRedBlackAlgorithms<NodeStore, IndexType>::FixDeletion(NodeStore &Nodes, IndexType X,
+                                                                            IndexType XParent, IndexType &Root)
+{
+    while (X != Root && TestColourBlack(Nodes, X))
+    {
+        IndexType Sibling = NullIndex;
+
+        //X may be NullIndex, but then its sibling is not, which is enough to tell which side X is on
+        if (X == Nodes[XParent].LChild)
+        {
+            Sibling = Nodes[XParent].RChild;
+
+            //case 1: our sibling is red
+            if (TestColourRed(Nodes, Sibling))
+            {
+                Nodes[Sibling].Colour = NodeType::NodeColour::Black;
+                Nodes[XParent].Colour = NodeType::NodeColour::Red;
+                LeftRotation(Nodes, XParent, Root);
+
+                Sibling = Nodes[XParent].RChild;
+            }
+
+            //case 2: Our sibling is black, with two black children
+            if (TestColourBlack(Nodes, Nodes[Sibling].LChild) && TestColourBlack(Nodes, Nodes[Sibling].RChild))
+            {
+                Nodes[Sibling].Colour = NodeType::NodeColour::Red;
+
+                X = XParent;
+                XParent = Nodes[XParent].Parent;
+            }
+            else
+            {
+                //case 3: our sibling is black, and its right child is black as well
+                if (TestColourBlack(Nodes, Nodes[Sibling].RChild))
+                {
+                    Nodes[Sibling].Colour = NodeType::NodeColour::Red;
+                    Nodes[Nodes[Sibling].LChild].Colour = NodeType::NodeColour::Black;
+                    RightRotation(Nodes, Sibling, Root);
+                    Sibling = Nodes[XParent].RChild;
+                }
+
+                //case 4: our sibling is black and its right child is red
+                Nodes[Sibling].Colour = Nodes[XParent].Colour;
+                Nodes[XParent].Colour = NodeType::NodeColour::Black;
+                Nodes[Nodes[Sibling].RChild].Colour = NodeType::NodeColour::Black;
+                LeftRotation(Nodes, XParent, Root);
+
+                X = Root;
+            }
+        }
+        else
+        {
+            Sibling = Nodes[XParent].LChild;
+
+            //case 1: our sibling is red
+            if (TestColourRed(Nodes, Sibling))
+            {
+                Nodes[Sibling].Colour = NodeType::NodeColour::Black;
+                Nodes[XParent].Colour = NodeType::NodeColour::Red;
+                RightRotation(Nodes, XParent, Root);
+
+                Sibling = Nodes[XParent].LChild;
+            }
+
+            //case 2: Our sibling is black, with two black children
+            if (TestColourBlack(Nodes, Nodes[Sibling].LChild) && TestColourBlack(Nodes, Nodes[Sibling].RChild))
+            {
+                Nodes[Sibling].Colour = NodeType::NodeColour::Red;
+
+                X = XParent;
+                XParent = Nodes[XParent].Parent;
+            }
+            else
+            {
+                //case 3: our sibling is black, and its left child is black as well
+                if (TestColourBlack(Nodes, Nodes[Sibling].LChild))
+                {
+                    Nodes[Sibling].Colour = NodeType::NodeColour::Red;
+                    Nodes[Nodes[Sibling].RChild].Colour = NodeType::NodeColour::Black;
+                    LeftRotation(Nodes, Sibling, Root);
+                    Sibling = Nodes[XParent].LChild;
+                }
+
+                //case 4: our sibling is black and its left child is red
+                Nodes[Sibling].Colour = Nodes[XParent].Colour;
+                Nodes[XParent].Colour = NodeType::NodeColour::Black;
+                Nodes[Nodes[Sibling].LChild].Colour = NodeType::NodeColour::Black;
+                RightRotation(Nodes, XParent, Root);
+
+                X = Root;
+            }
+        }
+    }
+
+    if (X != NullIndex)
+    {
+        Nodes[X].Colour = NodeType::NodeColour::Black;
+    }
+}
+
+template<class NodeStore, class IndexType>
+constexpr void IndexedRedBlackAlgorithms<NodeStore, IndexType>::LeftRotation(NodeStore &Nodes, IndexType X,
+                                                                             IndexType &Root)
+{
+    IndexType Y = Nodes[X].RChild;
+
+//move Y's left child to the right child of X and modify the child's parent if necessary
+    Nodes[X].RChild = Nodes[Y].LChild;
+    if (Nodes[Y].LChild != NullIndex)
+    {
+        Nodes[Nodes[Y].LChild].Parent = X;
+    }
+
+    Transplant(Nodes, X, Y, Root);
+
+    Nodes[Y].LChild = X;
+    Nodes[X].Parent = Y;
+}
+
+template<class NodeStore, class IndexType>
+constexpr void IndexedRedBlackAlgorithms<NodeStore, IndexType>::RightRotation(NodeStore &Nodes, IndexType X,
+                                                                              IndexType &Root)
+{
+    IndexType Y = Nodes[X].LChild;
+
+    Nodes[X].LChild = Nodes[Y].RChild;
+    if (Nodes[Y].RChild != NullIndex)
+    {
+        Nodes[Nodes[Y].RChild].Parent = X;
+    }
+
+    Transplant(Nodes, X, Y, Root);
+
+    Nodes[Y].RChild = X;
+    Nodes[X].Parent = Y;
+}
+
+template<class NodeStore, class IndexType>
+constexpr void IndexedRedBlackAlgorithms<NodeStore, IndexType>::Transplant(NodeStore &Nodes, IndexType OldChild,
+                                                                           IndexType NewChild, IndexType &Root)
+{
+    IndexType Par = Nodes[OldChild].Parent;
+    if (Par == NullIndex)
+    {
+        Root = NewChild;
+    }
+    else if (Nodes[Par].LChild == OldChild)
+    {
+        Nodes[Par].LChild = NewChild;
+    }
+    else
+    {
+        Nodes[Par].RChild = NewChild;
+    }
+
+    if (NewChild != NullIndex)
+    {
+        Nodes[NewChild].Parent = Par;
+    }
+}
+
+template<class NodeStore, class IndexType>
+constexpr bool IndexedRedBlackAlgorithms<NodeStore, IndexType>::TestColourBlack(const NodeStore &Nodes,
+                                                                                IndexType TestNode)
+{
+    return TestNode == NullIndex || Nodes[TestNode].Colour == NodeType::NodeColour::Black;
+}
+
+template<class NodeStore, class IndexType>
+constexpr bool IndexedRedBlackAlgorithms<NodeStore, IndexType>::TestColourRed(const NodeStore &Nodes,
+                                                                              IndexType TestNode)
+{
+    return TestNode != NullIndex && Nodes[TestNode].Colour == NodeType::NodeColour::Red;
+}
+
+#endif //REDBLACKTREE_INDEXEDREDBLACKALGORITHMS_H
@@ -0,0 +1,272 @@
+#ifndef REDBLACKTREE_INDEXEDREDBLACKTREE_H
+#define REDBLACKTREE_INDEXEDREDBLACKTREE_H
+
+#include <iostream>
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include "IndexedRedBlackAlgorithms.h"
+
+/**
+ * Container for a single node of an indexed red black tree
+ * Links are 32 bit positions in the tree's node store instead of pointers, which halves their size
+ */
+template<class Type>
+struct IndexedNode
+{
+    enum NodeColour : std::uint8_t
+    {
+        Red, Black
+    };
+
+    Type Key;
+    std::uint32_t Parent;
+    std::uint32_t RChild;
+    std::uint32_t LChild;
+    NodeColour Colour;
+
+};  //end IndexedNode definition
+
+
+/**
+ * Red black tree for very large key sets, storing every node in one contiguous, growable node store
+ * Nodes refer to each other by 32 bit index, so a tree holds up to 2^32 - 1 keys; sizes are counted in 64 bits
+ * Freed nodes are kept on a free list inside the store and reused by later insertions
+ * The linking and rebalancing is done by IndexedRedBlackAlgorithms, which StaticRedBlackTree shares
+ * Obeys the same five properties as RedBlackTree
+ */
+template<class Type>
+class IndexedRedBlackTree
+{
+public:
+    /** Index used for a missing child or parent, the same way RedBlackTree uses nullptr */
+    static const std::uint32_t NullIndex = UINT32_MAX;
+
+    IndexedRedBlackTree();
+
+    /**
+     * Grows the node store up front so that the given number of keys can be inserted without reallocating it
+     * @param NumKeys Number of keys to make room for
+     */
+    void Reserve(std::uint64_t NumKeys);
+
+    /**
+     * Inserts the given key into the tree, if it is not already in the tree
+     * Throws std::length_error if the tree already holds as many keys as 32 bit indices can address
+     * @param NewKey The new key to insert into the tree
+     */
+    void Insert(const Type NewKey);
+
+    /**
+     * Removes the given key from the tree, if it exists in the tree
+     * @param KeyToDelete The key to delete from the tree
+     */
+    void Delete(const Type KeyToDelete);
+
+    /**
+     * Finds the key passed as parameter in the tree, if it exists
+     * @param KeyToFind The key to search for in the tree
+     * @return true if key is in the tree, false otherwise
+     */
+    bool Find(const Type KeyToFind) const;
+
+    /**
+     * Finds the smallest key in the tree
+     * @return The smallest key in the tree
+     * @throws std::out_of_range if the tree is empty
+     */
+    Type FindMin() const;
+
+    /**
+     * Finds the largest key in the tree
+     * @return The largest key in the tree
+     * @throws std::out_of_range if the tree is empty
+     */
+    Type FindMax() const;
+
+    /***
+     * Makes and returns a sorted array of all elements in the tree
+     * @return A pointer to the first element of the newly created array
+     */
+    Type* MakeArray() const;
+
+    /** Getter function to retrieve size of the tree */
+    std::uint64_t GetSize() const;
+
+    int GetHeight() const;
+    int GetBlackHeight() const;
+
+private:
+    typedef IndexedRedBlackAlgorithms<std::vector<IndexedNode<Type>>, std::uint32_t> Algorithms;
+
+    /**
+     * Takes a node from the free list, or grows the node store by one node, and stores the key in it
+     * @param NewKey Key of the new node
+     * @return Index of the new node, which is red and unlinked
+     */
+    std::uint32_t NewNode(const Type NewKey);
+
+    /**
+     * Performs an in order traversal of the tree, filling an array with each element as needed
+     * @param A Current node for recursive fill
+     * @param Arr Array containing the sorted keys; is assumed to be of size at least equal to the tree size
+     * @param CurrElement Counter for which position we are currently filling in the array
+     */
+    void InOrderFill(std::uint32_t A, Type* Arr, std::uint64_t &CurrElement) const;
+
+    /** Every node, linked into the tree or on the free list */
+    std::vector<IndexedNode<Type>> Nodes;
+
+    /** Root node in the tree */
+    std::uint32_t Root;
+
+    /** First node on the free list; free nodes are chained through their right child index */
+    std::uint32_t FreeList;
+
+    /** The current number of nodes stored in the tree */
+    std::uint64_t Size;
+
+};  //end IndexedRedBlackTree definition
+
+
+
+template<class Type>
+IndexedRedBlackTree<Type>::IndexedRedBlackTree()
+{
+    Root = NullIndex;
+    FreeList = NullIndex;
+    Size = 0;
+}
+
+template<class Type>
+void IndexedRedBlackTree<Type>::Reserve(std::uint64_t NumKeys)
+{
+    Nodes.reserve(std::min<std::uint64_t>(NumKeys, NullIndex));
+}
+
+template<class Type>
+void IndexedRedBlackTree<Type>::Insert(const Type NewKey)
+{
+    std::uint32_t Par = Algorithms::Find(Nodes, Root, NewKey);
+    if (Par != NullIndex && Nodes[Par].Key == NewKey)
+    {
+        return;
+    }
+
+    //allocate before linking, since growing the store moves every node
+    std::uint32_t InsertedNode = NewNode(NewKey);
+    Algorithms::Link(Nodes, InsertedNode, Par, Root);
+    Size++;
+}
+
+template<class Type>
+void IndexedRedBlackTree<Type>::Delete(const Type KeyToDelete)
+{
+    std::uint32_t Z = Algorithms::Find(Nodes, Root, KeyToDelete);
+
+    //if the key doesn't exist in our tree, then just return
+    if (Z == NullIndex || Nodes[Z].Key != KeyToDelete)
+    {
+        return;
+    }
+
+    Algorithms::Erase(Nodes, Z, Root);
+    Algorithms::FreeNode(Nodes, Z, FreeList);
+    Size--;
+}
+
+template<class Type>
+bool IndexedRedBlackTree<Type>::Find(const Type KeyToFind) const
+{
+    if (Size == 0)
+    {
+        return false;
+    }
+
+    return Nodes[Algorithms::Find(Nodes, Root, KeyToFind)].Key == KeyToFind;
+}
+
+template<class Type>
+Type IndexedRedBlackTree<Type>::FindMin() const
+{
+    if (Size == 0)
+    {
+        throw std::out_of_range("FindMin called on an empty IndexedRedBlackTree");
+    }
+
+    return Nodes[Algorithms::Minimum(Nodes, Root)].Key;
+}
+
+template<class Type>
+Type IndexedRedBlackTree<Type>::FindMax() const
+{
+    if (Size == 0)
+    {
+        throw std::out_of_range("FindMax called on an empty IndexedRedBlackTree");
+    }
+
+    return Nodes[Algorithms::Maximum(Nodes, Root)].Key;
+}
+
+template<class Type>
+Type* IndexedRedBlackTree<Type>::MakeArray() const
+{
+    Type* Arr = new Type[this->Size];
+    std::uint64_t x = 0;
+    InOrderFill(this->Root, Arr, x);
+    return Arr;
+}
+
+template<class Type>
+std::uint64_t IndexedRedBlackTree<Type>::GetSize() const
+{
+    return Size;
+}
+
+template<class Type>
+int IndexedRedBlackTree<Type>::GetHeight() const
+{
+    return Algorithms::Height(Nodes, Root);
+}
+
+template<class Type>
+int IndexedRedBlackTree<Type>::GetBlackHeight() const
+{
+    return Algorithms::BlackHeight(Nodes, Root);
+}
+
+template<class Type>
+std::uint32_t IndexedRedBlackTree<Type>::NewNode(const Type NewKey)
+{
+    std::uint32_t NewIndex = Algorithms::TakeFreeNode(Nodes, FreeList);
+    if (NewIndex == NullIndex)
+    {
+        if (Nodes.size() >= NullIndex)
+        {
+            throw std::length_error("IndexedRedBlackTree cannot address more than 2^32 - 1 nodes");
+        }
+
+        NewIndex = static_cast<std::uint32_t>(Nodes.size());
+        Nodes.emplace_back();
+    }
+
+    Algorithms::InitNode(Nodes, NewIndex, NewKey);
+    return NewIndex;
+}
+
+template<class Type>
+void IndexedRedBlackTree<Type>::InOrderFill(std::uint32_t A, Type* Arr, std::uint64_t &CurrElement) const
+{
+    if (A == NullIndex)
+    {
+        return;
+    }
+
+    InOrderFill(Nodes[A].LChild, Arr, CurrElement);
+    Arr[CurrElement] = Nodes[A].Key;
+    CurrElement++;
+    InOrderFill(Nodes[A].RChild, Arr, CurrElement);
+}
+
+#endif //REDBLACKTREE_INDEXEDREDBLACKTREE_H
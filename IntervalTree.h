@@ -0,0 +1,185 @@
+#ifndef REDBLACKTREE_INTERVALTREE_H
+#define REDBLACKTREE_INTERVALTREE_H
+
+#include <vector>
+#include <limits>
+#include "RedBlackTree.h"
+
+/**
+ * A closed interval [Low, High] used as the key of an interval tree
+ * Intervals are ordered by their low endpoint, then by their high endpoint
+ */
+template<class Type>
+struct Interval
+{
+    Interval()
+    {
+    }
+
+    Interval(Type IntervalLow, Type IntervalHigh)
+    {
+        Low = IntervalLow;
+        High = IntervalHigh;
+    }
+
+    /** Does this interval share at least one point with [QueryLow, QueryHigh]? */
+    bool Overlaps(const Type QueryLow, const Type QueryHigh) const
+    {
+        return !(QueryHigh < Low) && !(High < QueryLow);
+    }
+
+    bool operator==(const Interval &Right) const
+    {
+        return Low == Right.Low && High == Right.High;
+    }
+
+    bool operator!=(const Interval &Right) const
+    {
+        return !(*this == Right);
+    }
+
+    bool operator<(const Interval &Right) const
+    {
+        return Low < Right.Low || (Low == Right.Low && High < Right.High);
+    }
+
+    Type Low;
+    Type High;
+
+};  //end Interval definition
+
+
+/**
+ * Subtree summary holding the largest high endpoint of the intervals in a subtree
+ */
+template<class Type>
+struct IntervalMaxSummary
+{
+    typedef Type Value;
+
+    static Value Identity()
+    {
+        return std::numeric_limits<Type>::lowest();
+    }
+
+    static Value Lift(const Interval<Type> &Key)
+    {
+        return Key.High;
+    }
+
+    static Value Combine(const Value &Left, const Value &Right)
+    {
+        return (Left < Right) ? Right : Left;
+    }
+};
+
+
+/**
+ * Interval tree built on top of the red black tree
+ * Each node remembers the largest endpoint in its subtree, which lets overlap queries skip whole subtrees
+ */
+template<class Type>
+class IntervalTree : public RedBlackTree<Interval<Type>, IntervalMaxSummary<Type>>
+{
+public:
+    using RedBlackTree<Interval<Type>, IntervalMaxSummary<Type>>::Insert;
+    using RedBlackTree<Interval<Type>, IntervalMaxSummary<Type>>::Delete;
+    using RedBlackTree<Interval<Type>, IntervalMaxSummary<Type>>::Find;
+
+    /**
+     * Inserts the interval [Low, High] into the tree, if it is not already in the tree
+     * @param Low Low endpoint of the interval
+     * @param High High endpoint of the interval; assumed to be no smaller than Low
+     */
+    void Insert(const Type Low, const Type High);
+
+    /**
+     * Removes the interval [Low, High] from the tree, if it exists in the tree
+     * @param Low Low endpoint of the interval
+     * @param High High endpoint of the interval
+     */
+    void Delete(const Type Low, const Type High);
+
+    /**
+     * Finds the interval [Low, High] in the tree, if it exists
+     * @return true if the interval is in the tree, false otherwise
+     */
+    bool Find(const Type Low, const Type High) const;
+
+    /**
+     * Finds every interval in the tree that overlaps the closed query window [QueryLow, QueryHigh]
+     * Subtrees whose largest endpoint lies before the window, or whose intervals all start after it, are never visited
+     * @param QueryLow Low endpoint of the query window
+     * @param QueryHigh High endpoint of the query window
+     * @return The overlapping intervals, sorted by low endpoint
+     */
+    std::vector<Interval<Type>> FindOverlapping(const Type QueryLow, const Type QueryHigh) const;
+
+private:
+    /**
+     * Collects the intervals overlapping the query window from the subtree rooted at the current node
+     * @param A Current node for the recursive search
+     * @param QueryLow Low endpoint of the query window
+     * @param QueryHigh High endpoint of the query window
+     * @param Found Vector the overlapping intervals are appended to, in sorted order
+     */
+    void FindOverlappingIntl(Node<Interval<Type>, IntervalMaxSummary<Type>>* A, const Type QueryLow,
+                             const Type QueryHigh, std::vector<Interval<Type>> &Found) const;
+
+};  //end IntervalTree definition
+
+
+
+template<class Type>
+void IntervalTree<Type>::Insert(const Type Low, const Type High)
+{
+    Insert(Interval<Type>(Low, High));
+}
+
+template<class Type>
+void IntervalTree<Type>::Delete(const Type Low, const Type High)
+{
+    Delete(Interval<Type>(Low, High));
+}
+
+template<class Type>
+bool IntervalTree<Type>::Find(const Type Low, const Type High) const
+{
+    return Find(Interval<Type>(Low, High));
+}
+
+template<class Type>
+std::vector<Interval<Type>> IntervalTree<Type>::FindOverlapping(const Type QueryLow, const Type QueryHigh) const
+{
+    std::vector<Interval<Type>> Found;
+    FindOverlappingIntl(this->Root, QueryLow, QueryHigh, Found);
+    return Found;
+}
+
+template<class Type>
+void IntervalTree<Type>::FindOverlappingIntl(Node<Interval<Type>, IntervalMaxSummary<Type>>* A, const Type QueryLow,
+                                             const Type QueryHigh, std::vector<Interval<Type>> &Found) const
+{
+    //nothing in this subtree reaches the query window
+    if (!A || A->SubtreeSummary < QueryLow)
+    {
+        return;
+    }
+
+    FindOverlappingIntl(A->LChild, QueryLow, QueryHigh, Found);
+
+    //this interval and everything to its right starts after the query window
+    if (QueryHigh < A->Key.Low)
+    {
+        return;
+    }
+
+    if (A->Key.Overlaps(QueryLow, QueryHigh))
+    {
+        Found.push_back(A->Key);
+    }
+
+    FindOverlappingIntl(A->RChild, QueryLow, QueryHigh, Found);
+}
+
+#endif //REDBLACKTREE_INTERVALTREE_H
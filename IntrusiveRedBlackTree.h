@@ -0,0 +1,309 @@
+#ifndef REDBLACKTREE_INTRUSIVEREDBLACKTREE_H
+#define REDBLACKTREE_INTRUSIVEREDBLACKTREE_H
+
+#include <cstddef>
+#include <type_traits>
+#include "RedBlackTree.h"
+
+/**
+ * The links an object needs to be stored in an intrusive red black tree: its parent, its two children and its colour
+ * Embed one as a member of the object; an object can be in as many trees at once as it has hooks
+ */
+struct RedBlackHook
+{
+    enum NodeColour
+    {
+        Red, Black
+    };
+
+    RedBlackHook()
+    {
+        Parent = RChild = LChild = nullptr;
+        Colour = NodeColour::Red;
+    }
+
+    /** Tests to see if this hook is black */
+    static bool TestColourBlack(const RedBlackHook* TestNode)
+    {
+        return !TestNode || TestNode->Colour == NodeColour::Black;
+    }
+
+    /** Tests to see if this hook is red */
+    static bool TestColourRed(const RedBlackHook* TestNode)
+    {
+        return TestNode && TestNode->Colour == NodeColour::Red;
+    }
+
+    RedBlackHook* Parent;
+    RedBlackHook* RChild;
+    RedBlackHook* LChild;
+    NodeColour Colour;
+
+};  //end RedBlackHook definition
+
+
+/**
+ * Red black tree that links together objects owned by the caller instead of allocating nodes of its own
+ * Inserting and erasing never allocate or copy keys; the tree only rewires the hooks embedded in the objects
+ * The caller must keep every object alive, and must not change its key, for as long as it is in the tree
+ *
+ * @tparam Object The type of the objects stored in the tree; must be standard layout
+ * @tparam KeyType The type of the key the objects are ordered by
+ * @tparam KeyMember Pointer to the key member of Object
+ * @tparam HookMember Pointer to the RedBlackHook member of Object this tree links through
+ */
+template<class Object, class KeyType, KeyType Object::*KeyMember, RedBlackHook Object::*HookMember>
+class IntrusiveRedBlackTree
+{
+    static_assert(std::is_standard_layout<Object>::value, "Objects need a standard layout to be found from their hook");
+
+public:
+    IntrusiveRedBlackTree();
+
+    /** Leaves every object where it is; the tree never owns the objects linked into it */
+    ~IntrusiveRedBlackTree();
+
+    /**
+     * Links the object into the tree, if no object with the same key is already in the tree
+     * @param NewObject The object to link; must not currently be linked through this hook
+     * @return true if the object was linked, false if its key was already in the tree
+     */
+    bool Insert(Object &NewObject);
+
+    /**
+     * Unlinks the object from the tree, without searching for it
+     * @param ObjectToErase The object to unlink; must currently be linked into this tree
+     */
+    void Erase(Object &ObjectToErase);
+
+    /**
+     * Unlinks the object with the given key from the tree, if it exists in the tree
+     * @param KeyToDelete The key to remove from the tree
+     * @return The object that was unlinked, or nullptr if the key was not in the tree
+     */
+    Object* Delete(const KeyType KeyToDelete);
+
+    /**
+     * Finds the object with the given key in the tree, if it exists
+     * @param KeyToFind The key to search for in the tree
+     * @return The object with the given key, or nullptr if the key is not in the tree
+     */
+    Object* Find(const KeyType KeyToFind) const;
+
+    /** @return The object with the smallest key in the tree, or nullptr if the tree is empty */
+    Object* FindMin() const;
+
+    /** @return The object with the largest key in the tree, or nullptr if the tree is empty */
+    Object* FindMax() const;
+
+    /** Getter function to retrieve size of the tree */
+    std::size_t GetSize() const;
+
+    /**
+     * Forgets every object in the tree in O(1)
+     * The hooks of the objects are left as they were, and should not be relied on until they are linked again
+     */
+    void Clear();
+
+private:
+    typedef RedBlackAlgorithms<RedBlackHook> Algorithms;
+
+    /** Returns the object a hook is embedded in; only called once an object has been inserted */
+    Object* ObjectOf(RedBlackHook* Hook) const;
+
+    /** Returns the key of the object a hook is embedded in */
+    const KeyType &KeyOf(RedBlackHook* Hook) const;
+
+    /**
+     * Returns the hook of the object with a key matching the key passed as parameter
+     * If no object in the tree has a matching key, then the hook of the parent of where the key should be is returned
+     * @param KeyToFind The key to search for
+     * @return The matching hook, or the hook of the parent of where the key should go
+     */
+    RedBlackHook* FindIntl(const KeyType KeyToFind) const;
+
+    /** Root hook in the tree */
+    RedBlackHook* Root;
+
+    /** The current number of objects linked into the tree */
+    std::size_t Size;
+
+    /**
+     * How far into an Object its hook sits, measured on the first object inserted; the same for every object, and
+     * only needed once the tree holds one
+     */
+    std::ptrdiff_t HookOffset;
+
+};  //end IntrusiveRedBlackTree definition
+
+
+
+template<class Object, class KeyType, KeyType Object::*KeyMember, RedBlackHook Object::*HookMember>
+IntrusiveRedBlackTree<Object, KeyType, KeyMember, HookMember>::IntrusiveRedBlackTree()
+{
+    Root = nullptr;
+    Size = 0;
+    HookOffset = 0;
+}
+
+template<class Object, class KeyType, KeyType Object::*KeyMember, RedBlackHook Object::*HookMember>
+IntrusiveRedBlackTree<Object, KeyType, KeyMember, HookMember>::~IntrusiveRedBlackTree()
+{
+    Root = nullptr;
+}
+
+template<class Object, class KeyType, KeyType Object::*KeyMember, RedBlackHook Object::*HookMember>
+bool IntrusiveRedBlackTree<Object, KeyType, KeyMember, HookMember>::Insert(Object &NewObject)
+{
+    RedBlackHook* NewHook = &(NewObject.*HookMember);
+
+    //if the root is null, then the object becomes the black root, and the first object gives the hook's offset
+    if (!Root)
+    {
+        HookOffset = reinterpret_cast<char*>(NewHook) - reinterpret_cast<char*>(&NewObject);
+        NewHook->Parent = NewHook->LChild = NewHook->RChild = nullptr;
+        NewHook->Colour = RedBlackHook::NodeColour::Black;
+        Root = NewHook;
+        Size++;
+        return true;
+    }
+
+    RedBlackHook* Par = FindIntl(NewObject.*KeyMember);
+    if (KeyOf(Par) == NewObject.*KeyMember)
+    {
+        return false;
+    }
+
+    if (NewObject.*KeyMember < KeyOf(Par))
+    {
+        Par->LChild = NewHook;
+    }
+    else
+    {
+        Par->RChild = NewHook;
+    }
+
+    NewHook->Parent = Par;
+    NewHook->LChild = NewHook->RChild = nullptr;
+    NewHook->Colour = RedBlackHook::NodeColour::Red;
+    Size++;
+
+    Algorithms::FixInsertion(NewHook, Root);
+    return true;
+}
+
+template<class Object, class KeyType, KeyType Object::*KeyMember, RedBlackHook Object::*HookMember>
+void IntrusiveRedBlackTree<Object, KeyType, KeyMember, HookMember>::Erase(Object &ObjectToErase)
+{
+    Algorithms::Erase(&(ObjectToErase.*HookMember), Root);
+    Size--;
+}
+
+template<class Object, class KeyType, KeyType Object::*KeyMember, RedBlackHook Object::*HookMember>
+Object* IntrusiveRedBlackTree<Object, KeyType, KeyMember, HookMember>::Delete(const KeyType KeyToDelete)
+{
+    Object* Found = Find(KeyToDelete);
+    if (Found)
+    {
+        Erase(*Found);
+    }
+    return Found;
+}
+
+template<class Object, class KeyType, KeyType Object::*KeyMember, RedBlackHook Object::*HookMember>
+Object* IntrusiveRedBlackTree<Object, KeyType, KeyMember, HookMember>::Find(const KeyType KeyToFind) const
+{
+    if (Size == 0)
+    {
+        return nullptr;
+    }
+
+    RedBlackHook* FoundHook = FindIntl(KeyToFind);
+    return KeyOf(FoundHook) == KeyToFind ? ObjectOf(FoundHook) : nullptr;
+}
+
+template<class Object, class KeyType, KeyType Object::*KeyMember, RedBlackHook Object::*HookMember>
+Object* IntrusiveRedBlackTree<Object, KeyType, KeyMember, HookMember>::FindMin() const
+{
+    if (!Root)
+    {
+        return nullptr;
+    }
+
+    RedBlackHook* CurrNode = Root;
+    while (CurrNode->LChild)
+    {
+        CurrNode = CurrNode->LChild;
+    }
+    return ObjectOf(CurrNode);
+}
+
+template<class Object, class KeyType, KeyType Object::*KeyMember, RedBlackHook Object::*HookMember>
+Object* IntrusiveRedBlackTree<Object, KeyType, KeyMember, HookMember>::FindMax() const
+{
+    if (!Root)
+    {
+        return nullptr;
+    }
+
+    RedBlackHook* CurrNode = Root;
+    while (CurrNode->RChild)
+    {
+        CurrNode = CurrNode->RChild;
+    }
+    return ObjectOf(CurrNode);
+}
+
+template<class Object, class KeyType, KeyType Object::*KeyMember, RedBlackHook Object::*HookMember>
+std::size_t IntrusiveRedBlackTree<Object, KeyType, KeyMember, HookMember>::GetSize() const
+{
+    return Size;
+}
+
+template<class Object, class KeyType, KeyType Object::*KeyMember, RedBlackHook Object::*HookMember>
+void IntrusiveRedBlackTree<Object, KeyType, KeyMember, HookMember>::Clear()
+{
+    Root = nullptr;
+    Size = 0;
+}
+
+template<class Object, class KeyType, KeyType Object::*KeyMember, RedBlackHook Object::*HookMember>
+Object* IntrusiveRedBlackTree<Object, KeyType, KeyMember, HookMember>::ObjectOf(RedBlackHook* Hook) const
+{
+    return reinterpret_cast<Object*>(reinterpret_cast<char*>(Hook) - HookOffset);
+}
+
+template<class Object, class KeyType, KeyType Object::*KeyMember, RedBlackHook Object::*HookMember>
+const KeyType &IntrusiveRedBlackTree<Object, KeyType, KeyMember, HookMember>::KeyOf(RedBlackHook* Hook) const
+{
+    return ObjectOf(Hook)->*KeyMember;
+}
+
+template<class Object, class KeyType, KeyType Object::*KeyMember, RedBlackHook Object::*HookMember>
+RedBlackHook* IntrusiveRedBlackTree<Object, KeyType, KeyMember, HookMember>::FindIntl(const KeyType KeyToFind) const
+{
+    RedBlackHook* Par = nullptr;
+    RedBlackHook* CurrNode = Root;
+    while (CurrNode)
+    {
+        const KeyType &CurrKey = KeyOf(CurrNode);
+        if (KeyToFind == CurrKey)
+        {
+            return CurrNode;
+        }
+
+        Par = CurrNode;
+        if (KeyToFind < CurrKey)
+        {
+            CurrNode = CurrNode->LChild;
+        }
+        else
+        {
+            CurrNode = CurrNode->RChild;
+        }
+    }
+
+    return Par;
+}
+
+#endif //REDBLACKTREE_INTRUSIVEREDBLACKTREE_H
@@ -0,0 +1,331 @@
+#ifndef REDBLACKTREE_KEYFILELOADER_H
+#define REDBLACKTREE_KEYFILELOADER_H
+
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include "RedBlackTree.h"
+
+#if defined(_WIN32)
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * What a key file load did and how long each stage took
+ */
+struct KeyFileLoadStats
+{
+    /** Size of the file in bytes */
+    std::size_t Bytes;
+
+    /** Keys read from the file, duplicates included */
+    std::size_t KeysParsed;
+
+    /** Distinct keys, which is how many the tree ends up with */
+    std::size_t UniqueKeys;
+
+    /** Time spent mapping and parsing the file */
+    double ParseSeconds;
+
+    /** Time spent sorting, merging and deduplicating the parsed keys */
+    double SortSeconds;
+
+    /** Time spent building the tree from the sorted keys */
+    double BuildSeconds;
+};
+
+/**
+ * Loads text files of keys, separated by whitespace and usually one per line, straight into a red black tree
+ * The file is memory-mapped and cut into one chunk per thread at whitespace boundaries; each thread parses its chunk
+ * with std::from_chars, which neither allocates nor looks at the locale, then sorts and deduplicates its own keys.
+ * The sorted runs are merged pairwise, in parallel, and the tree is built from the result in linear time with
+ * AssignSorted instead of one Insert per key
+ *
+ * Platforms without mmap read the whole file into memory instead
+ *
+ * Assumes that Type is an arithmetic type std::from_chars can parse
+ */
+template<class Type>
+class KeyFileLoader
+{
+public:
+    /**
+     * Replaces the contents of a tree with the distinct keys of a text file
+     * Throws std::runtime_error if the file cannot be read or holds something that is not a key
+     * @param Path The file to load
+     * @param Tree The tree to load the keys into
+     * @param NumThreads How many threads to use; 0 uses one per hardware thread
+     * @return Counts and timings of the load
+     */
+    template<class Summary, class Allocator>
+    static KeyFileLoadStats Load(const std::string &Path, RedBlackTree<Type, Summary, Allocator> &Tree,
+                                 unsigned NumThreads = 0);
+
+private:
+    /** Read-only view of a whole file, mapped into memory where the platform allows it */
+    class MappedFile
+    {
+    public:
+        explicit MappedFile(const std::string &Path);
+        ~MappedFile();
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        const char* Data;
+        std::size_t Size;
+
+    private:
+#if defined(_WIN32)
+        std::vector<char> Contents;
+#endif
+    };
+
+    /**
+     * Parses every key in [Begin, End)
+     * @param Begin First byte of the chunk; must not fall in the middle of a key
+     * @param End One past the last byte of the chunk; must not fall in the middle of a key
+     * @param Keys Where to put the keys
+     * @return nullptr on success, otherwise the position of the first byte that is not part of a valid key
+     */
+    static const char* ParseChunk(const char* Begin, const char* End, std::vector<Type> &Keys);
+
+    static bool IsSpace(char Character);
+
+    /**
+     * Calls Body(i) for every i in [0, Count) on up to NumThreads threads
+     */
+    template<class Function>
+    static void ForEachParallel(std::size_t Count, unsigned NumThreads, Function Body);
+
+};  //end KeyFileLoader definition
+
+template<class Type>
+template<class Summary, class Allocator>
+KeyFileLoadStats KeyFileLoader<Type>::Load(const std::string &Path, RedBlackTree<Type, Summary, Allocator> &Tree,
+                                           unsigned NumThreads)
+{
+    if (NumThreads == 0)
+    {
+        NumThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    KeyFileLoadStats Stats;
+    auto Start = std::chrono::steady_clock::now();
+
+    MappedFile File(Path);
+    Stats.Bytes = File.Size;
+
+    //move every cut forward to the next whitespace, so that no key is split between two chunks
+    std::vector<const char*> Cuts(NumThreads + 1);
+    Cuts[0] = File.Data;
+    Cuts[NumThreads] = File.Data + File.Size;
+    for (unsigned i = 1; i < NumThreads; i++)
+    {
+        const char* Cut = std::max(Cuts[i - 1], File.Data + File.Size / NumThreads * i);
+        while (Cut < Cuts[NumThreads] && !IsSpace(*Cut))
+        {
+            Cut++;
+        }
+        Cuts[i] = Cut;
+    }
+
+    std::vector<std::vector<Type>> Runs(NumThreads);
+    std::vector<const char*> Errors(NumThreads);
+    ForEachParallel(NumThreads, NumThreads, [&](std::size_t i)
+    {
+        Errors[i] = ParseChunk(Cuts[i], Cuts[i + 1], Runs[i]);
+    });
+
+    for (const char* Error : Errors)
+    {
+        if (Error)
+        {
+            throw std::runtime_error("Malformed key in " + Path + " at byte " + std::to_string(Error - File.Data));
+        }
+    }
+
+    Stats.KeysParsed = 0;
+    for (const std::vector<Type> &Run : Runs)
+    {
+        Stats.KeysParsed += Run.size();
+    }
+
+    auto Parsed = std::chrono::steady_clock::now();
+    Stats.ParseSeconds = std::chrono::duration<double>(Parsed - Start).count();
+
+    ForEachParallel(Runs.size(), NumThreads, [&Runs](std::size_t i)
+    {
+        std::sort(Runs[i].begin(), Runs[i].end());
+        Runs[i].erase(std::unique(Runs[i].begin(), Runs[i].end()), Runs[i].end());
+    });
+
+    //merge neighbouring runs pairwise until one is left; each round merges its pairs in parallel
+    while (Runs.size() > 1)
+    {
+        std::vector<std::vector<Type>> Merged((Runs.size() + 1) / 2);
+        ForEachParallel(Merged.size(), NumThreads, [&Runs, &Merged](std::size_t i)
+        {
+            if (2 * i + 1 == Runs.size())
+            {
+                Merged[i] = std::move(Runs[2 * i]);
+                return;
+            }
+
+            const std::vector<Type> &Left = Runs[2 * i];
+            const std::vector<Type> &Right = Runs[2 * i + 1];
+            Merged[i].resize(Left.size() + Right.size());
+            Merged[i].erase(std::set_union(Left.begin(), Left.end(), Right.begin(), Right.end(), Merged[i].begin()),
+                            Merged[i].end());
+            std::vector<Type>().swap(Runs[2 * i]);
+            std::vector<Type>().swap(Runs[2 * i + 1]);
+        });
+        Runs.swap(Merged);
+    }
+
+    std::vector<Type> Keys = std::move(Runs[0]);
+    Stats.UniqueKeys = Keys.size();
+
+    auto Sorted = std::chrono::steady_clock::now();
+    Stats.SortSeconds = std::chrono::duration<double>(Sorted - Parsed).count();
+
+    Tree.AssignSorted(Keys.data(), Keys.size());
+    Stats.BuildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Sorted).count();
+
+    return Stats;
+}
+
+template<class Type>
+KeyFileLoader<Type>::MappedFile::MappedFile(const std::string &Path)
+{
+    Data = nullptr;
+    Size = 0;
+
+#if defined(_WIN32)
+    std::ifstream In(Path, std::ios::binary | std::ios::ate);
+    if (!In)
+    {
+        throw std::runtime_error("Cannot open " + Path);
+    }
+    Contents.resize((std::size_t) In.tellg());
+    In.seekg(0);
+    In.read(Contents.data(), (std::streamsize) Contents.size());
+    Data = Contents.data();
+    Size = Contents.size();
+#else
+    int Descriptor = open(Path.c_str(), O_RDONLY);
+    if (Descriptor < 0)
+    {
+        throw std::runtime_error("Cannot open " + Path);
+    }
+
+    struct stat Status;
+    if (fstat(Descriptor, &Status) != 0)
+    {
+        close(Descriptor);
+        throw std::runtime_error("Cannot read the size of " + Path);
+    }
+    Size = (std::size_t) Status.st_size;
+
+    //mapping an empty file fails, and there is nothing to read from it anyway
+    if (Size != 0)
+    {
+        void* Mapping = mmap(nullptr, Size, PROT_READ, MAP_PRIVATE, Descriptor, 0);
+        if (Mapping == MAP_FAILED)
+        {
+            close(Descriptor);
+            throw std::runtime_error("Cannot map " + Path);
+        }
+        madvise(Mapping, Size, MADV_SEQUENTIAL);
+        Data = (const char*) Mapping;
+    }
+
+    //the mapping stays valid after the descriptor is closed
+    close(Descriptor);
+#endif
+}
+
+template<class Type>
+KeyFileLoader<Type>::MappedFile::~MappedFile()
+{
+#if !defined(_WIN32)
+    if (Data)
+    {
+        munmap((void*) Data, Size);
+    }
+#endif
+}
+
+template<class Type>
+const char* KeyFileLoader<Type>::ParseChunk(const char* Begin, const char* End, std::vector<Type> &Keys)
+{
+    const char* Curr = Begin;
+    while (true)
+    {
+        while (Curr < End && IsSpace(*Curr))
+        {
+            Curr++;
+        }
+        if (Curr == End)
+        {
+            break;
+        }
+
+        Type Key;
+        std::from_chars_result Result = std::from_chars(Curr, End, Key);
+        if (Result.ec != std::errc() || (Result.ptr != End && !IsSpace(*Result.ptr)))
+        {
+            return Curr;
+        }
+        Keys.push_back(Key);
+        Curr = Result.ptr;
+    }
+
+    return nullptr;
+}
+
+template<class Type>
+bool KeyFileLoader<Type>::IsSpace(char Character)
+{
+    return Character == '\n' || Character == ' ' || Character == '\r' || Character == '\t';
+}
+
+template<class Type>
+template<class Function>
+void KeyFileLoader<Type>::ForEachParallel(std::size_t Count, unsigned NumThreads, Function Body)
+{
+    std::atomic<std::size_t> NextIndex(0);
+    auto Worker = [&NextIndex, Count, &Body]()
+    {
+        for (std::size_t i = NextIndex++; i < Count; i = NextIndex++)
+        {
+            Body(i);
+        }
+    };
+
+    std::vector<std::thread> Threads;
+    for (unsigned i = 1; i < std::min<std::size_t>(NumThreads, Count); i++)
+    {
+        Threads.emplace_back(Worker);
+    }
+    Worker();
+
+    for (std::thread &Thread : Threads)
+    {
+        Thread.join();
+    }
+}
+
+#endif //REDBLACKTREE_KEYFILELOADER_H
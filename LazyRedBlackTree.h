@@ -0,0 +1,536 @@
+#ifndef REDBLACKTREE_LAZYREDBLACKTREE_H
+#define REDBLACKTREE_LAZYREDBLACKTREE_H
+
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include <cstddef>
+#include "RedBlackTree.h"
+
+/**
+ * Container for a single node of a lazy red black tree: a key, its colour, its parent, two siblings, and whether
+ * the key has been deleted
+ * A deleted node, or tombstone, still routes searches until the tree is compacted
+ */
+template<class Type>
+struct LazyNode
+{
+    enum NodeColour
+    {
+        Red, Black
+    };
+
+    LazyNode(const Type &NodeKey) : Key(NodeKey)
+    {
+        Parent = RChild = LChild = nullptr;
+        Tombstone = false;
+    }
+
+    ~LazyNode()
+    {
+        delete RChild;
+        delete LChild;
+    }
+
+    /** Tests to see if this node is black */
+    static bool TestColourBlack(const LazyNode* TestNode)
+    {
+        return !TestNode || TestNode->Colour == NodeColour::Black;
+    }
+
+    /** Tests to see if this node is red */
+    static bool TestColourRed(const LazyNode* TestNode)
+    {
+        return TestNode && TestNode->Colour == NodeColour::Red;
+    }
+
+    LazyNode* Parent;
+    LazyNode* RChild;
+    LazyNode* LChild;
+    Type Key;
+    NodeColour Colour;
+    bool Tombstone;
+
+};  //end LazyNode definition
+
+
+/**
+ * Red black tree whose deletions only mark the node holding the key as a tombstone, in a single descent with no
+ * rotations or recolouring
+ * Searches and iteration skip tombstones, and a compaction pass frees them all at once and rebuilds a perfectly
+ * balanced tree from the surviving nodes in O(n), without allocating a node
+ * Compaction runs either when asked for, or automatically once tombstones make up more than a set fraction of the
+ * nodes, so its cost is spread over the deletions that made it necessary
+ *
+ * Assumes that any templated type has valid comparison operators
+ */
+template<class Type>
+class LazyRedBlackTree
+{
+public:
+    /**
+     * @param CompactionThreshold Fraction of the nodes that may be tombstones before a deletion compacts the tree;
+     *                            0 leaves compaction entirely to Compact
+     */
+    explicit LazyRedBlackTree(double CompactionThreshold = 0.5);
+
+    ~LazyRedBlackTree();
+
+    /**
+     * Inserts the given key into the tree, if it is not already in the tree
+     * A key that was deleted but not yet compacted away is revived in place
+     * @param NewKey The new key to insert into the tree
+     */
+    void Insert(const Type NewKey);
+
+    /**
+     * Marks the given key as deleted, if it exists in the tree; the node stays in the tree until it is compacted
+     * @param KeyToDelete The key to delete from the tree
+     */
+    void Delete(const Type KeyToDelete);
+
+    /**
+     * Finds the key passed as parameter in the tree, if it exists
+     * @param KeyToFind The key to search for in the tree
+     * @return true if key is in the tree and not deleted, false otherwise
+     */
+    bool Find(const Type KeyToFind) const;
+
+    /**
+     * Finds the smallest key in the tree, stepping over tombstones
+     * @return The smallest key in the tree
+     * @throws std::out_of_range if the tree is empty
+     */
+    Type FindMin() const;
+
+    /**
+     * Finds the largest key in the tree, stepping over tombstones
+     * @return The largest key in the tree
+     * @throws std::out_of_range if the tree is empty
+     */
+    Type FindMax() const;
+
+    /***
+     * Makes and returns a sorted array of all elements in the tree
+     * @return A pointer to the first element of the newly created array
+     */
+    Type* MakeArray() const;
+
+    /**
+     * Frees every tombstone and rebuilds the tree perfectly balanced from the remaining nodes
+     * @return The number of tombstones freed
+     */
+    std::size_t Compact();
+
+    /**
+     * Sets the fraction of the nodes that may be tombstones before a deletion compacts the tree
+     * @param NewThreshold The new fraction; 0 leaves compaction entirely to Compact
+     */
+    void SetCompactionThreshold(double NewThreshold);
+
+    /** Getter function to retrieve size of the tree, not counting tombstones */
+    std::size_t GetSize() const;
+
+    /** Getter function to retrieve the number of tombstones waiting to be compacted */
+    std::size_t GetTombstoneCount() const;
+
+    int GetHeight() const;
+    int GetBlackHeight() const;
+
+private:
+    typedef RedBlackAlgorithms<LazyNode<Type>> Algorithms;
+
+    /**
+     * Returns a pointer to the node with a key matching the key passed as parameter, tombstone or not
+     * If no node in the tree has a matching key, then the parent of where the key should be is returned
+     * @param KeyToFind The key to search for
+     * @return The node matching the key, or the parent of the node where the key should go
+     */
+    LazyNode<Type>* FindIntl(const Type &KeyToFind) const;
+
+    /**
+     * Returns the node holding the next larger key than the node passed as parameter, tombstone or not
+     * @return The next node in order, or nullptr if the node holds the largest key
+     */
+    static LazyNode<Type>* NextNode(LazyNode<Type>* CurrNode);
+
+    /** Returns the node holding the next smaller key than the node passed as parameter, tombstone or not */
+    static LazyNode<Type>* PrevNode(LazyNode<Type>* CurrNode);
+
+    /**
+     * Detaches every node of a subtree, freeing the tombstones and collecting the rest in sorted order
+     * @param A Root of the subtree; may be null
+     * @param Live Filled with the surviving nodes
+     * @return The number of tombstones freed
+     */
+    std::size_t CollectLive(LazyNode<Type>* A, std::vector<LazyNode<Type>*> &Live);
+
+    /**
+     * Links a run of sorted nodes into a perfectly balanced subtree
+     * Nodes on the deepest level are coloured red when that level is not full, and every other node black,
+     * so every path down to a leaf passes the same number of black nodes
+     * @param Nodes The sorted nodes
+     * @param Begin First node of the run
+     * @param End One past the last node of the run
+     * @param Par Parent of the subtree
+     * @param Depth Depth of the subtree's root
+     * @param RedDepth Depth at which nodes are coloured red, or -1 for none
+     * @return The root of the subtree
+     */
+    static LazyNode<Type>* BuildBalanced(const std::vector<LazyNode<Type>*> &Nodes, std::size_t Begin,
+                                         std::size_t End, LazyNode<Type>* Par, int Depth, int RedDepth);
+
+    void InOrderFill(LazyNode<Type>* A, Type* Arr, std::size_t &CurrElement) const;
+
+    int GetHeightIntl(LazyNode<Type>* Curr) const;
+
+    LazyNode<Type>* Root;
+
+    /** The number of live keys in the tree */
+    std::size_t Size;
+
+    /** The number of deleted nodes still linked into the tree */
+    std::size_t Tombstones;
+
+    double CompactionThreshold;
+
+};  //end LazyRedBlackTree definition
+
+template<class Type>
+LazyRedBlackTree<Type>::LazyRedBlackTree(double CompactionThreshold)
+{
+    Root = nullptr;
+    Size = 0;
+    Tombstones = 0;
+    this->CompactionThreshold = CompactionThreshold;
+}
+
+template<class Type>
+LazyRedBlackTree<Type>::~LazyRedBlackTree()
+{
+    delete Root;
+}
+
+template<class Type>
+void LazyRedBlackTree<Type>::Insert(const Type NewKey)
+{
+    if (!Root)
+    {
+        Root = new LazyNode<Type>(NewKey);
+        Root->Colour = LazyNode<Type>::NodeColour::Black;
+        Size++;
+        return;
+    }
+
+    LazyNode<Type>* Par = FindIntl(NewKey);
+    if (Par->Key == NewKey)
+    {
+        if (Par->Tombstone)
+        {
+            Par->Tombstone = false;
+            Tombstones--;
+            Size++;
+        }
+        return;
+    }
+
+    LazyNode<Type>* InsertedNode = new LazyNode<Type>(NewKey);
+    if (NewKey < Par->Key)
+    {
+        Par->LChild = InsertedNode;
+    }
+    else
+    {
+        Par->RChild = InsertedNode;
+    }
+
+    InsertedNode->Colour = LazyNode<Type>::NodeColour::Red;
+    InsertedNode->Parent = Par;
+    Size++;
+
+    Algorithms::FixInsertion(InsertedNode, Root);
+}
+
+template<class Type>
+void LazyRedBlackTree<Type>::Delete(const Type KeyToDelete)
+{
+    if (Size == 0)
+    {
+        return;
+    }
+
+    LazyNode<Type>* NodeToDelete = FindIntl(KeyToDelete);
+    if (NodeToDelete->Key != KeyToDelete || NodeToDelete->Tombstone)
+    {
+        return;
+    }
+
+    NodeToDelete->Tombstone = true;
+    Tombstones++;
+    Size--;
+
+    if (CompactionThreshold > 0 && Tombstones > CompactionThreshold * (Size + Tombstones))
+    {
+        Compact();
+    }
+}
+
+template<class Type>
+bool LazyRedBlackTree<Type>::Find(const Type KeyToFind) const
+{
+    if (!Root)
+    {
+        return false;
+    }
+
+    LazyNode<Type>* FoundNode = FindIntl(KeyToFind);
+    return FoundNode->Key == KeyToFind && !FoundNode->Tombstone;
+}
+
+template<class Type>
+Type LazyRedBlackTree<Type>::FindMin() const
+{
+    if (Size == 0)
+    {
+        throw std::out_of_range("FindMin called on an empty LazyRedBlackTree");
+    }
+
+    LazyNode<Type>* Min = Root;
+    while (Min->LChild)
+    {
+        Min = Min->LChild;
+    }
+    while (Min->Tombstone)
+    {
+        Min = NextNode(Min);
+    }
+    return Min->Key;
+}
+
+template<class Type>
+Type LazyRedBlackTree<Type>::FindMax() const
+{
+    if (Size == 0)
+    {
+        throw std::out_of_range("FindMax called on an empty LazyRedBlackTree");
+    }
+
+    LazyNode<Type>* Max = Root;
+    while (Max->RChild)
+    {
+        Max = Max->RChild;
+    }
+    while (Max->Tombstone)
+    {
+        Max = PrevNode(Max);
+    }
+    return Max->Key;
+}
+
+template<class Type>
+Type* LazyRedBlackTree<Type>::MakeArray() const
+{
+    Type* Arr = new Type[Size];
+    std::size_t x = 0;
+    InOrderFill(Root, Arr, x);
+    return Arr;
+}
+
+template<class Type>
+std::size_t LazyRedBlackTree<Type>::Compact()
+{
+    if (Tombstones == 0)
+    {
+        return 0;
+    }
+
+    std::vector<LazyNode<Type>*> Live;
+    Live.reserve(Size);
+    std::size_t Freed = CollectLive(Root, Live);
+
+    //the deepest level of a balanced tree of n nodes is level floor(log2 n), which is only partly filled unless
+    //n + 1 is a power of two
+    int RedDepth = -1;
+    if ((Size + 1) & Size)
+    {
+        RedDepth = 0;
+        for (std::size_t Remaining = Size; Remaining > 1; Remaining >>= 1)
+        {
+            RedDepth++;
+        }
+    }
+
+    Root = BuildBalanced(Live, 0, Live.size(), nullptr, 0, RedDepth);
+    Tombstones = 0;
+    return Freed;
+}
+
+template<class Type>
+void LazyRedBlackTree<Type>::SetCompactionThreshold(double NewThreshold)
+{
+    CompactionThreshold = NewThreshold;
+}
+
+template<class Type>
+std::size_t LazyRedBlackTree<Type>::GetSize() const
+{
+    return Size;
+}
+
+template<class Type>
+std::size_t LazyRedBlackTree<Type>::GetTombstoneCount() const
+{
+    return Tombstones;
+}
+
+template<class Type>
+int LazyRedBlackTree<Type>::GetHeight() const
+{
+    return GetHeightIntl(Root);
+}
+
+template<class Type>
+int LazyRedBlackTree<Type>::GetBlackHeight() const
+{
+    int BlackHeight = 0;
+    for (LazyNode<Type>* CurrNode = Root; CurrNode; CurrNode = CurrNode->LChild)
+    {
+        if (CurrNode->Colour == LazyNode<Type>::NodeColour::Black)
+        {
+            BlackHeight++;
+        }
+    }
+    return BlackHeight;
+}
+
+template<class Type>
+LazyNode<Type>* LazyRedBlackTree<Type>::FindIntl(const Type &KeyToFind) const
+{
+    LazyNode<Type>* Par = nullptr;
+    LazyNode<Type>* CurrNode = Root;
+    while (CurrNode)
+    {
+        if (KeyToFind == CurrNode->Key)
+        {
+            return CurrNode;
+        }
+
+        Par = CurrNode;
+        CurrNode = (KeyToFind < CurrNode->Key) ? CurrNode->LChild : CurrNode->RChild;
+    }
+    return Par;
+}
+
+template<class Type>
+LazyNode<Type>* LazyRedBlackTree<Type>::NextNode(LazyNode<Type>* CurrNode)
+{
+    if (CurrNode->RChild)
+    {
+        CurrNode = CurrNode->RChild;
+        while (CurrNode->LChild)
+        {
+            CurrNode = CurrNode->LChild;
+        }
+        return CurrNode;
+    }
+
+    while (CurrNode->Parent && CurrNode->Parent->RChild == CurrNode)
+    {
+        CurrNode = CurrNode->Parent;
+    }
+    return CurrNode->Parent;
+}
+
+template<class Type>
+LazyNode<Type>* LazyRedBlackTree<Type>::PrevNode(LazyNode<Type>* CurrNode)
+{
+    if (CurrNode->LChild)
+    {
+        CurrNode = CurrNode->LChild;
+        while (CurrNode->RChild)
+        {
+            CurrNode = CurrNode->RChild;
+        }
+        return CurrNode;
+    }
+
+    while (CurrNode->Parent && CurrNode->Parent->LChild == CurrNode)
+    {
+        CurrNode = CurrNode->Parent;
+    }
+    return CurrNode->Parent;
+}
+
+template<class Type>
+std::size_t LazyRedBlackTree<Type>::CollectLive(LazyNode<Type>* A, std::vector<LazyNode<Type>*> &Live)
+{
+    if (!A)
+    {
+        return 0;
+    }
+
+    LazyNode<Type>* Right = A->RChild;
+    std::size_t Freed = CollectLive(A->LChild, Live);
+
+    A->LChild = A->RChild = nullptr;
+    if (A->Tombstone)
+    {
+        delete A;
+        Freed++;
+    }
+    else
+    {
+        Live.push_back(A);
+    }
+
+    return Freed + CollectLive(Right, Live);
+}
+
+template<class Type>
+LazyNode<Type>* LazyRedBlackTree<Type>::BuildBalanced(const std::vector<LazyNode<Type>*> &Nodes, std::size_t Begin,
+                                                      std::size_t End, LazyNode<Type>* Par, int Depth, int RedDepth)
+{
+    if (Begin == End)
+    {
+        return nullptr;
+    }
+
+    std::size_t Mid = Begin + (End - Begin) / 2;
+    LazyNode<Type>* SubtreeRoot = Nodes[Mid];
+    SubtreeRoot->Parent = Par;
+    SubtreeRoot->LChild = BuildBalanced(Nodes, Begin, Mid, SubtreeRoot, Depth + 1, RedDepth);
+    SubtreeRoot->RChild = BuildBalanced(Nodes, Mid + 1, End, SubtreeRoot, Depth + 1, RedDepth);
+    SubtreeRoot->Colour = (Depth == RedDepth) ? LazyNode<Type>::NodeColour::Red : LazyNode<Type>::NodeColour::Black;
+    return SubtreeRoot;
+}
+
+template<class Type>
+void LazyRedBlackTree<Type>::InOrderFill(LazyNode<Type>* A, Type* Arr, std::size_t &CurrElement) const
+{
+    if (!A)
+    {
+        return;
+    }
+
+    InOrderFill(A->LChild, Arr, CurrElement);
+    if (!A->Tombstone)
+    {
+        Arr[CurrElement] = A->Key;
+        CurrElement++;
+    }
+    InOrderFill(A->RChild, Arr, CurrElement);
+}
+
+template<class Type>
+int LazyRedBlackTree<Type>::GetHeightIntl(LazyNode<Type>* Curr) const
+{
+    if (!Curr)
+    {
+        return -1;
+    }
+
+    return std::max(GetHeightIntl(Curr->LChild), GetHeightIntl(Curr->RChild)) + 1;
+}
+
+#endif //REDBLACKTREE_LAZYREDBLACKTREE_H
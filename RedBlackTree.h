@@ -3,13 +3,88 @@
 
 #include <iostream>
 #include <memory>
+#include <memory_resource>
 #include <algorithm>
+#include <stdexcept>
+#include <optional>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <string>
+#include <type_traits>
+#include <cstddef>
+
+/**
+ * Default subtree summary for the red black tree; summarizes nothing
+ * A user-defined summary is an associative combination of the keys in a subtree, described by a struct providing:
+ * - Value: the type of the summary
+ * - static Value Identity(): the summary of an empty subtree
+ * - static Value Lift(const Type &Key): the summary of a single key
+ * - static Value Combine(const Value &Left, const Value &Right): the summary of two adjacent runs of keys, in order
+ */
+struct NoSummary
+{
+    typedef void Value;
+};
+
+/**
+ * Storage for the summary of the subtree rooted at a node
+ */
+template<class Summary>
+struct NodeSummary
+{
+    typename Summary::Value SubtreeSummary;
+};
+
+/** Trees without a summary pay no memory for one */
+template<>
+struct NodeSummary<NoSummary>
+{
+};
+
+/**
+ * Recomputes the summary of a node from its own key and the summaries of its children
+ */
+template<class Summary>
+struct SummaryUpdate
+{
+    static constexpr bool IsSummarized = true;
+
+    template<class NodeType>
+    static void Update(NodeType* X)
+    {
+        typename Summary::Value NewSummary = Summary::Lift(X->Key);
+        if (X->LChild)
+        {
+            NewSummary = Summary::Combine(X->LChild->SubtreeSummary, NewSummary);
+        }
+        if (X->RChild)
+        {
+            NewSummary = Summary::Combine(NewSummary, X->RChild->SubtreeSummary);
+        }
+        X->SubtreeSummary = NewSummary;
+    }
+};
+
+template<>
+struct SummaryUpdate<NoSummary>
+{
+    static constexpr bool IsSummarized = false;
+
+    template<class NodeType>
+    static void Update(NodeType*)
+    {
+    }
+};
+
 
 /**
  * Container for a single node containing a key, its colour, its parent, and two siblings.
+ * Also holds the summary of its subtree when the tree it belongs to keeps one
+ * A node does not own its children; the tree frees every node itself, through its allocator
  */
-template<class Type>
-struct Node
+template<class Type, class Summary = NoSummary>
+struct Node : public NodeSummary<Summary>
 {
     enum NodeColour
     {
@@ -21,19 +96,11 @@ struct Node
         Parent = RChild = LChild = nullptr;
     }
 
-    Node(Type NodeKey)
+    Node(Type NodeKey) : Key(NodeKey)
     {
-        Key = NodeKey;
         Parent = RChild = LChild = nullptr;
     }
 
-
-    ~Node()
-    {
-        delete RChild;
-        delete LChild;
-    }
-
     /** Is this node a leaf? */
     bool IsLeaf() const
     {
@@ -41,13 +108,13 @@ struct Node
     }
 
     /** Tests to see if this node is black */
-    static bool TestColourBlack(const Node<Type>* TestNode)
+    static bool TestColourBlack(const Node* TestNode)
     {
         return !TestNode || TestNode->Colour == NodeColour::Black;
     }
 
     /** Tests to see if this node is red */
-    static bool TestColourRed(const Node<Type>* TestNode)
+    static bool TestColourRed(const Node* TestNode)
     {
         return TestNode && TestNode->Colour == NodeColour::Red;
     }
@@ -71,6 +138,149 @@ struct Node
 };  //end Node definition
 
 
+/**
+ * The link-level red black tree algorithms, shared by every tree built from nodes with Parent, LChild, RChild and
+ * Colour members (and the NodeColour, TestColourBlack and TestColourRed helpers of Node)
+ * None of these allocate or look at keys; children are told apart by address
+ * NodeUpdate recomputes any per-node data that depends on a node's subtree, such as SummaryUpdate
+ */
+template<class NodeType, class NodeUpdate = SummaryUpdate<NoSummary>>
+struct RedBlackAlgorithms
+{
+    /**
+     * Performs a left rotation in the tree at node X
+     * Assumes that X has a right child which is not null
+     * @param X Node to perform the left rotation on
+     * @param Root Root of the tree X belongs to; updated if X was the root
+     */
+    static void LeftRotation(NodeType* X, NodeType*& Root);
+
+    /**
+     * Performs a right rotation in the tree at node X
+     * Assumes that X has a left child which is not null
+     * @param X Node to perform the right rotation on
+     * @param Root Root of the tree X belongs to; updated if X was the root
+     */
+    static void RightRotation(NodeType* X, NodeType*& Root);
+
+    /**
+     * Fixes the tree after an insertion so that the red-black properties are obeyed
+     * @param X Node that was inserted; assumed to be coloured red
+     * @param Root Root of the tree X belongs to
+     */
+    static void FixInsertion(NodeType* X, NodeType*& Root);
+
+    /**
+     * Unlinks a node from the tree and rebalances it
+     * A node with two children is replaced by relinking its successor into its place, so no other node moves in memory
+     * @param Z Node to remove; its links are cleared once it is out of the tree
+     * @param Root Root of the tree Z belongs to
+     */
+    static void Erase(NodeType* Z, NodeType*& Root);
+
+    /**
+     * Fixes the tree after a black node was removed so that the red-black properties are obeyed
+     * @param X Node that took the removed node's place; may be null
+     * @param XParent Parent of X; needed since X may be null
+     * @param Root Root of the tree
+     */
+    static void FixDeletion(NodeType* X, NodeType* XParent, NodeType*& Root);
+
+    /**
+     * Replaces the subtree rooted at OldChild with the one rooted at NewChild in OldChild's parent
+     * @param OldChild Node being replaced
+     * @param NewChild Node taking its place; may be null
+     * @param Root Root of the tree; updated if OldChild was the root
+     */
+    static void Transplant(NodeType* OldChild, NodeType* NewChild, NodeType*& Root);
+
+    /**
+     * Runs NodeUpdate on every node from the node passed as parameter up to the root
+     * @param StartNode The lowest node whose data may be out of date; may be null
+     */
+    static void UpdatePath(NodeType* StartNode);
+
+};  //end RedBlackAlgorithms definition
+
+
+/**
+ * Reports how much heap memory a key owns outside of its own bytes, for the memory accounting of the trees
+ * The default reports none, which is right for every type that does not point to further allocations; specialize
+ * it for key types that do
+ */
+template<class Type>
+struct KeyMemoryTraits
+{
+    static std::size_t HeapBytes(const Type &)
+    {
+        return 0;
+    }
+};
+
+/**
+ * Strings own a heap buffer once they outgrow the buffer kept inside the string object
+ */
+template<class CharType, class CharTraits, class Allocator>
+struct KeyMemoryTraits<std::basic_string<CharType, CharTraits, Allocator>>
+{
+    static std::size_t HeapBytes(const std::basic_string<CharType, CharTraits, Allocator> &Key)
+    {
+        const char* Data = (const char*) Key.data();
+        const char* Object = (const char*) &Key;
+        bool Inline = Data >= Object && Data < Object + sizeof(Key);
+        return Inline ? 0 : (Key.capacity() + 1) * sizeof(CharType);
+    }
+};
+
+/**
+ * Vectors own their element buffer, and whatever the elements own in turn
+ */
+template<class ElementType, class Allocator>
+struct KeyMemoryTraits<std::vector<ElementType, Allocator>>
+{
+    static std::size_t HeapBytes(const std::vector<ElementType, Allocator> &Key)
+    {
+        std::size_t Bytes = Key.capacity() * sizeof(ElementType);
+        for (const ElementType &Element : Key)
+        {
+            Bytes += KeyMemoryTraits<ElementType>::HeapBytes(Element);
+        }
+        return Bytes;
+    }
+};
+
+/**
+ * Breakdown of the heap memory held by a tree
+ */
+struct TreeMemoryUsage
+{
+    /** The number of nodes, one per key */
+    std::size_t Nodes;
+
+    /** Nodes times the size of a node */
+    std::size_t NodeBytes;
+
+    /** Headers and rounding the allocator adds to every node allocation */
+    std::size_t AllocatorOverheadBytes;
+
+    /** Heap memory owned by the keys themselves, as reported by KeyMemoryTraits */
+    std::size_t KeyHeapBytes;
+
+    /**
+     * Node allocations the tree has freed and not allocated again since; allocators rarely hand such memory back
+     * to the system, so it usually still counts towards the process, as holes between the live nodes. Nodes moved
+     * out to another tree or a node handle are still allocated and are not counted here
+     */
+    std::size_t FreedNodeBytes;
+
+    /** The memory the tree holds right now: nodes, allocator overhead and key memory */
+    std::size_t TotalBytes() const
+    {
+        return NodeBytes + AllocatorOverheadBytes + KeyHeapBytes;
+    }
+};
+
+
 /**
  * The Red Black Tree data structure
  * Obeys the following five properties:
@@ -80,30 +290,162 @@ struct Node
  * 4. If a node is red, then both of its children are black
  * 5. For all nodes, the number of black nodes to a leaf node is the same
  *
+ * Nodes are allocated through Allocator, rebound to the node type; any standard allocator whose pointers are plain
+ * pointers works, including std::pmr::polymorphic_allocator, so a short-lived tree can take its nodes from a
+ * monotonic buffer and a long-lived one from a pool
+ * Trees only hand nodes to each other (Concatenate, SplitOffAbove, SplitOffBelow) when their allocators compare
+ * equal, since the receiving tree ends up freeing the nodes
+ *
  * Assumes that any templated type has valid comparison operators for find, insert, and delete to work
  */
-template<class Type>
+template<class Type, class Summary = NoSummary, class Allocator = std::allocator<Type>>
 class RedBlackTree
 {
+    typedef typename std::allocator_traits<Allocator>::template rebind_alloc<Node<Type, Summary>> NodeAllocatorType;
+    typedef std::allocator_traits<NodeAllocatorType> NodeAllocatorTraits;
+
 public:
+    /**
+     * Owns a node taken out of a tree by Extract, key and all, until it is inserted into a tree again
+     * Moving a node between trees this way neither frees nor allocates it, and never copies its key
+     * A handle still holding its node when destroyed frees the node through the allocator it came from
+     */
+    class NodeHandle
+    {
+    public:
+        NodeHandle();
+        ~NodeHandle();
+
+        NodeHandle(NodeHandle &&Other) noexcept;
+        NodeHandle &operator=(NodeHandle &&Other) noexcept;
+
+        NodeHandle(const NodeHandle &) = delete;
+        NodeHandle &operator=(const NodeHandle &) = delete;
+
+        /** Does the handle hold no node? */
+        bool Empty() const;
+
+        explicit operator bool() const;
+
+        /**
+         * The key of the held node; may be changed while the node is out of any tree
+         * Assumes that the handle is not empty
+         */
+        Type &Key() const;
+
+    private:
+        friend class RedBlackTree;
+
+        NodeHandle(Node<Type, Summary>* HeldNode, const NodeAllocatorType &HandleAllocator);
+
+        /** Frees the held node, if there is one, and empties the handle */
+        void Release();
+
+        Node<Type, Summary>* HeldNode;
+
+        /** The allocator the held node came from; only set while a node is held */
+        std::optional<NodeAllocatorType> HandleAllocator;
+    };
+
     RedBlackTree();
 
-    RedBlackTree(Type RootKey);
+    /**
+     * @param NodeAllocator The allocator to take nodes from; rebound to the node type
+     */
+    explicit RedBlackTree(const Allocator &NodeAllocator);
+
+    RedBlackTree(Type RootKey, const Allocator &NodeAllocator = Allocator());
 
     ~RedBlackTree();
 
     /**
      * Inserts the given key into the tree, if it is not already in the tree
      * @param NewKey The new key to insert into the tree
+     * @throws std::length_error if storing the key would take the tree past its memory budget; the tree is unchanged
      */
     void Insert(const Type NewKey);
 
+    /**
+     * Links the node held by a handle into the tree, without allocating a node or copying its key
+     * @param Handle The handle whose node to insert; left empty only if the node was inserted
+     * @return true if the node was inserted, false if the handle was empty or its key is already in the tree, in
+     *         which case the handle keeps its node
+     * @throws std::invalid_argument if the node came from an allocator that does not compare equal to this tree's
+     * @throws std::length_error if the node would take the tree past its memory budget; the handle keeps its node
+     */
+    bool Insert(NodeHandle &&Handle);
+
+    /**
+     * Unlinks the node holding the given key and hands it over, without freeing it
+     * @param KeyToExtract The key to take out of the tree
+     * @return A handle holding the node, or an empty handle if the key is not in the tree
+     */
+    NodeHandle Extract(const Type KeyToExtract);
+
+    /**
+     * Moves every key of another tree that is not already in this one over, relinking the nodes rather than
+     * copying them, so that no node is allocated or freed and no key is copied
+     * Runs in O(log n) when the key ranges of the two trees do not overlap, and O(k log n) otherwise, where k is
+     * the size of Other; keys found in both trees stay in Other. Like Concatenate, ignores the memory budget
+     * @param Other The tree to take the keys from
+     * @return The number of keys moved
+     * @throws std::invalid_argument if the two trees' allocators do not compare equal
+     */
+    std::size_t Merge(RedBlackTree &Other);
+
     /**
      * Removes the given key from the tree, if it exists in the tree
+     * Only the node holding the key is freed; every other node keeps both its address and its key
      * @param KeyToDelete The key to delete from the tree
      */
     void Delete(const Type KeyToDelete);
 
+    /**
+     * Removes every key in the closed range [Low, High] from the tree
+     * The range is split off the tree as a whole, the remaining halves are joined back together and the
+     * detached nodes are freed in one pass, so the cost is O(log^2 n + k) rather than k separate deletions
+     * @param Low Smallest key to remove
+     * @param High Largest key to remove
+     * @return The number of keys removed
+     */
+    std::size_t EraseRange(const Type Low, const Type High);
+
+    /**
+     * Replaces the contents of the tree with keys given in strictly ascending order, in O(n)
+     * The nodes are linked straight into a perfectly balanced tree rather than inserted one at a time, so no key is
+     * compared and no rotation is made
+     * @param Keys The new keys, in strictly ascending order
+     * @param Count How many keys there are
+     * @throws std::length_error if the new keys would not fit in the tree's memory budget; the tree is unchanged
+     */
+    void AssignSorted(const Type* Keys, std::size_t Count);
+
+    /**
+     * Moves every key not smaller than SplitKey into another tree, relinking the nodes rather than copying them
+     * Runs in O(log^2 n + k), where k is the number of keys moved
+     * @param SplitKey Smallest key to move
+     * @param Upper Tree receiving the keys; assumed to be empty
+     * @throws std::invalid_argument if the two trees' allocators do not compare equal
+     */
+    void SplitOffAbove(const Type SplitKey, RedBlackTree &Upper);
+
+    /**
+     * Moves every key smaller than SplitKey into another tree, relinking the nodes rather than copying them
+     * Runs in O(log^2 n + k), where k is the number of keys moved
+     * @param SplitKey Smallest key to keep
+     * @param Lower Tree receiving the keys; assumed to be empty
+     * @throws std::invalid_argument if the two trees' allocators do not compare equal
+     */
+    void SplitOffBelow(const Type SplitKey, RedBlackTree &Lower);
+
+    /**
+     * Moves every key of another tree into this one in O(log n), relinking the nodes rather than copying them
+     * Assumes that the keys of Other are either all smaller or all larger than every key in this tree
+     * @param Other The tree to take the keys from; left empty
+     * @throws std::invalid_argument if the two trees' allocators do not compare equal
+     */
+    void Concatenate(RedBlackTree &Other);
+
     /**
      * Finds the key passed as parameter in the tree, if it exists
      * @param KeyToFind The key to search for in the tree
@@ -112,25 +454,153 @@ public:
     bool Find(const Type KeyToFind) const;
 
     /**
-     * Finds the smallest key in the tree
+     * Finds the smallest key in the tree in O(1), from the cached leftmost node
      * @return The smallest key in the tree
+     * @throws std::out_of_range if the tree is empty
      */
     Type FindMin() const;
 
     /**
-     * Finds the largest key in the tree
+     * Finds the largest key in the tree in O(1), from the cached rightmost node
      * @return The largest key in the tree
+     * @throws std::out_of_range if the tree is empty
      */
     Type FindMax() const;
 
+    /**
+     * Removes and returns the smallest key in the tree, so that the tree can serve as a priority queue
+     * The node is reached through the cached leftmost node, so no search is needed, and the rebalancing is
+     * amortized O(1); trees keeping a summary still pay O(log n) to refresh the summaries up to the root
+     * @return The smallest key in the tree
+     * @throws std::out_of_range if the tree is empty
+     */
+    Type PopMin();
+
+    /**
+     * Removes and returns the largest key in the tree, in the same time as PopMin
+     * @return The largest key in the tree
+     * @throws std::out_of_range if the tree is empty
+     */
+    Type PopMax();
+
+    /**
+     * Finds the largest key in the tree that is not larger than the key passed as parameter, in O(log n)
+     * @param Key The key to snap down
+     * @return The matching key, or nothing if every key in the tree is larger
+     */
+    std::optional<Type> Floor(const Type Key) const;
+
+    /**
+     * Finds the smallest key in the tree that is not smaller than the key passed as parameter, in O(log n)
+     * @param Key The key to snap up
+     * @return The matching key, or nothing if every key in the tree is smaller
+     */
+    std::optional<Type> Ceiling(const Type Key) const;
+
+    /**
+     * Finds the largest key in the tree that is strictly smaller than the key passed as parameter, in O(log n)
+     * The key itself need not be in the tree
+     * @param Key The key to look below
+     * @return The matching key, or nothing if no key in the tree is smaller
+     */
+    std::optional<Type> Predecessor(const Type Key) const;
+
+    /**
+     * Finds the smallest key in the tree that is strictly larger than the key passed as parameter, in O(log n)
+     * The key itself need not be in the tree
+     * @param Key The key to look above
+     * @return The matching key, or nothing if no key in the tree is larger
+     */
+    std::optional<Type> Successor(const Type Key) const;
+
+    /**
+     * Finds the K keys in the tree closest to the key passed as parameter, in O(log n + K)
+     * Walks outwards in both directions from where the key lands, taking whichever neighbour is closer each step;
+     * ties go to the smaller key
+     * Distances between integer keys are taken in the unsigned type of the same size, so they never overflow; other
+     * key types are assumed to give a comparable distance when a smaller key is subtracted from a larger one
+     * @param Key The key to look around
+     * @param K How many keys to return at most
+     * @return The closest keys, closest first
+     */
+    std::vector<Type> KNearest(const Type Key, std::size_t K) const;
+
+    /**
+     * Finds the key at a given position in sorted order, walking to it from the nearer end of the tree
+     * The tree keeps no subtree sizes, so this takes O(min(Position, n - Position)) steps, but copies nothing
+     * @param Position Index of the key in sorted order, counting from 0 for the smallest key
+     * @return The key at that position
+     * @throws std::out_of_range if Position is not less than the size of the tree
+     */
+    Type KeyAt(std::size_t Position) const;
+
     /***
      * Makes and returns a sorted array of all elements in the tree
+     * The caller owns the array; ExportTo and ExportChunks avoid the separate allocation
      * @return A pointer to the first element of the newly created array
      */
     Type* MakeArray() const;
 
+    /**
+     * Copies the smallest keys of the tree, in sorted order, into a buffer provided by the caller
+     * @param Buffer Where to write the keys
+     * @param Capacity How many keys the buffer can hold
+     * @return The number of keys written; less than the size of the tree if the buffer is too small
+     */
+    std::size_t ExportTo(Type* Buffer, std::size_t Capacity) const;
+
+    /**
+     * Streams every key of the tree, in sorted order, to a callback in chunks of a fixed size
+     * Only one chunk is held in memory at a time, so dumping a large tree does not need a second copy of it
+     * @param ChunkSize The most keys handed over per call; only the last chunk may be smaller
+     * @param OnChunk Called as OnChunk(const Type* Keys, std::size_t Count) for each chunk, in order
+     * @throws std::invalid_argument if ChunkSize is 0
+     */
+    template<class ChunkFunction>
+    void ExportChunks(std::size_t ChunkSize, ChunkFunction OnChunk) const;
+
+    /**
+     * Copies every key of the tree, in sorted order, into a buffer provided by the caller using several threads
+     * The top few levels of the tree cut it into disjoint subtrees; their sizes are counted in parallel, which
+     * gives each subtree its own range of the output, and the subtrees are then filled in parallel
+     * Assumes that nothing modifies the tree during the export
+     * @param Buffer Where to write the keys; assumed to hold at least GetSize() keys
+     * @param NumThreads How many threads to use; 0 uses one per hardware thread
+     */
+    void ParallelExportTo(Type* Buffer, unsigned NumThreads = 0) const;
+
+    /**
+     * Combines the summaries of every key in the closed range [Low, High], in sorted order
+     * Only available when the tree keeps a summary; runs in O(log n) by reusing the stored subtree summaries
+     * @param Low Smallest key to include
+     * @param High Largest key to include
+     * @return The combined summary, or the summary identity if no key lies in the range
+     */
+    typename Summary::Value Aggregate(const Type Low, const Type High) const;
+
     /** Getter function to retrieve size of the tree */
-    int GetSize() const;
+    std::size_t GetSize() const;
+
+    /** Getter function to retrieve the allocator the nodes come from */
+    Allocator GetAllocator() const;
+
+    /**
+     * Reports the heap memory the tree holds, in O(1); key memory is tracked as keys come and go
+     * Allocator overhead follows the chunk layout of glibc's malloc, which other general purpose allocators round
+     * similarly to; arena and pool allocators usually add less
+     */
+    TreeMemoryUsage GetMemoryUsage() const;
+
+    /**
+     * Caps the memory the tree may hold, as counted by GetMemoryUsage().TotalBytes()
+     * Only Insert and AssignSorted check the budget; moving nodes in from another tree does not allocate and is not
+     * checked. A budget below what the tree already holds only stops it from growing further
+     * @param Bytes The most bytes the tree may hold, or 0 for no budget
+     */
+    void SetMemoryBudget(std::size_t Bytes);
+
+    /** Getter function to retrieve the memory budget, or 0 if there is none */
+    std::size_t GetMemoryBudget() const;
 
     int GetHeight() const;
     int GetBlackHeight() const;
@@ -138,63 +608,163 @@ public:
     void InOrder() const;
     void PreOrder() const;
 
-private:
+protected:
+    /** Root node in the tree */
+    Node<Type, Summary>* Root;
+
+    /** The current number of nodes stored in the tree */
+    std::size_t Size;
+
+    /**
+     * Changes whenever nodes leave the tree, whether they are freed or moved into another tree or a node handle
+     * Classes that keep pointers to nodes compare it with the value they last saw to tell when those pointers may
+     * have gone stale, which also covers changes made through a RedBlackTree reference
+     */
+    std::size_t RemovalEpoch;
+
     /**
      * Returns a pointer to the node with a key matching the key passed as parameter
      * If no node in the tree has a matching key, then the parent of where the key should be is returned
      * @param KeyToFind The key to search for
      * @return The node matching the key, or the parent of the node where the key should go
      */
-    Node<Type>* FindIntl(const Type KeyToFind) const;
+    Node<Type, Summary>* FindIntl(const Type KeyToFind) const;
+
+private:
+    typedef RedBlackAlgorithms<Node<Type, Summary>, SummaryUpdate<Summary>> Algorithms;
+
+    /** Where every node of the tree comes from and goes back to */
+    NodeAllocatorType NodeAllocator;
 
     /**
-     * Fixes the tree after an insertion so that the red-black properties are obeyed
-     * @param X Node that was inserted
+     * Allocates and constructs an unlinked node through the node allocator
+     * @param NewKey The key of the node
      */
-    void TreeFixInsertion(Node<Type>* X);
+    Node<Type, Summary>* CreateNode(const Type &NewKey);
 
     /**
-     * Fixes tree after deletion so that the red-black properties are obeyed
-     * @param X Node that replaced the deleted node
-     * @param Y Parent of X; needed only in the case when X is null
-     * @param DeletedKey Key that was removed from tree; used to initialize X, should X be null
+     * Destroys a node and hands its memory back to the node allocator; the node's children are left alone
+     * @param OldNode The node to free; assumed to be unlinked from the tree
      */
-    void TreeFixDeletion(Node<Type>* X, Node<Type>* Y, Type DeletedKey);
+    void DestroyNode(Node<Type, Summary>* OldNode);
 
     /**
-     * Performs a left rotation in the tree at node X
-     * Assumes that X has a right child which is not null
-     * @param X Node to perform the left rotation on
+     * Throws std::invalid_argument unless another tree frees nodes through an allocator equal to this tree's, so
+     * that nodes can move between the two
      */
-    void LeftRotation(Node<Type>* X);
+    void CheckSameAllocator(const RedBlackTree &Other) const;
+
+    /** Nodes holding the smallest and the largest key, or nullptr while the tree is empty */
+    Node<Type, Summary>* Leftmost;
+    Node<Type, Summary>* Rightmost;
+
+    /** Heap memory owned by the keys in the tree, kept up to date as nodes are allocated, freed and moved */
+    std::size_t KeyHeapBytes;
+
+    /** Node allocations freed and not yet reused by a later allocation, and the memory budget, or 0 for none */
+    std::size_t FreedNodes;
+    std::size_t MemoryBudget;
 
     /**
-     * Performs a right rotation in the tree at node X
-     * Assumes that X has a left child which is not null
-     * @param X Node to perform the right rotation on
+     * Returns how many bytes the allocator really sets aside for a request of the given size: the request plus a
+     * size header, rounded up to twice the pointer size, and never less than four words
+     */
+    static std::size_t AllocationBytes(std::size_t Requested);
+
+    /**
+     * Allocates a node for a new key and checks it against the memory budget
+     * The node is measured before it is linked in, so that the budget sees the key the node really holds rather
+     * than the caller's copy, which may own more or less memory
+     * @param NewKey The key of the node
+     * @return The new node, not yet linked into the tree
+     * @throws std::length_error if the node would take the tree past its memory budget; the node is freed again
+     */
+    Node<Type, Summary>* AllocateNode(const Type &NewKey);
+
+    /**
+     * Links an unlinked node in below the given parent, counts it and its key memory, and rebalances the tree
+     * @param NewNode The node to link in; its key must not be in the tree yet
+     * @param Par The node FindIntl returned for the new key, or nullptr if the tree is empty
+     */
+    void LinkNode(Node<Type, Summary>* NewNode, Node<Type, Summary>* Par);
+
+    /**
+     * Unlinks a node from the tree without freeing it, moving the cached leftmost and rightmost nodes on if needed
+     * @param NodeToDelete Node to remove; assumed to be in this tree
+     */
+    void UnlinkNode(Node<Type, Summary>* NodeToDelete);
+
+    /**
+     * Unlinks a node from the tree and frees it
+     * @param NodeToDelete Node to remove; assumed to be in this tree
+     */
+    void EraseNode(Node<Type, Summary>* NodeToDelete);
+
+    /** Finds the leftmost and rightmost nodes again, after the tree was restructured wholesale */
+    void ResetExtremes();
+
+    /**
+     * Allocates and links a run of sorted keys into a perfectly balanced subtree
+     * Nodes at RedDepth are coloured red and every other node black; with RedDepth set to the deepest level when
+     * that level is only partly filled, every path down to a leaf passes the same number of black nodes
+     * @param Keys The sorted keys
+     * @param Count How many keys the subtree holds
+     * @param Depth Depth of the subtree's root
+     * @param RedDepth Depth at which nodes are coloured red, or -1 for none
+     * @return The root of the subtree
+     */
+    Node<Type, Summary>* BuildBalanced(const Type* Keys, std::size_t Count, int Depth, int RedDepth);
+
+    /**
+     * Finds the node with the largest key below the key passed as parameter
+     * @param Key The key to look below
+     * @param Inclusive Does a node holding the key itself count?
+     * @return The matching node, or nullptr if there is none
+     */
+    Node<Type, Summary>* FloorIntl(const Type &Key, bool Inclusive) const;
+
+    /**
+     * Finds the node with the smallest key above the key passed as parameter
+     * @param Key The key to look above
+     * @param Inclusive Does a node holding the key itself count?
+     * @return The matching node, or nullptr if there is none
      */
-    void RightRotation(Node<Type>* X);
+    Node<Type, Summary>* CeilingIntl(const Type &Key, bool Inclusive) const;
+
+    /**
+     * Tells whether a key above the key passed as parameter is strictly closer to it than a key below it
+     * @param Key The key distances are measured from
+     * @param Lower A key no larger than Key
+     * @param Upper A key no smaller than Key
+     * @return true if Upper is closer, false if Lower is closer or both are as close
+     */
+    static bool UpperIsCloser(const Type &Key, const Type &Lower, const Type &Upper);
+
+    /** Returns the node holding the next larger key, or nullptr if the node passed as parameter holds the largest */
+    static Node<Type, Summary>* NextNode(Node<Type, Summary>* CurrNode);
+
+    /** Returns the node holding the next smaller key, or nullptr if the node passed as parameter holds the smallest */
+    static Node<Type, Summary>* PrevNode(Node<Type, Summary>* CurrNode);
 
     /**
-     * Helper function to delete a leaf node from the tree
-     * Assumes that the node is a leaf (does not internal checks to see if this assumption is true)
-     * @param NodeToDelete Pointer to the node that is to be deleted
+     * Fixes the tree after an insertion so that the red-black properties are obeyed
+     * @param X Node that was inserted
      */
-    void DeleteLeaf(Node<Type>* NodeToDelete);
+    void TreeFixInsertion(Node<Type, Summary>* X);
 
     /**
-     * Helper function to delete a node with one child from the tree
-     * Assumes that the node has at most one child (does no internal checks to see if this assumption is true)
-     * @param NodeToDelete Pointer to the node that is to be deleted
+     * Performs a left rotation in the tree at node X
+     * Assumes that X has a right child which is not null
+     * @param X Node to perform the left rotation on
      */
-    void DeleteNodeOneChild(Node<Type>* NodeToDelete);
+    void LeftRotation(Node<Type, Summary>* X);
 
     /**
-     * Replaces a child node with that of its parent
-     * @param ParentNode Parent node of child
-     * @param ChildNode Child node of parent
+     * Performs a right rotation in the tree at node X
+     * Assumes that X has a left child which is not null
+     * @param X Node to perform the right rotation on
      */
-    void ReplaceNode(Node<Type>* ParentNode, Node<Type>* ChildNode);
+    void RightRotation(Node<Type, Summary>* X);
 
     /**
      * Finds the min key of a tree starting at the node passed as parameter
@@ -202,7 +772,7 @@ private:
      * @param StartNode The node to start the min key search at
      * @return The node with the minimum key
      */
-    Node<Type>* FindMinIntl(Node<Type>* StartNode) const;
+    Node<Type, Summary>* FindMinIntl(Node<Type, Summary>* StartNode) const;
 
     /**
      * Finds the max key of a tree starting at the node passed as parameterAssumes that StartNode is not null, otherwise nullptr will be returned
@@ -210,721 +780,1858 @@ private:
      * @param StartNode The node to start the max key search at
      * @return The node with the maximum key
      */
-    Node<Type>* FindMaxIntl(Node<Type>* StartNode) const;
+    Node<Type, Summary>* FindMaxIntl(Node<Type, Summary>* StartNode) const;
 
-    int GetHeightIntl(Node<Type>* Curr) const;
-    int GetBlackHeightIntl(Node<Type>* Curr) const;
+    int GetHeightIntl(Node<Type, Summary>* Curr) const;
+    int GetBlackHeightIntl(Node<Type, Summary>* Curr) const;
 
     /**
-     * Performs an in order traversal of the tree, filling an array with each element as needed
-     * @param A Current node for recursive fill
-     * @param Arr Array containing the sorted keys; is assumed to be of size at least equal to the tree size
-     * @param CurrElement Counter for which position we are currently filling in the array
+     * Copies the keys of a subtree into an array in sorted order, walking the parent links instead of recursing
+     * @param A Root of the subtree; may be null
+     * @param Arr Array to fill; is assumed to be of size at least equal to the subtree size
+     * @return The number of keys written
      */
-    void InOrderFill(Node<Type>* A, Type* Arr, int &CurrElement) const;
+    std::size_t FillSubtree(Node<Type, Summary>* A, Type* Arr) const;
+
+    /** One piece of a parallel export: either a whole subtree, or a single node above the subtrees */
+    struct ExportTask
+    {
+        Node<Type, Summary>* Start;
+        bool WholeSubtree;
+        std::size_t Offset;
+        std::size_t Count;
+    };
 
     /**
-     * Performs an in order traversal of the current node
-     * @param a Current node to perform an in order traversal on
+     * Lists, in sorted order, the nodes of the top levels of a subtree and the subtrees hanging below them
+     * @param A Root of the subtree; may be null
+     * @param Depth How many levels of single nodes to list before listing whole subtrees
+     * @param Tasks Filled with the pieces
      */
-    void InOrderItl(Node<Type>* a) const;
+    void CollectExportTasks(Node<Type, Summary>* A, int Depth, std::vector<ExportTask> &Tasks) const;
 
     /**
-     * Performs a pre order traversal of the current node
-     * @param a Current node to perform a pre order traversal on
+     * Runs Work(i) for every i in [0, Count) on several threads, which take the next i as they finish the last
+     * @param Count How many pieces of work there are
+     * @param NumThreads How many threads to use, including the calling one
+     * @param Work The work to run
      */
-    void PreOrderItl(Node<Type>* a) const;
-
-    /** Root node in the tree */
-    Node<Type>* Root;
-
-    /** The current number of nodes stored in the tree */
-    int Size;
+    template<class WorkFunction>
+    static void ForEachParallel(std::size_t Count, unsigned NumThreads, WorkFunction Work);
 
+    /**
+     * Performs an in order traversal of the current node
+     * @param a Current node to perform an in order traversal on
+     */
+    void InOrderItl(Node<Type, Summary>* a) const;
 
-};  //end RedBlackTree definition
+    /**
+     * Performs a pre order traversal of the current node
+     * @param a Current node to perform a pre order traversal on
+     */
+    void PreOrderItl(Node<Type, Summary>* a) const;
 
+    /**
+     * Recomputes the subtree summary of every node from the node passed as parameter up to the root
+     * Does nothing if the tree does not keep a summary
+     * @param StartNode The lowest node whose summary may be out of date
+     */
+    void UpdatePath(Node<Type, Summary>* StartNode);
 
+    /**
+     * Returns the summary of the subtree rooted at the node passed as parameter
+     * @param SubtreeRoot Root of the subtree; may be null, in which case the identity is returned
+     */
+    typename Summary::Value SummaryOf(Node<Type, Summary>* SubtreeRoot) const;
 
-template<class Type>
-RedBlackTree<Type>::RedBlackTree()
-{
-    Root = nullptr;
-    Size = 0;
-}
+    /**
+     * Counts the black nodes on the path from the node passed as parameter down to a leaf
+     * @param SubtreeRoot Root of the subtree; a null subtree has a black height of 0
+     */
+    int SubtreeBlackHeight(Node<Type, Summary>* SubtreeRoot) const;
 
-template<class Type>
-RedBlackTree<Type>::RedBlackTree(Type RootKey)
-{
-    Root = new Node<Type>(RootKey);
-    Root->Colour = Node<Type>::NodeColour::Black;
+    /**
+     * Joins two detached red black trees around a pivot node
+     * Assumes every key in Left is smaller than the pivot key, which is smaller than every key in Right
+     * Uses Root as scratch space while rebalancing; Root is left pointing at the joined tree
+     * @param Left Root of the tree holding the smaller keys; may be null
+     * @param Pivot Detached node whose key separates the two trees
+     * @param Right Root of the tree holding the larger keys; may be null
+     * @return The root of the joined tree
+     */
+    Node<Type, Summary>* Join(Node<Type, Summary>* Left, Node<Type, Summary>* Pivot, Node<Type, Summary>* Right);
 
-    Size = 1;
-}
+    /**
+     * Splits a detached red black tree into two red black trees around a key
+     * @param A Root of the tree to split; may be null
+     * @param SplitKey Key to split the tree around
+     * @param KeepEqualLeft Should a key equal to SplitKey end up in the left tree rather than the right one?
+     * @param Left Set to the root of the tree holding the keys before the split point
+     * @param Right Set to the root of the tree holding the keys after the split point
+     */
+    void Split(Node<Type, Summary>* A, const Type SplitKey, bool KeepEqualLeft,
+               Node<Type, Summary>*& Left, Node<Type, Summary>*& Right);
 
-template<class Type>
-RedBlackTree<Type>::~RedBlackTree()
-{
-    delete Root;
-}
+    /**
+     * Frees every node in the subtree rooted at the node passed as parameter
+     * @param A Root of the subtree to free; may be null
+     * @return The number of nodes freed
+     */
+    std::size_t DeleteSubtree(Node<Type, Summary>* A);
 
+    /**
+     * Counts the nodes in the subtree rooted at the node passed as parameter
+     * @param A Root of the subtree; may be null
+     */
+    std::size_t CountSubtree(Node<Type, Summary>* A) const;
 
-template<class Type>
-void RedBlackTree<Type>::Insert(const Type NewKey)
-{
-    //if the root node is null, then insert the key into the root and colour it black
-    if (!Root)
-    {
-        Root = new Node<Type>(NewKey);
-        Root->Colour = Node<Type>::NodeColour::Black;
-        Size++;
-        return;
-    }
+    /**
+     * Adds up the heap memory owned by the keys in the subtree rooted at the node passed as parameter
+     * @param A Root of the subtree; may be null
+     */
+    std::size_t SubtreeKeyHeapBytes(Node<Type, Summary>* A) const;
 
-    Node<Type>* Par = FindIntl(NewKey);
+    /**
+     * Splits this tree around a key, and hands the keys on one side of it to another tree
+     * @param SplitKey Smallest key of the upper part
+     * @param Receiver Tree receiving the moved keys; assumed to be empty
+     * @param MoveUpper Should the keys not smaller than SplitKey move, rather than the keys smaller than it?
+     */
+    void SplitOffIntl(const Type SplitKey, RedBlackTree &Receiver, bool MoveUpper);
 
-    //If find returns a node that does not match the new key, then we need to insert that key
-    if (Par->Key != NewKey)
-    {
-        Node<Type>* InsertedNode;
-        if (NewKey < Par->Key)
-        {
-            Par->LChild = new Node<Type>(NewKey);
-            InsertedNode = Par->LChild;
-        }
-        else
-        {
-            Par->RChild = new Node<Type>(NewKey);
-            InsertedNode = Par->RChild;
-        }
 
-        InsertedNode->Colour = Node<Type>::NodeColour::Red;
-        InsertedNode->Parent = Par;
-        InsertedNode->RChild = nullptr;
-        InsertedNode->LChild = nullptr;
-        Size++;
+};  //end RedBlackTree definition
 
-        TreeFixInsertion(InsertedNode);
-    }
 
-    Par = nullptr;
-}
 
-template<class Type>
-void RedBlackTree<Type>::Delete(const Type KeyToDelete)
+template<class NodeType, class NodeUpdate>
+void RedBlackAlgorithms<NodeType, NodeUpdate>::LeftRotation(NodeType* X, NodeType*& Root)
 {
-    if (Size == 0)
-    {
-        return;
-    }
-
-    Node<Type>* NodeToDelete = FindIntl(KeyToDelete);
+    NodeType* Y = X->RChild;
 
-    //if the key doesn't exist in our tree, then just return
-    if (NodeToDelete->Key != KeyToDelete)
+//move Y's left child to the right child of X and modify the child's parent if necessary
+    X->RChild = Y->LChild;
+    if (Y->LChild != nullptr)
     {
-        NodeToDelete = nullptr;
-        return;
+        X->RChild->Parent = X;
     }
 
-    typename Node<Type>::NodeColour OriginalColour = NodeToDelete->Colour;
-
-    Node<Type>* ReplacementNode = nullptr;
-    Node<Type>* ReplacementNodeParent = nullptr;
-
-    //special case: if the root is the only node left, then just delete the root
-    if (Size == 1)
-    {
-        delete Root;
-        Root = nullptr;
-        OriginalColour = Node<Type>::NodeColour::Red;
-    }
-        //case 1: the node to delete is a leaf
-    else if (NodeToDelete->IsLeaf())
+    NodeType* Par = X->Parent;
+    Y->Parent = Par;
+    if (!Par)
     {
-        ReplacementNodeParent = NodeToDelete->Parent;
-        DeleteLeaf(NodeToDelete);
+        Root = Y;
     }
-        //case 2: the node to delete has one child
-    else if (!NodeToDelete->LChild || !NodeToDelete->RChild)
+    else if (Par->LChild == X)
     {
-        if (NodeToDelete->LChild)
-        {
-            ReplacementNode = NodeToDelete->LChild;
-        }
-        else
-        {
-            ReplacementNode = NodeToDelete->RChild;
-        }
-
-        ReplacementNodeParent = NodeToDelete->Parent;
-        DeleteNodeOneChild(NodeToDelete);
+        Par->LChild = Y;
     }
-        //case 3: the node to delete is an internal node with two children
     else
     {
-        Node<Type>* MinNode = FindMinIntl(NodeToDelete->RChild);
-        OriginalColour = MinNode->Colour;
-
-        NodeToDelete->Key = MinNode->Key;
-
-        if (MinNode->IsLeaf())
-        {
-            ReplacementNodeParent = MinNode->Parent;
-            DeleteLeaf(MinNode);
-        }
-        else
-        {
-            if (MinNode->LChild)
-            {
-                ReplacementNode = MinNode->LChild;
-            }
-            else
-            {
-                ReplacementNode = MinNode->RChild;
-            }
-
-            ReplacementNodeParent = MinNode->Parent;
-            DeleteNodeOneChild(MinNode);
-        }
+        Par->RChild = Y;
     }
 
-    Size--;
-
-    if (OriginalColour == Node<Type>::NodeColour::Black && Size != 0)
-    {
-        TreeFixDeletion(ReplacementNode, ReplacementNodeParent, KeyToDelete);
-    }
+    Y->LChild = X;
+    X->Parent = Y;
 
-    NodeToDelete = nullptr;
-    ReplacementNode = nullptr;
-    ReplacementNodeParent = nullptr;
+//X is now below Y, so it has to be updated first
+    NodeUpdate::Update(X);
+    NodeUpdate::Update(Y);
 }
 
-template<class Type>
-bool RedBlackTree<Type>::Find(const Type KeyToFind) const
+template<class NodeType, class NodeUpdate>
+void RedBlackAlgorithms<NodeType, NodeUpdate>::RightRotation(NodeType* X, NodeType*& Root)
 {
-    if (Size == 0)
+    NodeType* Y = X->LChild;
+
+    X->LChild = Y->RChild;
+    if (Y->RChild != nullptr)
     {
-        return false;
+        Y->RChild->Parent = X;
     }
 
-    Node<Type>* FoundNode = FindIntl(KeyToFind);
-    Type NodeKey = FoundNode->Key;
-    FoundNode = nullptr;
-    return NodeKey == KeyToFind;
-}
-
-template<class Type>
-Type RedBlackTree<Type>::FindMin() const
-{
-    Node<Type>* Min = FindMinIntl(this->Root);
-    Type MinKey = Min->Key;
-    Min = nullptr;
-    return MinKey;
-}
-
-template<class Type>
-Type RedBlackTree<Type>::FindMax() const
-{
-    Node<Type>* Max = FindMaxIntl(this->Root);
-    Type MaxKey = Max->Key;
-    Max = nullptr;
-    return MaxKey;
-}
-
-template<class Type>
-Type* RedBlackTree<Type>::MakeArray() const
-{
-    Type* Arr = new Type[this->Size];
-    int x = 0;
-    InOrderFill(this->Root, Arr, x);
-    return Arr;
-}
-
-template<class Type>
-int RedBlackTree<Type>::GetHeight() const
-{
-    return GetHeightIntl(Root);
-}
-
-template<class Type>
-int RedBlackTree<Type>::GetBlackHeight() const
-{
-    return GetBlackHeightIntl(Root);
-}
-
-template<class Type>
-int RedBlackTree<Type>::GetSize() const
-{
-    return Size;
-}
-
-template<class Type>
-void RedBlackTree<Type>::InOrder() const
-{
-    InOrderItl(Root);
-}
-
-template<class Type>
-void RedBlackTree<Type>::PreOrder() const
-{
-    PreOrderItl(Root);
-}
-
-template<class Type>
-Node<Type>* RedBlackTree<Type>::FindIntl(const Type KeyToFind) const
-{
-    Node<Type>* Par = nullptr;
-    Node<Type>* CurrNode = this->Root;
-    while (CurrNode)
+    NodeType* Par = X->Parent;
+    Y->Parent = Par;
+    if (!Par)
     {
-        if (KeyToFind == CurrNode->Key)
-        {
-            return CurrNode;
-        }
-
-        Par = CurrNode;
-        if (KeyToFind < CurrNode->Key)
-        {
-            CurrNode = CurrNode->LChild;
-        }
-        else
-        {
-            CurrNode = CurrNode->RChild;
-        }
+        Root = Y;
+    }
+    else if (Par->LChild == X)
+    {
+        Par->LChild = Y;
+    }
+    else
+    {
+        Par->RChild = Y;
     }
 
-    CurrNode = nullptr;
+    Y->RChild = X;
+    X->Parent = Y;
 
-    return Par;
+    NodeUpdate::Update(X);
+    NodeUpdate::Update(Y);
 }
 
-template<class Type>
-void RedBlackTree<Type>::TreeFixInsertion(Node<Type>* X)
+template<class NodeType, class NodeUpdate>
+void RedBlackAlgorithms<NodeType, NodeUpdate>::FixInsertion(NodeType* X, NodeType*& Root)
 {
-    Node<Type>* CurrNode = X;
+    NodeType* CurrNode = X;
 
 //we assume the current node is coloured red; only do this loop while our parent is also coloured red
-    while ((CurrNode->Parent) && CurrNode->Parent->Colour == Node<Type>::NodeColour::Red)
+    while ((CurrNode->Parent) && CurrNode->Parent->Colour == NodeType::NodeColour::Red)
     {
-        Node<Type>* Par = CurrNode->Parent;
+        NodeType* Par = CurrNode->Parent;
 
 //Is Par a left child of its parent?
-        if ((Par->Parent->LChild) && *Par == *(Par->Parent->LChild))
+        if (Par == Par->Parent->LChild)
         {
-            Node<Type>* Y = Par->Parent->RChild;
-            if (Node<Type>::TestColourBlack(Y))
+            NodeType* Y = Par->Parent->RChild;
+            if (NodeType::TestColourBlack(Y))
             {
-                if ((Par->RChild) && *(Par->RChild) == *CurrNode)
+                if (Par->RChild == CurrNode)
                 {
                     CurrNode = Par;
-                    LeftRotation(CurrNode);
+                    LeftRotation(CurrNode, Root);
                 }
 
-                CurrNode->Parent->Colour = Node<Type>::NodeColour::Black;
-                CurrNode->Parent->Parent->Colour = Node<Type>::NodeColour::Red;
-                RightRotation(CurrNode->Parent->Parent);
+                CurrNode->Parent->Colour = NodeType::NodeColour::Black;
+                CurrNode->Parent->Parent->Colour = NodeType::NodeColour::Red;
+                RightRotation(CurrNode->Parent->Parent, Root);
             }
             else //we are going to recolour the nodes
             {
-                Par->Colour = Node<Type>::NodeColour::Black;
-                Y->Colour = Node<Type>::NodeColour::Black;
-                Y->Parent->Colour = Node<Type>::NodeColour::Red;
+                Par->Colour = NodeType::NodeColour::Black;
+                Y->Colour = NodeType::NodeColour::Black;
+                Y->Parent->Colour = NodeType::NodeColour::Red;
                 CurrNode = Y->Parent;
             }
-
-
-            Y = nullptr;
         }
         else  //We know Par is a right child of its parent
         {
-            Node<Type>* Y = Par->Parent->LChild;
-            if (Node<Type>::TestColourBlack(Y))
+            NodeType* Y = Par->Parent->LChild;
+            if (NodeType::TestColourBlack(Y))
             {
-                if ((Par->LChild) && *(Par->LChild) == *CurrNode)
+                if (Par->LChild == CurrNode)
                 {
                     CurrNode = Par;
-                    RightRotation(CurrNode);
+                    RightRotation(CurrNode, Root);
                 }
 
-                CurrNode->Parent->Colour = Node<Type>::NodeColour::Black;
-                CurrNode->Parent->Parent->Colour = Node<Type>::NodeColour::Red;
-                LeftRotation(CurrNode->Parent->Parent);
+                CurrNode->Parent->Colour = NodeType::NodeColour::Black;
+                CurrNode->Parent->Parent->Colour = NodeType::NodeColour::Red;
+                LeftRotation(CurrNode->Parent->Parent, Root);
             }
             else //we are going to recolour the nodes
             {
-                Par->Colour = Node<Type>::NodeColour::Black;
-                Y->Colour = Node<Type>::NodeColour::Black;
-                Y->Parent->Colour = Node<Type>::NodeColour::Red;
+                Par->Colour = NodeType::NodeColour::Black;
+                Y->Colour = NodeType::NodeColour::Black;
+                Y->Parent->Colour = NodeType::NodeColour::Red;
                 CurrNode = Y->Parent;
             }
-
-            Y = nullptr;
         }
-
-        Par = nullptr;
     }
-    this->Root->Colour = Node<Type>::NodeColour::Black;
-    CurrNode = nullptr;
+    Root->Colour = NodeType::NodeColour::Black;
 }
 
-template<class Type>
-void RedBlackTree<Type>::TreeFixDeletion(Node<Type>* X, Node<Type>* Y, Type DeletedKey)
+template<class NodeType, class NodeUpdate>
+void RedBlackAlgorithms<NodeType, NodeUpdate>::Erase(NodeType* Z, NodeType*& Root)
 {
-    Node<Type>* TempNode = nullptr;
+    typename NodeType::NodeColour RemovedColour = Z->Colour;
+    NodeType* X;
+    NodeType* XParent;
 
-//If node x is null, then we create a new temp node that takes its place, with parent Y
-    if (!X)
+    //case 1 and 2: Z has at most one child, which simply takes its place
+    if (!Z->LChild || !Z->RChild)
     {
-        X = new Node<Type>();
-        X->Parent = Y;
-        X->Colour = Node<Type>::NodeColour::Black;
-        X->Key = DeletedKey;
+        X = Z->LChild ? Z->LChild : Z->RChild;
+        XParent = Z->Parent;
+        Transplant(Z, X, Root);
+    }
+        //case 3: Z has two children; its successor is relinked into Z's position, keeping Z's colour
+    else
+    {
+        NodeType* Successor = Z->RChild;
+        while (Successor->LChild)
+        {
+            Successor = Successor->LChild;
+        }
 
-        TempNode = X;
+        RemovedColour = Successor->Colour;
+        X = Successor->RChild;
 
-        if (!Y->LChild)
+        if (Successor->Parent == Z)
         {
-            Y->LChild = X;
+            XParent = Successor;
         }
         else
         {
-            Y->RChild = X;
+            XParent = Successor->Parent;
+            Transplant(Successor, X, Root);
+            Successor->RChild = Z->RChild;
+            Successor->RChild->Parent = Successor;
         }
+
+        Transplant(Z, Successor, Root);
+        Successor->LChild = Z->LChild;
+        Successor->LChild->Parent = Successor;
+        Successor->Colour = Z->Colour;
+    }
+
+    //the successor, if it moved, sits on the path from XParent to the root
+    UpdatePath(XParent);
+
+    if (RemovedColour == NodeType::NodeColour::Black)
+    {
+        FixDeletion(X, XParent, Root);
     }
 
-    while (*X != *Root && X->Colour == Node<Type>::NodeColour::Black)
+    Z->Parent = Z->LChild = Z->RChild = nullptr;
+}
+
+template<class NodeType, class NodeUpdate>
+void RedBlackAlgorithms<NodeType, NodeUpdate>::FixDeletion(NodeType* X, NodeType* XParent, NodeType*& Root)
+{
+    while (X != Root && NodeType::TestColourBlack(X))
     {
-        Node<Type>* Sibling;
+        NodeType* Sibling;
 
-        if ((X->Parent->LChild) && *(X->Parent->LChild) == *X)
+        //X may be null, but then its sibling is not, which is enough to tell which side X is on
+        if (X == XParent->LChild)
         {
-            Sibling = X->Parent->RChild;
+            Sibling = XParent->RChild;
 
             //case 1: our sibling is red
-            if (Node<Type>::TestColourRed(Sibling))
+            if (NodeType::TestColourRed(Sibling))
             {
-                Sibling->Colour = Node<Type>::NodeColour::Black;
-                X->Parent->Colour = Node<Type>::NodeColour::Red;
-                LeftRotation(X->Parent);
+                Sibling->Colour = NodeType::NodeColour::Black;
+                XParent->Colour = NodeType::NodeColour::Red;
+                LeftRotation(XParent, Root);
 
-                Sibling = X->Parent->RChild;
+                Sibling = XParent->RChild;
             }
 
-            //case 2: Our sibling is black, with two blackk children
-            if (Node<Type>::TestColourBlack(Sibling->LChild) && Node<Type>::TestColourBlack(Sibling->RChild))
+            //case 2: Our sibling is black, with two black children
+            if (NodeType::TestColourBlack(Sibling->LChild) && NodeType::TestColourBlack(Sibling->RChild))
             {
-                Sibling->Colour = Node<Type>::NodeColour::Red;
+                Sibling->Colour = NodeType::NodeColour::Red;
 
-                X = X->Parent;
+                X = XParent;
+                XParent = XParent->Parent;
             }
             else
             {
                 //case 3: our sibling is black, and its right child is black as well
-                if (Node<Type>::TestColourBlack(Sibling->RChild))
+                if (NodeType::TestColourBlack(Sibling->RChild))
                 {
-                    Sibling->Colour = Node<Type>::NodeColour::Red;
-                    Sibling->LChild->Colour = Node<Type>::NodeColour::Black;
-                    RightRotation(Sibling);
-                    Sibling = X->Parent->RChild;
+                    Sibling->Colour = NodeType::NodeColour::Red;
+                    Sibling->LChild->Colour = NodeType::NodeColour::Black;
+                    RightRotation(Sibling, Root);
+                    Sibling = XParent->RChild;
                 }
 
                 //case 4: our sibling is black and its right child is red
-                Sibling->Colour = X->Parent->Colour;
-                X->Parent->Colour = Node<Type>::NodeColour::Black;
-                Sibling->RChild->Colour = Node<Type>::NodeColour::Black;
-                LeftRotation(X->Parent);
+                Sibling->Colour = XParent->Colour;
+                XParent->Colour = NodeType::NodeColour::Black;
+                Sibling->RChild->Colour = NodeType::NodeColour::Black;
+                LeftRotation(XParent, Root);
 
-                X = this->Root;
+                X = Root;
             }
         }
         else
         {
-            Sibling = X->Parent->LChild;
+            Sibling = XParent->LChild;
 
             //case 1: our sibling is red
-            if (Node<Type>::TestColourRed(Sibling))
+            if (NodeType::TestColourRed(Sibling))
             {
-                Sibling->Colour = Node<Type>::NodeColour::Black;
-                X->Parent->Colour = Node<Type>::NodeColour::Red;
-                RightRotation(X->Parent);
+                Sibling->Colour = NodeType::NodeColour::Black;
+                XParent->Colour = NodeType::NodeColour::Red;
+                RightRotation(XParent, Root);
 
-                Sibling = X->Parent->LChild;
+                Sibling = XParent->LChild;
             }
 
-            //case 2: Our sibling is black, with two blackk children
-            if (Node<Type>::TestColourBlack(Sibling->LChild) && Node<Type>::TestColourBlack(Sibling->RChild))
+            //case 2: Our sibling is black, with two black children
+            if (NodeType::TestColourBlack(Sibling->LChild) && NodeType::TestColourBlack(Sibling->RChild))
             {
-                Sibling->Colour = Node<Type>::NodeColour::Red;
+                Sibling->Colour = NodeType::NodeColour::Red;
 
-                X = X->Parent;
+                X = XParent;
+                XParent = XParent->Parent;
             }
             else
             {
                 //case 3: our sibling is black, and its left child is black as well
-                if (Node<Type>::TestColourBlack(Sibling->LChild))
+                if (NodeType::TestColourBlack(Sibling->LChild))
                 {
-                    Sibling->Colour = Node<Type>::NodeColour::Red;
-                    Sibling->RChild->Colour = Node<Type>::NodeColour::Black;
-                    LeftRotation(Sibling);
-                    Sibling = X->Parent->LChild;
+                    Sibling->Colour = NodeType::NodeColour::Red;
+                    Sibling->RChild->Colour = NodeType::NodeColour::Black;
+                    LeftRotation(Sibling, Root);
+                    Sibling = XParent->LChild;
                 }
 
                 //case 4: our sibling is black and its left child is red
-                Sibling->Colour = X->Parent->Colour;
-                X->Parent->Colour = Node<Type>::NodeColour::Black;
-                Sibling->LChild->Colour = Node<Type>::NodeColour::Black;
-                RightRotation(X->Parent);
+                Sibling->Colour = XParent->Colour;
+                XParent->Colour = NodeType::NodeColour::Black;
+                Sibling->LChild->Colour = NodeType::NodeColour::Black;
+                RightRotation(XParent, Root);
 
                 X = Root;
             }
         }
-
-        Sibling = nullptr;
     }
-    X->Colour = Node<Type>::NodeColour::Black;
 
-//delete the temp node if we created it at the beginning of the function
-    if (TempNode)
+    if (X)
     {
-        if ((Y->LChild) && *Y->LChild == *TempNode)
-        {
-            Y->LChild = nullptr;
-        }
-        else
-        {
-            Y->RChild = nullptr;
-        }
-
-        delete TempNode;
-        TempNode = nullptr;
+        X->Colour = NodeType::NodeColour::Black;
     }
 }
 
-template<class Type>
-void RedBlackTree<Type>::LeftRotation(Node<Type>* X)
+template<class NodeType, class NodeUpdate>
+void RedBlackAlgorithms<NodeType, NodeUpdate>::Transplant(NodeType* OldChild, NodeType* NewChild, NodeType*& Root)
 {
-    Node<Type>* Y = X->RChild;
-
-//move Y's left child to the right child of X and modify the child's parent if necessary
-    X->RChild = Y->LChild;
-    if (Y->LChild != nullptr)
-    {
-        X->RChild->Parent = X;
-    }
-
-    Node<Type>* Par = X->Parent;
-    if (!Par)
+    if (!OldChild->Parent)
     {
-        this->Root = Y;
-        Y->Parent = nullptr;
+        Root = NewChild;
     }
-    else if ((Par->LChild) && *(Par->LChild) == *X)
+    else if (OldChild->Parent->LChild == OldChild)
     {
-        Par->LChild = Y;
-        Y->Parent = Par;
+        OldChild->Parent->LChild = NewChild;
     }
     else
     {
-        Par->RChild = Y;
-        Y->Parent = Par;
+        OldChild->Parent->RChild = NewChild;
     }
 
-    Y->LChild = X;
-    X->Parent = Y;
-
-    Y = nullptr;
-    Par = nullptr;
+    if (NewChild)
+    {
+        NewChild->Parent = OldChild->Parent;
+    }
 }
 
-template<class Type>
-void RedBlackTree<Type>::RightRotation(Node<Type>* X)
+template<class NodeType, class NodeUpdate>
+void RedBlackAlgorithms<NodeType, NodeUpdate>::UpdatePath(NodeType* StartNode)
 {
-    Node<Type>* Y = X->LChild;
-
-    X->LChild = Y->RChild;
-    if (Y->RChild != nullptr)
+    if (!NodeUpdate::IsSummarized)
     {
-        Y->RChild->Parent = X;
+        return;
     }
 
-    Node<Type>* Par = X->Parent;
-    if (!Par)
-    {
-        this->Root = Y;
-        Y->Parent = nullptr;
-    }
-    else if ((Par->LChild) && *(Par->LChild) == *X)
-    {
-        Par->LChild = Y;
-        Y->Parent = Par;
-    }
-    else
+    for (NodeType* CurrNode = StartNode; CurrNode; CurrNode = CurrNode->Parent)
     {
-        Par->RChild = Y;
-        Y->Parent = Par;
+        NodeUpdate::Update(CurrNode);
     }
+}
 
-    Y->RChild = X;
-    X->Parent = Y;
 
-    Y = nullptr;
-    Par = nullptr;
+template<class Type, class Summary, class Allocator>
+RedBlackTree<Type, Summary, Allocator>::NodeHandle::NodeHandle()
+{
+    HeldNode = nullptr;
 }
 
-template<class Type>
-void RedBlackTree<Type>::DeleteLeaf(Node<Type>* NodeToDelete)
+template<class Type, class Summary, class Allocator>
+RedBlackTree<Type, Summary, Allocator>::NodeHandle::NodeHandle(Node<Type, Summary>* HeldNode,
+                                                       const NodeAllocatorType &HandleAllocator) :
+        HeldNode(HeldNode), HandleAllocator(HandleAllocator)
 {
-    if ((NodeToDelete->Parent->LChild) && *(NodeToDelete->Parent->LChild) == *NodeToDelete)
-    {
-        NodeToDelete->Parent->LChild = nullptr;
-    }
-    else
-    {
-        NodeToDelete->Parent->RChild = nullptr;
-    }
-
-    delete NodeToDelete;
-    NodeToDelete = nullptr;
 }
 
-template<class Type>
-void RedBlackTree<Type>::DeleteNodeOneChild(Node<Type>* NodeToDelete)
+template<class Type, class Summary, class Allocator>
+RedBlackTree<Type, Summary, Allocator>::NodeHandle::~NodeHandle()
 {
-    if (NodeToDelete->LChild)
+    Release();
+}
+
+template<class Type, class Summary, class Allocator>
+RedBlackTree<Type, Summary, Allocator>::NodeHandle::NodeHandle(NodeHandle &&Other) noexcept :
+        HeldNode(Other.HeldNode), HandleAllocator(std::move(Other.HandleAllocator))
+{
+    Other.HeldNode = nullptr;
+    Other.HandleAllocator.reset();
+}
+
+template<class Type, class Summary, class Allocator>
+typename RedBlackTree<Type, Summary, Allocator>::NodeHandle &RedBlackTree<Type, Summary, Allocator>::NodeHandle::operator=(NodeHandle &&Other) noexcept
+{
+    if (this != &Other)
+    {
+        Release();
+        HeldNode = Other.HeldNode;
+        HandleAllocator = std::move(Other.HandleAllocator);
+        Other.HeldNode = nullptr;
+        Other.HandleAllocator.reset();
+    }
+    return *this;
+}
+
+template<class Type, class Summary, class Allocator>
+bool RedBlackTree<Type, Summary, Allocator>::NodeHandle::Empty() const
+{
+    return HeldNode == nullptr;
+}
+
+template<class Type, class Summary, class Allocator>
+RedBlackTree<Type, Summary, Allocator>::NodeHandle::operator bool() const
+{
+    return HeldNode != nullptr;
+}
+
+template<class Type, class Summary, class Allocator>
+Type &RedBlackTree<Type, Summary, Allocator>::NodeHandle::Key() const
+{
+    return HeldNode->Key;
+}
+
+template<class Type, class Summary, class Allocator>
+void RedBlackTree<Type, Summary, Allocator>::NodeHandle::Release()
+{
+    if (HeldNode)
+    {
+        NodeAllocatorTraits::destroy(*HandleAllocator, HeldNode);
+        NodeAllocatorTraits::deallocate(*HandleAllocator, HeldNode, 1);
+        HeldNode = nullptr;
+        HandleAllocator.reset();
+    }
+}
+
+template<class Type, class Summary, class Allocator>
+RedBlackTree<Type, Summary, Allocator>::RedBlackTree() : RedBlackTree(Allocator())
+{
+}
+
+template<class Type, class Summary, class Allocator>
+RedBlackTree<Type, Summary, Allocator>::RedBlackTree(const Allocator &NodeAllocator) : NodeAllocator(NodeAllocator)
+{
+    Root = nullptr;
+    Size = 0;
+    RemovalEpoch = 0;
+    Leftmost = Rightmost = nullptr;
+    KeyHeapBytes = 0;
+    FreedNodes = 0;
+    MemoryBudget = 0;
+}
+
+template<class Type, class Summary, class Allocator>
+RedBlackTree<Type, Summary, Allocator>::RedBlackTree(Type RootKey, const Allocator &NodeAllocator) :
+        NodeAllocator(NodeAllocator)
+{
+    //the counters are set first, since CreateNode already updates the freed node count
+    Size = 1;
+    RemovalEpoch = 0;
+    KeyHeapBytes = KeyMemoryTraits<Type>::HeapBytes(RootKey);
+    FreedNodes = 0;
+    MemoryBudget = 0;
+
+    Root = CreateNode(RootKey);
+    Root->Colour = Node<Type, Summary>::NodeColour::Black;
+    Leftmost = Rightmost = Root;
+}
+
+template<class Type, class Summary, class Allocator>
+RedBlackTree<Type, Summary, Allocator>::~RedBlackTree()
+{
+    DeleteSubtree(Root);
+}
+
+
+template<class Type, class Summary, class Allocator>
+void RedBlackTree<Type, Summary, Allocator>::Insert(const Type NewKey)
+{
+    Node<Type, Summary>* Par = Root ? FindIntl(NewKey) : nullptr;
+
+    //If find returns a node that does not match the new key, then we need to insert that key
+    if (!Par || Par->Key != NewKey)
+    {
+        LinkNode(AllocateNode(NewKey), Par);
+    }
+}
+
+template<class Type, class Summary, class Allocator>
+bool RedBlackTree<Type, Summary, Allocator>::Insert(NodeHandle &&Handle)
+{
+    if (Handle.Empty())
+    {
+        return false;
+    }
+    if (!(NodeAllocator == *Handle.HandleAllocator))
+    {
+        throw std::invalid_argument("A node can only be inserted into a RedBlackTree with an equal allocator");
+    }
+
+    Node<Type, Summary>* Par = Root ? FindIntl(Handle.HeldNode->Key) : nullptr;
+    if (Par && Par->Key == Handle.HeldNode->Key)
+    {
+        return false;
+    }
+
+    std::size_t NewBytes = AllocationBytes(sizeof(Node<Type, Summary>)) +
+                           KeyMemoryTraits<Type>::HeapBytes(Handle.HeldNode->Key);
+    if (MemoryBudget != 0 && GetMemoryUsage().TotalBytes() + NewBytes > MemoryBudget)
+    {
+        throw std::length_error("Insert would exceed the memory budget of the RedBlackTree");
+    }
+
+    LinkNode(Handle.HeldNode, Par);
+    Handle.HeldNode = nullptr;
+    Handle.HandleAllocator.reset();
+    return true;
+}
+
+template<class Type, class Summary, class Allocator>
+typename RedBlackTree<Type, Summary, Allocator>::NodeHandle RedBlackTree<Type, Summary, Allocator>::Extract(
+        const Type KeyToExtract)
+{
+    if (Size == 0)
+    {
+        return NodeHandle();
+    }
+
+    Node<Type, Summary>* NodeToExtract = FindIntl(KeyToExtract);
+    if (NodeToExtract->Key != KeyToExtract)
+    {
+        return NodeHandle();
+    }
+
+    UnlinkNode(NodeToExtract);
+    return NodeHandle(NodeToExtract, NodeAllocator);
+}
+
+template<class Type, class Summary, class Allocator>
+std::size_t RedBlackTree<Type, Summary, Allocator>::Merge(RedBlackTree &Other)
+{
+    if (this == &Other || Other.Size == 0)
+    {
+        return 0;
+    }
+    CheckSameAllocator(Other);
+
+    //when the two key ranges do not overlap, the whole of Other can be joined on in one piece
+    if (Size == 0 || Rightmost->Key < Other.Leftmost->Key || Other.Rightmost->Key < Leftmost->Key)
+    {
+        std::size_t Moved = Other.Size;
+        Concatenate(Other);
+        return Moved;
+    }
+
+    //unlinking a node never moves the others, so the next node in order can be found before the current one leaves
+    std::size_t Moved = 0;
+    Node<Type, Summary>* CurrNode = Other.Leftmost;
+    while (CurrNode)
+    {
+        Node<Type, Summary>* Next = NextNode(CurrNode);
+        Node<Type, Summary>* Par = FindIntl(CurrNode->Key);
+        if (Par->Key != CurrNode->Key)
+        {
+            Other.UnlinkNode(CurrNode);
+            LinkNode(CurrNode, Par);
+            Moved++;
+        }
+        CurrNode = Next;
+    }
+    return Moved;
+}
+
+template<class Type, class Summary, class Allocator>
+void RedBlackTree<Type, Summary, Allocator>::Delete(const Type KeyToDelete)
+{
+    if (Size == 0)
+    {
+        return;
+    }
+
+    Node<Type, Summary>* NodeToDelete = FindIntl(KeyToDelete);
+
+    //if the key doesn't exist in our tree, then just return
+    if (NodeToDelete->Key != KeyToDelete)
+    {
+        return;
+    }
+
+    EraseNode(NodeToDelete);
+}
+
+template<class Type, class Summary, class Allocator>
+std::size_t RedBlackTree<Type, Summary, Allocator>::EraseRange(const Type Low, const Type High)
+{
+    if (Size == 0 || High < Low)
+    {
+        return 0;
+    }
+
+    //leave the tree untouched if no key lies in the range
+    Node<Type, Summary>* InRange = Root;
+    while (InRange && (InRange->Key < Low || High < InRange->Key))
+    {
+        InRange = (InRange->Key < Low) ? InRange->RChild : InRange->LChild;
+    }
+
+    if (!InRange)
+    {
+        return 0;
+    }
+
+    Node<Type, Summary>* Less;
+    Node<Type, Summary>* Rest;
+    Node<Type, Summary>* Middle;
+    Node<Type, Summary>* Greater;
+
+    Split(Root, Low, false, Less, Rest);
+    Split(Rest, High, true, Middle, Greater);
+
+    //free everything in the range except its root, which is borrowed as the pivot to join the halves back together
+    std::size_t Erased = DeleteSubtree(Middle->LChild) + DeleteSubtree(Middle->RChild) + 1;
+    Middle->LChild = Middle->RChild = nullptr;
+    Size -= Erased - 1;
+
+    Join(Less, Middle, Greater);
+    ResetExtremes();
+    Delete(Middle->Key);
+
+    return Erased;
+}
+
+template<class Type, class Summary, class Allocator>
+void RedBlackTree<Type, Summary, Allocator>::AssignSorted(const Type* Keys, std::size_t Count)
+{
+    std::size_t NewKeyHeapBytes = 0;
+    for (std::size_t i = 0; i < Count; i++)
+    {
+        NewKeyHeapBytes += KeyMemoryTraits<Type>::HeapBytes(Keys[i]);
+    }
+
+    //the old keys are freed before the new ones are allocated, so only the new keys count against the budget;
+    //the copies the nodes make of them are measured again as they are built
+    if (MemoryBudget != 0 &&
+        Count * AllocationBytes(sizeof(Node<Type, Summary>)) + NewKeyHeapBytes > MemoryBudget)
+    {
+        throw std::length_error("AssignSorted would exceed the memory budget of the RedBlackTree");
+    }
+
+    DeleteSubtree(Root);
+    KeyHeapBytes = 0;
+
+    //the deepest level of a balanced tree of n nodes is level floor(log2 n), which is only partly filled unless
+    //n + 1 is a power of two
+    int RedDepth = -1;
+    if ((Count + 1) & Count)
+    {
+        RedDepth = 0;
+        for (std::size_t Remaining = Count; Remaining > 1; Remaining >>= 1)
+        {
+            RedDepth++;
+        }
+    }
+
+    Root = BuildBalanced(Keys, Count, 0, RedDepth);
+    if (Root)
+    {
+        Root->Parent = nullptr;
+    }
+    Size = Count;
+    ResetExtremes();
+}
+
+template<class Type, class Summary, class Allocator>
+void RedBlackTree<Type, Summary, Allocator>::SplitOffAbove(const Type SplitKey, RedBlackTree &Upper)
+{
+    SplitOffIntl(SplitKey, Upper, true);
+}
+
+template<class Type, class Summary, class Allocator>
+void RedBlackTree<Type, Summary, Allocator>::SplitOffBelow(const Type SplitKey, RedBlackTree &Lower)
+{
+    SplitOffIntl(SplitKey, Lower, false);
+}
+
+template<class Type, class Summary, class Allocator>
+void RedBlackTree<Type, Summary, Allocator>::Concatenate(RedBlackTree &Other)
+{
+    if (this == &Other || Other.Size == 0)
+    {
+        return;
+    }
+    CheckSameAllocator(Other);
+
+    Other.RemovalEpoch++;
+    if (Size == 0)
+    {
+        std::swap(Root, Other.Root);
+        std::swap(Size, Other.Size);
+        std::swap(Leftmost, Other.Leftmost);
+        std::swap(Rightmost, Other.Rightmost);
+        std::swap(KeyHeapBytes, Other.KeyHeapBytes);
+        return;
+    }
+
+    //the key of Other nearest to this tree is unlinked and used as the pivot joining the two trees
+    bool OtherAbove = FindMaxIntl(Root)->Key < FindMinIntl(Other.Root)->Key;
+    Node<Type, Summary>* Pivot = OtherAbove ? FindMinIntl(Other.Root) : FindMaxIntl(Other.Root);
+    Algorithms::Erase(Pivot, Other.Root);
+
+    if (OtherAbove)
+    {
+        Join(Root, Pivot, Other.Root);
+    }
+    else
+    {
+        Join(Other.Root, Pivot, Root);
+    }
+
+    Size += Other.Size;
+    KeyHeapBytes += Other.KeyHeapBytes;
+    ResetExtremes();
+    Other.Root = nullptr;
+    Other.Size = 0;
+    Other.KeyHeapBytes = 0;
+    Other.Leftmost = Other.Rightmost = nullptr;
+}
+
+template<class Type, class Summary, class Allocator>
+bool RedBlackTree<Type, Summary, Allocator>::Find(const Type KeyToFind) const
+{
+    if (Size == 0)
+    {
+        return false;
+    }
+
+    Node<Type, Summary>* FoundNode = FindIntl(KeyToFind);
+    Type NodeKey = FoundNode->Key;
+    FoundNode = nullptr;
+    return NodeKey == KeyToFind;
+}
+
+template<class Type, class Summary, class Allocator>
+Type RedBlackTree<Type, Summary, Allocator>::FindMin() const
+{
+    if (!Leftmost)
+    {
+        throw std::out_of_range("FindMin called on an empty RedBlackTree");
+    }
+    return Leftmost->Key;
+}
+
+template<class Type, class Summary, class Allocator>
+Type RedBlackTree<Type, Summary, Allocator>::FindMax() const
+{
+    if (!Rightmost)
+    {
+        throw std::out_of_range("FindMax called on an empty RedBlackTree");
+    }
+    return Rightmost->Key;
+}
+
+template<class Type, class Summary, class Allocator>
+Type RedBlackTree<Type, Summary, Allocator>::PopMin()
+{
+    if (!Leftmost)
+    {
+        throw std::out_of_range("PopMin called on an empty RedBlackTree");
+    }
+
+    Type MinKey = Leftmost->Key;
+    EraseNode(Leftmost);
+    return MinKey;
+}
+
+template<class Type, class Summary, class Allocator>
+Type RedBlackTree<Type, Summary, Allocator>::PopMax()
+{
+    if (!Rightmost)
+    {
+        throw std::out_of_range("PopMax called on an empty RedBlackTree");
+    }
+
+    Type MaxKey = Rightmost->Key;
+    EraseNode(Rightmost);
+    return MaxKey;
+}
+
+template<class Type, class Summary, class Allocator>
+Type* RedBlackTree<Type, Summary, Allocator>::MakeArray() const
+{
+    Type* Arr = new Type[this->Size];
+    FillSubtree(this->Root, Arr);
+    return Arr;
+}
+
+template<class Type, class Summary, class Allocator>
+std::size_t RedBlackTree<Type, Summary, Allocator>::ExportTo(Type* Buffer, std::size_t Capacity) const
+{
+    if (Capacity >= Size)
+    {
+        return FillSubtree(Root, Buffer);
+    }
+
+    std::size_t Written = 0;
+    for (Node<Type, Summary>* CurrNode = Leftmost; Written < Capacity; CurrNode = NextNode(CurrNode))
+    {
+        Buffer[Written] = CurrNode->Key;
+        Written++;
+    }
+    return Written;
+}
+
+template<class Type, class Summary, class Allocator>
+template<class ChunkFunction>
+void RedBlackTree<Type, Summary, Allocator>::ExportChunks(std::size_t ChunkSize, ChunkFunction OnChunk) const
+{
+    if (ChunkSize == 0)
+    {
+        throw std::invalid_argument("ExportChunks needs a chunk size of at least one key");
+    }
+
+    std::vector<Type> Chunk;
+    Chunk.reserve(std::min(ChunkSize, Size));
+
+    for (Node<Type, Summary>* CurrNode = Leftmost; CurrNode; CurrNode = NextNode(CurrNode))
+    {
+        Chunk.push_back(CurrNode->Key);
+        if (Chunk.size() == ChunkSize)
+        {
+            OnChunk(Chunk.data(), Chunk.size());
+            Chunk.clear();
+        }
+    }
+
+    if (!Chunk.empty())
+    {
+        OnChunk(Chunk.data(), Chunk.size());
+    }
+}
+
+template<class Type, class Summary, class Allocator>
+void RedBlackTree<Type, Summary, Allocator>::ParallelExportTo(Type* Buffer, unsigned NumThreads) const
+{
+    if (NumThreads == 0)
+    {
+        NumThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    //cut the tree into about eight subtrees per thread, so that threads drawing uneven subtrees still finish together
+    int SplitDepth = 3;
+    for (unsigned Threads = 1; Threads < NumThreads; Threads *= 2)
+    {
+        SplitDepth++;
+    }
+
+    std::vector<ExportTask> Tasks;
+    CollectExportTasks(Root, SplitDepth, Tasks);
+
+    ForEachParallel(Tasks.size(), NumThreads, [this, &Tasks](std::size_t i)
+    {
+        Tasks[i].Count = Tasks[i].WholeSubtree ? CountSubtree(Tasks[i].Start) : 1;
+    });
+
+    std::size_t Offset = 0;
+    for (ExportTask &Task : Tasks)
+    {
+        Task.Offset = Offset;
+        Offset += Task.Count;
+    }
+
+    ForEachParallel(Tasks.size(), NumThreads, [this, &Tasks, Buffer](std::size_t i)
+    {
+        if (Tasks[i].WholeSubtree)
+        {
+            FillSubtree(Tasks[i].Start, Buffer + Tasks[i].Offset);
+        }
+        else
+        {
+            Buffer[Tasks[i].Offset] = Tasks[i].Start->Key;
+        }
+    });
+}
+
+template<class Type, class Summary, class Allocator>
+std::optional<Type> RedBlackTree<Type, Summary, Allocator>::Floor(const Type Key) const
+{
+    Node<Type, Summary>* Found = FloorIntl(Key, true);
+    return Found ? std::optional<Type>(Found->Key) : std::nullopt;
+}
+
+template<class Type, class Summary, class Allocator>
+std::optional<Type> RedBlackTree<Type, Summary, Allocator>::Ceiling(const Type Key) const
+{
+    Node<Type, Summary>* Found = CeilingIntl(Key, true);
+    return Found ? std::optional<Type>(Found->Key) : std::nullopt;
+}
+
+template<class Type, class Summary, class Allocator>
+std::optional<Type> RedBlackTree<Type, Summary, Allocator>::Predecessor(const Type Key) const
+{
+    Node<Type, Summary>* Found = FloorIntl(Key, false);
+    return Found ? std::optional<Type>(Found->Key) : std::nullopt;
+}
+
+template<class Type, class Summary, class Allocator>
+std::optional<Type> RedBlackTree<Type, Summary, Allocator>::Successor(const Type Key) const
+{
+    Node<Type, Summary>* Found = CeilingIntl(Key, false);
+    return Found ? std::optional<Type>(Found->Key) : std::nullopt;
+}
+
+template<class Type, class Summary, class Allocator>
+std::vector<Type> RedBlackTree<Type, Summary, Allocator>::KNearest(const Type Key, std::size_t K) const
+{
+    std::vector<Type> Nearest;
+    Nearest.reserve(std::min(K, Size));
+
+    //the two cursors start on either side of where the key lands; a key in the tree is found by the lower one
+    Node<Type, Summary>* Lower = FloorIntl(Key, true);
+    Node<Type, Summary>* Upper = Lower ? NextNode(Lower) : Leftmost;
+
+    while (Nearest.size() < K && (Lower || Upper))
+    {
+        if (!Upper || (Lower && !UpperIsCloser(Key, Lower->Key, Upper->Key)))
+        {
+            Nearest.push_back(Lower->Key);
+            Lower = PrevNode(Lower);
+        }
+        else
+        {
+            Nearest.push_back(Upper->Key);
+            Upper = NextNode(Upper);
+        }
+    }
+    return Nearest;
+}
+
+template<class Type, class Summary, class Allocator>
+bool RedBlackTree<Type, Summary, Allocator>::UpperIsCloser(const Type &Key, const Type &Lower, const Type &Upper)
+{
+    //the gap between two signed integers may not fit the signed type, but always fits its unsigned counterpart
+    if constexpr (std::is_integral<Type>::value && !std::is_same<Type, bool>::value)
+    {
+        typedef typename std::make_unsigned<Type>::type Distance;
+        return (Distance) ((Distance) Upper - (Distance) Key) < (Distance) ((Distance) Key - (Distance) Lower);
+    }
+    else
+    {
+        return Upper - Key < Key - Lower;
+    }
+}
+
+template<class Type, class Summary, class Allocator>
+Type RedBlackTree<Type, Summary, Allocator>::KeyAt(std::size_t Position) const
+{
+    if (Position >= Size)
+    {
+        throw std::out_of_range("KeyAt called with a position past the end of the RedBlackTree");
+    }
+
+    Node<Type, Summary>* CurrNode;
+    if (Position < Size - Position)
+    {
+        CurrNode = Leftmost;
+        for (std::size_t i = 0; i < Position; i++)
+        {
+            CurrNode = NextNode(CurrNode);
+        }
+    }
+    else
+    {
+        CurrNode = Rightmost;
+        for (std::size_t i = Size - 1; i > Position; i--)
+        {
+            CurrNode = PrevNode(CurrNode);
+        }
+    }
+    return CurrNode->Key;
+}
+
+template<class Type, class Summary, class Allocator>
+typename Summary::Value RedBlackTree<Type, Summary, Allocator>::Aggregate(const Type Low, const Type High) const
+{
+    //walk down until we reach the first node whose key lies in the range; the range then splits around it
+    Node<Type, Summary>* Split = this->Root;
+    while (Split && (Split->Key < Low || High < Split->Key))
+    {
+        Split = (Split->Key < Low) ? Split->RChild : Split->LChild;
+    }
+
+    if (!Split)
+    {
+        return Summary::Identity();
+    }
+
+    //left of the split, every node at least as large as Low is kept along with its whole right subtree
+    typename Summary::Value LeftPart = Summary::Identity();
+    for (Node<Type, Summary>* CurrNode = Split->LChild; CurrNode;)
+    {
+        if (CurrNode->Key < Low)
+        {
+            CurrNode = CurrNode->RChild;
+        }
+        else
+        {
+            LeftPart = Summary::Combine(Summary::Combine(Summary::Lift(CurrNode->Key), SummaryOf(CurrNode->RChild)),
+                                        LeftPart);
+            CurrNode = CurrNode->LChild;
+        }
+    }
+
+    //right of the split, every node no larger than High is kept along with its whole left subtree
+    typename Summary::Value RightPart = Summary::Identity();
+    for (Node<Type, Summary>* CurrNode = Split->RChild; CurrNode;)
+    {
+        if (High < CurrNode->Key)
+        {
+            CurrNode = CurrNode->LChild;
+        }
+        else
+        {
+            RightPart = Summary::Combine(RightPart,
+                                         Summary::Combine(SummaryOf(CurrNode->LChild), Summary::Lift(CurrNode->Key)));
+            CurrNode = CurrNode->RChild;
+        }
+    }
+
+    return Summary::Combine(Summary::Combine(LeftPart, Summary::Lift(Split->Key)), RightPart);
+}
+
+template<class Type, class Summary, class Allocator>
+int RedBlackTree<Type, Summary, Allocator>::GetHeight() const
+{
+    return GetHeightIntl(Root);
+}
+
+template<class Type, class Summary, class Allocator>
+int RedBlackTree<Type, Summary, Allocator>::GetBlackHeight() const
+{
+    return GetBlackHeightIntl(Root);
+}
+
+template<class Type, class Summary, class Allocator>
+std::size_t RedBlackTree<Type, Summary, Allocator>::GetSize() const
+{
+    return Size;
+}
+
+template<class Type, class Summary, class Allocator>
+Allocator RedBlackTree<Type, Summary, Allocator>::GetAllocator() const
+{
+    return Allocator(NodeAllocator);
+}
+
+template<class Type, class Summary, class Allocator>
+TreeMemoryUsage RedBlackTree<Type, Summary, Allocator>::GetMemoryUsage() const
+{
+    std::size_t Allocated = AllocationBytes(sizeof(Node<Type, Summary>));
+
+    TreeMemoryUsage Usage;
+    Usage.Nodes = Size;
+    Usage.NodeBytes = Size * sizeof(Node<Type, Summary>);
+    Usage.AllocatorOverheadBytes = Size * (Allocated - sizeof(Node<Type, Summary>));
+    Usage.KeyHeapBytes = KeyHeapBytes;
+    Usage.FreedNodeBytes = FreedNodes * Allocated;
+    return Usage;
+}
+
+template<class Type, class Summary, class Allocator>
+void RedBlackTree<Type, Summary, Allocator>::SetMemoryBudget(std::size_t Bytes)
+{
+    MemoryBudget = Bytes;
+}
+
+template<class Type, class Summary, class Allocator>
+std::size_t RedBlackTree<Type, Summary, Allocator>::GetMemoryBudget() const
+{
+    return MemoryBudget;
+}
+
+template<class Type, class Summary, class Allocator>
+void RedBlackTree<Type, Summary, Allocator>::InOrder() const
+{
+    InOrderItl(Root);
+}
+
+template<class Type, class Summary, class Allocator>
+void RedBlackTree<Type, Summary, Allocator>::PreOrder() const
+{
+    PreOrderItl(Root);
+}
+
+template<class Type, class Summary, class Allocator>
+Node<Type, Summary>* RedBlackTree<Type, Summary, Allocator>::FindIntl(const Type KeyToFind) const
+{
+    Node<Type, Summary>* Par = nullptr;
+    Node<Type, Summary>* CurrNode = this->Root;
+    while (CurrNode)
+    {
+        if (KeyToFind == CurrNode->Key)
+        {
+            return CurrNode;
+        }
+
+        Par = CurrNode;
+        if (KeyToFind < CurrNode->Key)
+        {
+            CurrNode = CurrNode->LChild;
+        }
+        else
+        {
+            CurrNode = CurrNode->RChild;
+        }
+    }
+
+    CurrNode = nullptr;
+
+    return Par;
+}
+
+template<class Type, class Summary, class Allocator>
+void RedBlackTree<Type, Summary, Allocator>::TreeFixInsertion(Node<Type, Summary>* X)
+{
+    Algorithms::FixInsertion(X, Root);
+}
+
+template<class Type, class Summary, class Allocator>
+void RedBlackTree<Type, Summary, Allocator>::LeftRotation(Node<Type, Summary>* X)
+{
+    Algorithms::LeftRotation(X, Root);
+}
+
+template<class Type, class Summary, class Allocator>
+void RedBlackTree<Type, Summary, Allocator>::RightRotation(Node<Type, Summary>* X)
+{
+    Algorithms::RightRotation(X, Root);
+}
+
+template<class Type, class Summary, class Allocator>
+Node<Type, Summary>* RedBlackTree<Type, Summary, Allocator>::FindMinIntl(Node<Type, Summary>* StartNode) const
+{
+    Node<Type, Summary>* MinNode = nullptr;
+    Node<Type, Summary>* CurrNode = StartNode;
+
+    while (CurrNode)
+    {
+        MinNode = CurrNode;
+        CurrNode = CurrNode->LChild;
+    }
+    CurrNode = nullptr;
+    return MinNode;
+}
+
+template<class Type, class Summary, class Allocator>
+Node<Type, Summary>* RedBlackTree<Type, Summary, Allocator>::FindMaxIntl(Node<Type, Summary>* StartNode) const
+{
+    Node<Type, Summary>* MaxNode = nullptr;
+    Node<Type, Summary>* CurrNode = StartNode;
+
+    while (CurrNode)
+    {
+        MaxNode = CurrNode;
+        CurrNode = CurrNode->RChild;
+    }
+    CurrNode = nullptr;
+    return MaxNode;
+}
+
+template<class Type, class Summary, class Allocator>
+int RedBlackTree<Type, Summary, Allocator>::GetHeightIntl(Node<Type, Summary>* Curr) const
+{
+    if (!Curr)
+    {
+        return -1;
+    }
+
+    return std::max(GetHeightIntl(Curr->LChild), GetHeightIntl(Curr->RChild)) + 1;
+}
+
+template<class Type, class Summary, class Allocator>
+int RedBlackTree<Type, Summary, Allocator>::GetBlackHeightIntl(Node<Type, Summary>* Curr) const
+{
+    if (!Curr)
+    {
+        return 0;
+    }
+
+    if (Curr->Colour == Node<Type, Summary>::NodeColour::Black)
+    {
+        return GetHeightIntl(Curr->LChild) + 1;
+    }
+    else
+    {
+        return GetHeightIntl(Curr->LChild);
+    }
+}
+
+template<class Type, class Summary, class Allocator>
+std::size_t RedBlackTree<Type, Summary, Allocator>::FillSubtree(Node<Type, Summary>* A, Type* Arr) const
+{
+    std::size_t Written = 0;
+    Node<Type, Summary>* CurrNode = FindMinIntl(A);
+    while (CurrNode)
+    {
+        Arr[Written] = CurrNode->Key;
+        Written++;
+
+        if (CurrNode->RChild)
+        {
+            CurrNode = FindMinIntl(CurrNode->RChild);
+            continue;
+        }
+
+        //climb out of right subtrees; the first ancestor reached from its left is next, unless we left the subtree
+        while (CurrNode != A && CurrNode->Parent->RChild == CurrNode)
+        {
+            CurrNode = CurrNode->Parent;
+        }
+        CurrNode = (CurrNode == A) ? nullptr : CurrNode->Parent;
+    }
+    return Written;
+}
+
+template<class Type, class Summary, class Allocator>
+void RedBlackTree<Type, Summary, Allocator>::CollectExportTasks(Node<Type, Summary>* A, int Depth,
+                                                     std::vector<ExportTask> &Tasks) const
+{
+    if (!A)
     {
-        ReplaceNode(NodeToDelete, NodeToDelete->LChild);
-        NodeToDelete->LChild = nullptr;
+        return;
     }
-    else
+
+    if (Depth == 0)
     {
-        ReplaceNode(NodeToDelete, NodeToDelete->RChild);
-        NodeToDelete->RChild = nullptr;
+        Tasks.push_back(ExportTask{A, true, 0, 0});
+        return;
     }
 
-    delete NodeToDelete;
-    NodeToDelete = nullptr;
+    CollectExportTasks(A->LChild, Depth - 1, Tasks);
+    Tasks.push_back(ExportTask{A, false, 0, 0});
+    CollectExportTasks(A->RChild, Depth - 1, Tasks);
 }
 
-template<class Type>
-void RedBlackTree<Type>::ReplaceNode(Node<Type>* ParentNode, Node<Type>* ChildNode)
+template<class Type, class Summary, class Allocator>
+template<class WorkFunction>
+void RedBlackTree<Type, Summary, Allocator>::ForEachParallel(std::size_t Count, unsigned NumThreads, WorkFunction Work)
 {
-    ChildNode->Parent = ParentNode->Parent;
-    if (!(ParentNode->Parent))
+    std::atomic<std::size_t> NextItem(0);
+    auto Worker = [&NextItem, Count, &Work]()
     {
-        this->Root = ChildNode;
-    }
-    else if ((ParentNode->Parent->LChild) && *(ParentNode->Parent->LChild) == *ParentNode)
+        for (std::size_t i = NextItem++; i < Count; i = NextItem++)
+        {
+            Work(i);
+        }
+    };
+
+    std::vector<std::thread> Helpers;
+    for (unsigned t = 1; t < NumThreads && t < Count; t++)
     {
-        ParentNode->Parent->LChild = ChildNode;
+        Helpers.emplace_back(Worker);
     }
-    else
+    Worker();
+    for (std::thread &Helper : Helpers)
     {
-        ParentNode->Parent->RChild = ChildNode;
+        Helper.join();
     }
 }
 
-template<class Type>
-Node<Type>* RedBlackTree<Type>::FindMinIntl(Node<Type>* StartNode) const
+template<class Type, class Summary, class Allocator>
+void RedBlackTree<Type, Summary, Allocator>::InOrderItl(Node<Type, Summary>* a) const
 {
-    Node<Type>* MinNode = nullptr;
-    Node<Type>* CurrNode = StartNode;
+    if (!a)
+    {
+        return;
+    }
 
-    while (CurrNode)
+    InOrderItl(a->LChild);
+    std::cout << a->Key << " ";
+    InOrderItl(a->RChild);
+}
+
+template<class Type, class Summary, class Allocator>
+void RedBlackTree<Type, Summary, Allocator>::PreOrderItl(Node<Type, Summary>* a) const
+{
+    if (!a)
     {
-        MinNode = CurrNode;
-        CurrNode = CurrNode->LChild;
+        return;
     }
-    CurrNode = nullptr;
-    return MinNode;
+
+    std::cout << a->Key << " and is colour " << (a->Colour == Node<Type, Summary>::NodeColour::Black ? "black" : "red")
+              << " and has parent ";
+    ((a->Parent) ? std::cout << a->Parent->Key : std::cout << "null");
+    std::cout << std::endl;
+    PreOrderItl(a->LChild);
+    PreOrderItl(a->RChild);
 }
 
-template<class Type>
-Node<Type>* RedBlackTree<Type>::FindMaxIntl(Node<Type>* StartNode) const
+template<class Type, class Summary, class Allocator>
+void RedBlackTree<Type, Summary, Allocator>::UpdatePath(Node<Type, Summary>* StartNode)
+{
+    Algorithms::UpdatePath(StartNode);
+}
+
+template<class Type, class Summary, class Allocator>
+typename Summary::Value RedBlackTree<Type, Summary, Allocator>::SummaryOf(Node<Type, Summary>* SubtreeRoot) const
 {
-    Node<Type>* MaxNode = nullptr;
-    Node<Type>* CurrNode = StartNode;
+    return SubtreeRoot ? SubtreeRoot->SubtreeSummary : Summary::Identity();
+}
 
-    while (CurrNode)
+template<class Type, class Summary, class Allocator>
+int RedBlackTree<Type, Summary, Allocator>::SubtreeBlackHeight(Node<Type, Summary>* SubtreeRoot) const
+{
+    int BlackHeight = 0;
+    for (Node<Type, Summary>* CurrNode = SubtreeRoot; CurrNode; CurrNode = CurrNode->LChild)
     {
-        MaxNode = CurrNode;
-        CurrNode = CurrNode->RChild;
+        if (CurrNode->Colour == Node<Type, Summary>::NodeColour::Black)
+        {
+            BlackHeight++;
+        }
     }
-    CurrNode = nullptr;
-    return MaxNode;
+    return BlackHeight;
 }
 
-template<class Type>
-int RedBlackTree<Type>::GetHeightIntl(Node<Type>* Curr) const
+template<class Type, class Summary, class Allocator>
+Node<Type, Summary>* RedBlackTree<Type, Summary, Allocator>::Join(Node<Type, Summary>* Left, Node<Type, Summary>* Pivot,
+                                                       Node<Type, Summary>* Right)
 {
-    if (!Curr)
+    //the root of a tree can always be recoloured black, which keeps the black height comparisons below simple
+    if (Left)
     {
-        return -1;
+        Left->Colour = Node<Type, Summary>::NodeColour::Black;
+    }
+    if (Right)
+    {
+        Right->Colour = Node<Type, Summary>::NodeColour::Black;
     }
 
-    return std::max(GetHeightIntl(Curr->LChild), GetHeightIntl(Curr->RChild)) + 1;
+    int LeftHeight = SubtreeBlackHeight(Left);
+    int RightHeight = SubtreeBlackHeight(Right);
+
+    Pivot->Parent = nullptr;
+
+    //equal black heights: the pivot becomes a black root over both trees
+    if (LeftHeight == RightHeight)
+    {
+        Pivot->LChild = Left;
+        Pivot->RChild = Right;
+        if (Left)
+        {
+            Left->Parent = Pivot;
+        }
+        if (Right)
+        {
+            Right->Parent = Pivot;
+        }
+        Pivot->Colour = Node<Type, Summary>::NodeColour::Black;
+        SummaryUpdate<Summary>::Update(Pivot);
+
+        Root = Pivot;
+        return Root;
+    }
+
+    //otherwise walk down the inner spine of the taller tree to a black node as high as the shorter tree,
+    //and hang the pivot there as a red node, which is then fixed up like a regular insertion
+    bool LeftTaller = RightHeight < LeftHeight;
+    Node<Type, Summary>* CurrNode = LeftTaller ? Left : Right;
+    Node<Type, Summary>* Par = nullptr;
+    int CurrHeight = LeftTaller ? LeftHeight : RightHeight;
+    int TargetHeight = LeftTaller ? RightHeight : LeftHeight;
+
+    while (!(Node<Type, Summary>::TestColourBlack(CurrNode) && CurrHeight == TargetHeight))
+    {
+        if (CurrNode->Colour == Node<Type, Summary>::NodeColour::Black)
+        {
+            CurrHeight--;
+        }
+        Par = CurrNode;
+        CurrNode = LeftTaller ? CurrNode->RChild : CurrNode->LChild;
+    }
+
+    Root = LeftTaller ? Left : Right;
+    Node<Type, Summary>* Shorter = LeftTaller ? Right : Left;
+
+    if (LeftTaller)
+    {
+        Pivot->LChild = CurrNode;
+        Pivot->RChild = Shorter;
+        Par->RChild = Pivot;
+    }
+    else
+    {
+        Pivot->LChild = Shorter;
+        Pivot->RChild = CurrNode;
+        Par->LChild = Pivot;
+    }
+
+    if (CurrNode)
+    {
+        CurrNode->Parent = Pivot;
+    }
+    if (Shorter)
+    {
+        Shorter->Parent = Pivot;
+    }
+
+    Pivot->Parent = Par;
+    Pivot->Colour = Node<Type, Summary>::NodeColour::Red;
+
+    UpdatePath(Pivot);
+    TreeFixInsertion(Pivot);
+
+    return Root;
 }
 
-template<class Type>
-int RedBlackTree<Type>::GetBlackHeightIntl(Node<Type>* Curr) const
+template<class Type, class Summary, class Allocator>
+void RedBlackTree<Type, Summary, Allocator>::Split(Node<Type, Summary>* A, const Type SplitKey, bool KeepEqualLeft,
+                                        Node<Type, Summary>*& Left, Node<Type, Summary>*& Right)
 {
-    if (!Curr)
+    if (!A)
     {
-        return 0;
+        Left = Right = nullptr;
+        return;
     }
 
-    if (Curr->Colour == Node<Type>::NodeColour::Black)
+    Node<Type, Summary>* LeftSubtree = A->LChild;
+    Node<Type, Summary>* RightSubtree = A->RChild;
+
+    A->Parent = A->LChild = A->RChild = nullptr;
+    if (LeftSubtree)
     {
-        return GetHeightIntl(Curr->LChild) + 1;
+        LeftSubtree->Parent = nullptr;
+    }
+    if (RightSubtree)
+    {
+        RightSubtree->Parent = nullptr;
+    }
+
+    //A belongs to the left tree, so only its right subtree still needs splitting
+    if (A->Key < SplitKey || (KeepEqualLeft && A->Key == SplitKey))
+    {
+        Node<Type, Summary>* SplitLeft;
+        Split(RightSubtree, SplitKey, KeepEqualLeft, SplitLeft, Right);
+        Left = Join(LeftSubtree, A, SplitLeft);
     }
     else
     {
-        return GetHeightIntl(Curr->LChild);
+        Node<Type, Summary>* SplitRight;
+        Split(LeftSubtree, SplitKey, KeepEqualLeft, Left, SplitRight);
+        Right = Join(SplitRight, A, RightSubtree);
     }
 }
 
-template<class Type>
-void RedBlackTree<Type>::InOrderFill(Node<Type>* A, Type* Arr, int &CurrElement) const
+template<class Type, class Summary, class Allocator>
+std::size_t RedBlackTree<Type, Summary, Allocator>::DeleteSubtree(Node<Type, Summary>* A)
 {
     if (!A)
     {
-        return;
+        return 0;
     }
 
-    InOrderFill(A->LChild, Arr, CurrElement);
-    Arr[CurrElement] = A->Key;
-    CurrElement++;
-    InOrderFill(A->RChild, Arr, CurrElement);
+    std::size_t Freed = DeleteSubtree(A->LChild) + DeleteSubtree(A->RChild) + 1;
+    RemovalEpoch++;
+
+    KeyHeapBytes -= KeyMemoryTraits<Type>::HeapBytes(A->Key);
+    DestroyNode(A);
+
+    return Freed;
 }
 
-template<class Type>
-void RedBlackTree<Type>::InOrderItl(Node<Type>* a) const
+template<class Type, class Summary, class Allocator>
+std::size_t RedBlackTree<Type, Summary, Allocator>::CountSubtree(Node<Type, Summary>* A) const
 {
-    if (!a)
+    if (!A)
+    {
+        return 0;
+    }
+
+    return CountSubtree(A->LChild) + CountSubtree(A->RChild) + 1;
+}
+
+template<class Type, class Summary, class Allocator>
+std::size_t RedBlackTree<Type, Summary, Allocator>::SubtreeKeyHeapBytes(Node<Type, Summary>* A) const
+{
+    if (!A)
+    {
+        return 0;
+    }
+
+    return SubtreeKeyHeapBytes(A->LChild) + SubtreeKeyHeapBytes(A->RChild) + KeyMemoryTraits<Type>::HeapBytes(A->Key);
+}
+
+template<class Type, class Summary, class Allocator>
+void RedBlackTree<Type, Summary, Allocator>::SplitOffIntl(const Type SplitKey, RedBlackTree &Receiver, bool MoveUpper)
+{
+    if (Size == 0)
     {
         return;
     }
+    CheckSameAllocator(Receiver);
+
+    Node<Type, Summary>* Lower;
+    Node<Type, Summary>* Upper;
+    Split(Root, SplitKey, false, Lower, Upper);
+
+    //only the moved part is counted, so the cost stays proportional to the number of keys moved
+    Node<Type, Summary>* Moved = MoveUpper ? Upper : Lower;
+    std::size_t MovedCount = CountSubtree(Moved);
+    std::size_t MovedKeyHeapBytes = SubtreeKeyHeapBytes(Moved);
+
+    Root = MoveUpper ? Lower : Upper;
+    Size -= MovedCount;
+    RemovalEpoch++;
+    KeyHeapBytes -= MovedKeyHeapBytes;
+    ResetExtremes();
+    Receiver.Root = Moved;
+    Receiver.Size = MovedCount;
+    Receiver.KeyHeapBytes = MovedKeyHeapBytes;
+    Receiver.ResetExtremes();
+}
 
-    InOrderItl(a->LChild);
-    std::cout << a->Key << " ";
-    InOrderItl(a->RChild);
+template<class Type, class Summary, class Allocator>
+void RedBlackTree<Type, Summary, Allocator>::EraseNode(Node<Type, Summary>* NodeToDelete)
+{
+    UnlinkNode(NodeToDelete);
+    DestroyNode(NodeToDelete);
 }
 
-template<class Type>
-void RedBlackTree<Type>::PreOrderItl(Node<Type>* a) const
+template<class Type, class Summary, class Allocator>
+void RedBlackTree<Type, Summary, Allocator>::UnlinkNode(Node<Type, Summary>* NodeToDelete)
 {
-    if (!a)
+    //the leftmost node has no left child, so the next node in order is the smallest in its right subtree if it has
+    //one, or its parent otherwise; the same holds for the rightmost node, mirrored
+    if (NodeToDelete == Leftmost)
+    {
+        Leftmost = NodeToDelete->RChild ? FindMinIntl(NodeToDelete->RChild) : NodeToDelete->Parent;
+    }
+    if (NodeToDelete == Rightmost)
+    {
+        Rightmost = NodeToDelete->LChild ? FindMaxIntl(NodeToDelete->LChild) : NodeToDelete->Parent;
+    }
+
+    //a node with two children is replaced by relinking its successor into its place, so no key moves;
+    //rebalancing works through a null replacement by tracking its parent, so nothing is allocated
+    Algorithms::Erase(NodeToDelete, Root);
+    NodeToDelete->Parent = NodeToDelete->LChild = NodeToDelete->RChild = nullptr;
+    KeyHeapBytes -= KeyMemoryTraits<Type>::HeapBytes(NodeToDelete->Key);
+    Size--;
+    RemovalEpoch++;
+}
+
+template<class Type, class Summary, class Allocator>
+void RedBlackTree<Type, Summary, Allocator>::LinkNode(Node<Type, Summary>* NewNode, Node<Type, Summary>* Par)
+{
+    NewNode->Parent = Par;
+    NewNode->LChild = NewNode->RChild = nullptr;
+    KeyHeapBytes += KeyMemoryTraits<Type>::HeapBytes(NewNode->Key);
+    Size++;
+
+    //if the tree is empty, then the node becomes the root and is coloured black
+    if (!Par)
     {
+        Root = Leftmost = Rightmost = NewNode;
+        Root->Colour = Node<Type, Summary>::NodeColour::Black;
+        UpdatePath(Root);
         return;
     }
 
-    std::cout << a->Key << " and is colour " << (a->Colour == Node<Type>::NodeColour::Black ? "black" : "red")
-              << " and has parent ";
-    ((a->Parent) ? std::cout << a->Parent->Key : std::cout << "null");
-    std::cout << std::endl;
-    PreOrderItl(a->LChild);
-    PreOrderItl(a->RChild);
+    if (NewNode->Key < Par->Key)
+    {
+        Par->LChild = NewNode;
+    }
+    else
+    {
+        Par->RChild = NewNode;
+    }
+    NewNode->Colour = Node<Type, Summary>::NodeColour::Red;
+
+    //a new extreme can only hang off the old one, on its outer side
+    if (Par == Leftmost && NewNode == Par->LChild)
+    {
+        Leftmost = NewNode;
+    }
+    else if (Par == Rightmost && NewNode == Par->RChild)
+    {
+        Rightmost = NewNode;
+    }
+
+    UpdatePath(NewNode);
+    TreeFixInsertion(NewNode);
+}
+
+template<class Type, class Summary, class Allocator>
+Node<Type, Summary>* RedBlackTree<Type, Summary, Allocator>::CreateNode(const Type &NewKey)
+{
+    Node<Type, Summary>* NewNode = NodeAllocatorTraits::allocate(NodeAllocator, 1);
+    try
+    {
+        NodeAllocatorTraits::construct(NodeAllocator, NewNode, NewKey);
+    }
+    catch (...)
+    {
+        NodeAllocatorTraits::deallocate(NodeAllocator, NewNode, 1);
+        throw;
+    }
+
+    //the allocator hands freed nodes out again first
+    if (FreedNodes > 0)
+    {
+        FreedNodes--;
+    }
+    return NewNode;
+}
+
+template<class Type, class Summary, class Allocator>
+void RedBlackTree<Type, Summary, Allocator>::DestroyNode(Node<Type, Summary>* OldNode)
+{
+    NodeAllocatorTraits::destroy(NodeAllocator, OldNode);
+    NodeAllocatorTraits::deallocate(NodeAllocator, OldNode, 1);
+    FreedNodes++;
+}
+
+template<class Type, class Summary, class Allocator>
+void RedBlackTree<Type, Summary, Allocator>::CheckSameAllocator(const RedBlackTree &Other) const
+{
+    if (!(NodeAllocator == Other.NodeAllocator))
+    {
+        throw std::invalid_argument("RedBlackTrees can only exchange nodes when their allocators compare equal");
+    }
+}
+
+template<class Type, class Summary, class Allocator>
+std::size_t RedBlackTree<Type, Summary, Allocator>::AllocationBytes(std::size_t Requested)
+{
+    const std::size_t Word = sizeof(std::size_t);
+    const std::size_t Alignment = 2 * sizeof(void*);
+    return std::max(4 * Word, (Requested + Word + Alignment - 1) / Alignment * Alignment);
+}
+
+template<class Type, class Summary, class Allocator>
+Node<Type, Summary>* RedBlackTree<Type, Summary, Allocator>::AllocateNode(const Type &NewKey)
+{
+    Node<Type, Summary>* NewNode = CreateNode(NewKey);
+    std::size_t NewKeyHeapBytes = KeyMemoryTraits<Type>::HeapBytes(NewNode->Key);
+
+    std::size_t NewBytes = AllocationBytes(sizeof(Node<Type, Summary>)) + NewKeyHeapBytes;
+    if (MemoryBudget != 0 && GetMemoryUsage().TotalBytes() + NewBytes > MemoryBudget)
+    {
+        DestroyNode(NewNode);
+        throw std::length_error("Insert would exceed the memory budget of the RedBlackTree");
+    }
+
+    return NewNode;
+}
+
+template<class Type, class Summary, class Allocator>
+void RedBlackTree<Type, Summary, Allocator>::ResetExtremes()
+{
+    Leftmost = FindMinIntl(Root);
+    Rightmost = FindMaxIntl(Root);
+}
+
+template<class Type, class Summary, class Allocator>
+Node<Type, Summary>* RedBlackTree<Type, Summary, Allocator>::BuildBalanced(const Type* Keys, std::size_t Count,
+                                                                           int Depth, int RedDepth)
+{
+    if (Count == 0)
+    {
+        return nullptr;
+    }
+
+    std::size_t Mid = Count / 2;
+    Node<Type, Summary>* SubtreeRoot = CreateNode(Keys[Mid]);
+    KeyHeapBytes += KeyMemoryTraits<Type>::HeapBytes(SubtreeRoot->Key);
+    SubtreeRoot->Colour = (Depth == RedDepth) ? Node<Type, Summary>::NodeColour::Red
+                                              : Node<Type, Summary>::NodeColour::Black;
+
+    SubtreeRoot->LChild = BuildBalanced(Keys, Mid, Depth + 1, RedDepth);
+    SubtreeRoot->RChild = BuildBalanced(Keys + Mid + 1, Count - Mid - 1, Depth + 1, RedDepth);
+    if (SubtreeRoot->LChild)
+    {
+        SubtreeRoot->LChild->Parent = SubtreeRoot;
+    }
+    if (SubtreeRoot->RChild)
+    {
+        SubtreeRoot->RChild->Parent = SubtreeRoot;
+    }
+
+    //both children are complete by now, so the summary can be computed bottom up
+    SummaryUpdate<Summary>::Update(SubtreeRoot);
+    return SubtreeRoot;
+}
+
+template<class Type, class Summary, class Allocator>
+Node<Type, Summary>* RedBlackTree<Type, Summary, Allocator>::FloorIntl(const Type &Key, bool Inclusive) const
+{
+    Node<Type, Summary>* Best = nullptr;
+    Node<Type, Summary>* CurrNode = Root;
+    while (CurrNode)
+    {
+        //a node below the key is the best so far, and anything better lies to its right
+        if (Inclusive ? !(Key < CurrNode->Key) : CurrNode->Key < Key)
+        {
+            Best = CurrNode;
+            CurrNode = CurrNode->RChild;
+        }
+        else
+        {
+            CurrNode = CurrNode->LChild;
+        }
+    }
+    return Best;
+}
+
+template<class Type, class Summary, class Allocator>
+Node<Type, Summary>* RedBlackTree<Type, Summary, Allocator>::CeilingIntl(const Type &Key, bool Inclusive) const
+{
+    Node<Type, Summary>* Best = nullptr;
+    Node<Type, Summary>* CurrNode = Root;
+    while (CurrNode)
+    {
+        if (Inclusive ? !(CurrNode->Key < Key) : Key < CurrNode->Key)
+        {
+            Best = CurrNode;
+            CurrNode = CurrNode->LChild;
+        }
+        else
+        {
+            CurrNode = CurrNode->RChild;
+        }
+    }
+    return Best;
+}
+
+template<class Type, class Summary, class Allocator>
+Node<Type, Summary>* RedBlackTree<Type, Summary, Allocator>::NextNode(Node<Type, Summary>* CurrNode)
+{
+    if (CurrNode->RChild)
+    {
+        CurrNode = CurrNode->RChild;
+        while (CurrNode->LChild)
+        {
+            CurrNode = CurrNode->LChild;
+        }
+        return CurrNode;
+    }
+
+    while (CurrNode->Parent && CurrNode->Parent->RChild == CurrNode)
+    {
+        CurrNode = CurrNode->Parent;
+    }
+    return CurrNode->Parent;
+}
+
+template<class Type, class Summary, class Allocator>
+Node<Type, Summary>* RedBlackTree<Type, Summary, Allocator>::PrevNode(Node<Type, Summary>* CurrNode)
+{
+    if (CurrNode->LChild)
+    {
+        CurrNode = CurrNode->LChild;
+        while (CurrNode->RChild)
+        {
+            CurrNode = CurrNode->RChild;
+        }
+        return CurrNode;
+    }
+
+    while (CurrNode->Parent && CurrNode->Parent->LChild == CurrNode)
+    {
+        CurrNode = CurrNode->Parent;
+    }
+    return CurrNode->Parent;
 }
 
 #endif //REDBLACKTREE_REDBLACKTREE_H
@@ -0,0 +1,627 @@
+#ifndef REDBLACKTREE_SHARDEDREDBLACKTREE_H
+#define REDBLACKTREE_SHARDEDREDBLACKTREE_H
+
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "RedBlackTree.h"
+
+/**
+ * Ordered set that splits the key space into ranges, each owned by its own red black tree behind its own lock
+ * Point operations only lock the shard owning their key, so threads working on different ranges never contend
+ * Operations spanning several shards lock every shard they touch in ascending order, so they see one consistent state
+ *
+ * The boundaries between shards can be moved while the tree is in use, either explicitly with MoveBoundary
+ * or by RebalanceShards when the key distribution drifts; keys change shards by splitting and joining the shard
+ * trees, so no node is copied
+ *
+ * Threads route through an immutable table of the boundaries, replaced as a whole whenever a boundary moves. Routing
+ * threads announce the table version they started in, in one of ReaderSlotCount slots, and a boundary move waits until
+ * no thread is left routing in the version before its own before it frees the table it replaced, so only the current
+ * table is ever kept. Routing only reads the table and takes no lock meanwhile, so the wait is short
+ *
+ * Assumes that any templated type is default constructible and has valid comparison operators
+ */
+template<class Type, class Summary = NoSummary>
+class ShardedRedBlackTree
+{
+public:
+    /**
+     * @param Boundaries Keys at which one shard ends and the next begins, in strictly ascending order
+     *                   Shard i holds the keys in [Boundaries[i - 1], Boundaries[i]); the first and last shards are
+     *                   unbounded below and above
+     */
+    explicit ShardedRedBlackTree(const std::vector<Type> &Boundaries);
+
+    ~ShardedRedBlackTree();
+
+    /**
+     * Inserts the given key into the tree, if it is not already in the tree
+     * @param NewKey The new key to insert into the tree
+     */
+    void Insert(const Type NewKey);
+
+    /**
+     * Removes the given key from the tree, if it exists in the tree
+     * @param KeyToDelete The key to delete from the tree
+     */
+    void Delete(const Type KeyToDelete);
+
+    /**
+     * Finds the key passed as parameter in the tree, if it exists
+     * @param KeyToFind The key to search for in the tree
+     * @return true if key is in the tree, false otherwise
+     */
+    bool Find(const Type KeyToFind) const;
+
+    /**
+     * Finds the smallest key in the tree
+     * @return The smallest key in the tree
+     * @throws std::out_of_range if the tree is empty
+     */
+    Type FindMin() const;
+
+    /**
+     * Finds the largest key in the tree
+     * @return The largest key in the tree
+     * @throws std::out_of_range if the tree is empty
+     */
+    Type FindMax() const;
+
+    /**
+     * Removes every key in the closed range [Low, High] from every shard the range overlaps
+     * @param Low Smallest key to remove
+     * @param High Largest key to remove
+     * @return The number of keys removed
+     */
+    std::size_t EraseRange(const Type Low, const Type High);
+
+    /**
+     * Combines the summaries of every key in the closed range [Low, High], in sorted order, across shards
+     * Only available when the tree keeps a summary
+     * @param Low Smallest key to include
+     * @param High Largest key to include
+     * @return The combined summary, or the summary identity if no key lies in the range
+     */
+    typename Summary::Value Aggregate(const Type Low, const Type High) const;
+
+    /***
+     * Makes and returns a sorted array of all elements in the tree
+     * @return A pointer to the first element of the newly created array
+     */
+    Type* MakeArray() const;
+
+    /** Getter function to retrieve size of the tree; exact whenever no update is running */
+    std::size_t GetSize() const;
+
+    /** Getter function to retrieve the number of shards */
+    std::size_t GetShardCount() const;
+
+    /** Getter function to retrieve the number of keys currently held by one shard */
+    std::size_t GetShardSize(std::size_t ShardIndex) const;
+
+    /**
+     * Moves the boundary between shard BoundaryIndex and the shard after it, handing keys over between them
+     * @param BoundaryIndex Which boundary to move
+     * @param NewBoundary The new first key of the upper shard; must lie strictly between the neighbouring boundaries
+     * @return false if the new boundary would not keep the boundaries strictly ascending, in which case nothing moves
+     */
+    bool MoveBoundary(std::size_t BoundaryIndex, const Type NewBoundary);
+
+    /**
+     * Moves the boundaries so that every shard holds about the same number of keys
+     * Excess keys are first pushed down shard by shard towards the first shard, then pushed back up, so each step only
+     * locks the two shards around one boundary and the rest of the tree stays usable
+     * Costs O(n) in the worst case, so it is meant to be run periodically as the key distribution drifts
+     * @return The number of boundary moves made
+     */
+    std::size_t RebalanceShards();
+
+private:
+    /** A range of the key space, its red black tree and the lock guarding both */
+    struct Shard
+    {
+        /** Does this shard own the key passed as parameter? */
+        bool Covers(const Type &Key) const
+        {
+            return (!HasLow || !(Key < Low)) && (!HasHigh || Key < High);
+        }
+
+        RedBlackTree<Type, Summary> Tree;
+        mutable std::mutex Lock;
+
+        /** Bounds of the keys owned by this shard, [Low, High); only read or changed with Lock held */
+        Type Low;
+        Type High;
+        bool HasLow;
+        bool HasHigh;
+    };
+
+    typedef std::unique_lock<std::mutex> ShardLock;
+
+    /** The number of slots routing threads announce their table version in */
+    static const std::size_t ReaderSlotCount = 64;
+
+    /** The number of threads routing through an even and an odd table version; on its own cache line */
+    struct alignas(64) ReaderSlot
+    {
+        std::atomic<std::size_t> Active[2];
+    };
+
+    /**
+     * Announces the current table version in the calling thread's slot for as long as it is in scope, which keeps the
+     * boundary table it hands out alive
+     * Must not be held while waiting for a shard lock, since boundary moves wait for it with shard locks held
+     */
+    class RouteGuard
+    {
+    public:
+        explicit RouteGuard(const ShardedRedBlackTree &Tree);
+        ~RouteGuard();
+
+        RouteGuard(const RouteGuard &) = delete;
+        RouteGuard &operator=(const RouteGuard &) = delete;
+
+        /** The boundary table to route through */
+        const std::vector<Type> &GetTable() const;
+
+    private:
+        std::atomic<std::size_t>* Counter;
+        const std::vector<Type>* Table;
+    };
+
+    /**
+     * Finds and locks the shard owning the key passed as parameter
+     * The boundary table is only a hint; the owner is confirmed against the shard's own bounds once it is locked
+     * @param Key The key whose shard is needed
+     * @param Owner Set to the shard owning the key
+     * @return The lock held on the owning shard
+     */
+    ShardLock LockOwner(const Type &Key, Shard*& Owner) const;
+
+    /**
+     * Locks, in ascending order, every shard overlapping the closed range [Low, High]
+     * While they are held, none of the boundaries between them can move
+     * @param Low Smallest key of the range
+     * @param High Largest key of the range
+     * @param Locks Filled with the locks held
+     * @return Index of the first shard locked
+     */
+    std::size_t LockRange(const Type &Low, const Type &High, std::vector<ShardLock> &Locks) const;
+
+    /**
+     * Moves a boundary and the keys crossing it, then publishes a new boundary table and frees the old one once no
+     * thread routes through it any more
+     * Assumes that BoundaryLock and the locks of both shards around the boundary are held
+     * @param BoundaryIndex Which boundary to move
+     * @param NewBoundary The new first key of the upper shard
+     */
+    void ShiftBoundary(std::size_t BoundaryIndex, const Type &NewBoundary);
+
+    /**
+     * Hands the keys of a shard beyond the first Target of them over to its neighbour across a boundary
+     * Assumes that BoundaryLock is held
+     * @param BoundaryIndex The boundary to move
+     * @param Target How many keys the shard should keep
+     * @param FromLower Should the lower shard give its largest keys away, rather than the upper shard its smallest?
+     * @return true if the boundary moved
+     */
+    bool MoveExcess(std::size_t BoundaryIndex, std::size_t Target, bool FromLower);
+
+    /** The slot the calling thread announces its table version in; threads are numbered as they first use a tree */
+    static std::size_t HomeSlot();
+
+    /** Every shard, in ascending key order */
+    std::unique_ptr<Shard[]> Shards;
+
+    /** The number of shards */
+    std::size_t ShardCount;
+
+    /** Routing table of the current boundaries; never changed once published, so it can be read without a lock */
+    std::atomic<const std::vector<Type>*> Boundaries;
+
+    /** Version of the routing table; moves forward by one with every table published */
+    std::atomic<std::uint64_t> TableVersion;
+
+    mutable ReaderSlot Readers[ReaderSlotCount];
+
+    /** Serializes boundary moves */
+    std::mutex BoundaryLock;
+
+    /** The current number of keys stored in the tree */
+    std::atomic<std::size_t> Size;
+
+};  //end ShardedRedBlackTree definition
+
+
+
+template<class Type, class Summary>
+ShardedRedBlackTree<Type, Summary>::ShardedRedBlackTree(const std::vector<Type> &Boundaries)
+{
+    ShardCount = Boundaries.size() + 1;
+    Shards.reset(new Shard[ShardCount]);
+    for (std::size_t i = 0; i < ShardCount; i++)
+    {
+        Shards[i].HasLow = i > 0;
+        Shards[i].HasHigh = i + 1 < ShardCount;
+        if (Shards[i].HasLow)
+        {
+            Shards[i].Low = Boundaries[i - 1];
+        }
+        if (Shards[i].HasHigh)
+        {
+            Shards[i].High = Boundaries[i];
+        }
+    }
+
+    this->Boundaries.store(new std::vector<Type>(Boundaries));
+    TableVersion.store(0);
+    for (ReaderSlot &Slot : Readers)
+    {
+        for (std::atomic<std::size_t> &Count : Slot.Active)
+        {
+            Count.store(0);
+        }
+    }
+    Size.store(0);
+}
+
+template<class Type, class Summary>
+ShardedRedBlackTree<Type, Summary>::~ShardedRedBlackTree()
+{
+    delete Boundaries.load();
+}
+
+template<class Type, class Summary>
+void ShardedRedBlackTree<Type, Summary>::Insert(const Type NewKey)
+{
+    Shard* Owner;
+    ShardLock Guard = LockOwner(NewKey, Owner);
+
+    std::size_t OldSize = Owner->Tree.GetSize();
+    Owner->Tree.Insert(NewKey);
+    Size.fetch_add(Owner->Tree.GetSize() - OldSize, std::memory_order_relaxed);
+}
+
+template<class Type, class Summary>
+void ShardedRedBlackTree<Type, Summary>::Delete(const Type KeyToDelete)
+{
+    Shard* Owner;
+    ShardLock Guard = LockOwner(KeyToDelete, Owner);
+
+    std::size_t OldSize = Owner->Tree.GetSize();
+    Owner->Tree.Delete(KeyToDelete);
+    Size.fetch_sub(OldSize - Owner->Tree.GetSize(), std::memory_order_relaxed);
+}
+
+template<class Type, class Summary>
+bool ShardedRedBlackTree<Type, Summary>::Find(const Type KeyToFind) const
+{
+    Shard* Owner;
+    ShardLock Guard = LockOwner(KeyToFind, Owner);
+
+    return Owner->Tree.Find(KeyToFind);
+}
+
+template<class Type, class Summary>
+Type ShardedRedBlackTree<Type, Summary>::FindMin() const
+{
+    //every shard below the first non-empty one stays locked, so none of them can gain a smaller key meanwhile
+    std::vector<ShardLock> Locks;
+    std::size_t i = 0;
+    for (; i + 1 < ShardCount; i++)
+    {
+        Locks.emplace_back(Shards[i].Lock);
+        if (Shards[i].Tree.GetSize() > 0)
+        {
+            return Shards[i].Tree.FindMin();
+        }
+    }
+
+    Locks.emplace_back(Shards[i].Lock);
+    return Shards[i].Tree.FindMin();
+}
+
+template<class Type, class Summary>
+Type ShardedRedBlackTree<Type, Summary>::FindMax() const
+{
+    //shards are always locked in ascending order, so every shard is locked before looking from the top
+    std::vector<ShardLock> Locks;
+    for (std::size_t i = 0; i < ShardCount; i++)
+    {
+        Locks.emplace_back(Shards[i].Lock);
+    }
+
+    std::size_t i = ShardCount - 1;
+    while (i > 0 && Shards[i].Tree.GetSize() == 0)
+    {
+        i--;
+    }
+    return Shards[i].Tree.FindMax();
+}
+
+template<class Type, class Summary>
+std::size_t ShardedRedBlackTree<Type, Summary>::EraseRange(const Type Low, const Type High)
+{
+    if (High < Low)
+    {
+        return 0;
+    }
+
+    std::vector<ShardLock> Locks;
+    std::size_t First = LockRange(Low, High, Locks);
+
+    std::size_t Erased = 0;
+    for (std::size_t i = First; i < First + Locks.size(); i++)
+    {
+        Erased += Shards[i].Tree.EraseRange(Low, High);
+    }
+
+    Size.fetch_sub(Erased, std::memory_order_relaxed);
+    return Erased;
+}
+
+template<class Type, class Summary>
+typename Summary::Value ShardedRedBlackTree<Type, Summary>::Aggregate(const Type Low, const Type High) const
+{
+    if (High < Low)
+    {
+        return Summary::Identity();
+    }
+
+    std::vector<ShardLock> Locks;
+    std::size_t First = LockRange(Low, High, Locks);
+
+    typename Summary::Value Result = Summary::Identity();
+    for (std::size_t i = First; i < First + Locks.size(); i++)
+    {
+        Result = Summary::Combine(Result, Shards[i].Tree.Aggregate(Low, High));
+    }
+    return Result;
+}
+
+template<class Type, class Summary>
+Type* ShardedRedBlackTree<Type, Summary>::MakeArray() const
+{
+    std::vector<ShardLock> Locks;
+    std::size_t Total = 0;
+    for (std::size_t i = 0; i < ShardCount; i++)
+    {
+        Locks.emplace_back(Shards[i].Lock);
+        Total += Shards[i].Tree.GetSize();
+    }
+
+    //the shards hold ascending ranges, so their sorted arrays simply follow each other
+    Type* Arr = new Type[Total];
+    std::size_t x = 0;
+    for (std::size_t i = 0; i < ShardCount; i++)
+    {
+        Type* ShardKeys = Shards[i].Tree.MakeArray();
+        std::copy(ShardKeys, ShardKeys + Shards[i].Tree.GetSize(), Arr + x);
+        x += Shards[i].Tree.GetSize();
+        delete[] ShardKeys;
+    }
+    return Arr;
+}
+
+template<class Type, class Summary>
+std::size_t ShardedRedBlackTree<Type, Summary>::GetSize() const
+{
+    return Size.load(std::memory_order_relaxed);
+}
+
+template<class Type, class Summary>
+std::size_t ShardedRedBlackTree<Type, Summary>::GetShardCount() const
+{
+    return ShardCount;
+}
+
+template<class Type, class Summary>
+std::size_t ShardedRedBlackTree<Type, Summary>::GetShardSize(std::size_t ShardIndex) const
+{
+    ShardLock Guard(Shards[ShardIndex].Lock);
+    return Shards[ShardIndex].Tree.GetSize();
+}
+
+template<class Type, class Summary>
+bool ShardedRedBlackTree<Type, Summary>::MoveBoundary(std::size_t BoundaryIndex, const Type NewBoundary)
+{
+    if (BoundaryIndex + 1 >= ShardCount)
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> MoveGuard(BoundaryLock);
+    const std::vector<Type> &Current = *Boundaries.load(std::memory_order_acquire);
+    if ((BoundaryIndex > 0 && !(Current[BoundaryIndex - 1] < NewBoundary)) ||
+        (BoundaryIndex + 1 < Current.size() && !(NewBoundary < Current[BoundaryIndex + 1])))
+    {
+        return false;
+    }
+
+    ShardLock LowerGuard(Shards[BoundaryIndex].Lock);
+    ShardLock UpperGuard(Shards[BoundaryIndex + 1].Lock);
+    ShiftBoundary(BoundaryIndex, NewBoundary);
+    return true;
+}
+
+template<class Type, class Summary>
+std::size_t ShardedRedBlackTree<Type, Summary>::RebalanceShards()
+{
+    std::lock_guard<std::mutex> MoveGuard(BoundaryLock);
+
+    std::size_t Target = (GetSize() + ShardCount - 1) / ShardCount;
+    std::size_t Moved = 0;
+
+    //after pushing down, every shard but the first holds at most Target keys and the first holds the rest,
+    //which pushing back up then spreads over the shards short of Target
+    for (std::size_t i = ShardCount - 1; i > 0; i--)
+    {
+        Moved += MoveExcess(i - 1, Target, false);
+    }
+    for (std::size_t i = 0; i + 1 < ShardCount; i++)
+    {
+        Moved += MoveExcess(i, Target, true);
+    }
+    return Moved;
+}
+
+template<class Type, class Summary>
+typename ShardedRedBlackTree<Type, Summary>::ShardLock
+ShardedRedBlackTree<Type, Summary>::LockOwner(const Type &Key, Shard*& Owner) const
+{
+    while (true)
+    {
+        std::size_t Index;
+        {
+            RouteGuard Route(*this);
+            const std::vector<Type> &Table = Route.GetTable();
+            Index = std::upper_bound(Table.begin(), Table.end(), Key) - Table.begin();
+        }
+
+        ShardLock Guard(Shards[Index].Lock);
+        if (Shards[Index].Covers(Key))
+        {
+            Owner = &Shards[Index];
+            return Guard;
+        }
+    }
+}
+
+template<class Type, class Summary>
+std::size_t ShardedRedBlackTree<Type, Summary>::LockRange(const Type &Low, const Type &High,
+                                                          std::vector<ShardLock> &Locks) const
+{
+    while (true)
+    {
+        std::size_t First;
+        std::size_t Last;
+        {
+            RouteGuard Route(*this);
+            const std::vector<Type> &Table = Route.GetTable();
+            First = std::upper_bound(Table.begin(), Table.end(), Low) - Table.begin();
+            Last = std::upper_bound(Table.begin(), Table.end(), High) - Table.begin();
+        }
+
+        Locks.clear();
+        for (std::size_t i = First; i <= Last; i++)
+        {
+            Locks.emplace_back(Shards[i].Lock);
+        }
+
+        //holding both ends pins every boundary in between, so checking the ends confirms the whole table
+        if (Shards[First].Covers(Low) && Shards[Last].Covers(High))
+        {
+            return First;
+        }
+    }
+}
+
+template<class Type, class Summary>
+void ShardedRedBlackTree<Type, Summary>::ShiftBoundary(std::size_t BoundaryIndex, const Type &NewBoundary)
+{
+    Shard &Lower = Shards[BoundaryIndex];
+    Shard &Upper = Shards[BoundaryIndex + 1];
+
+    RedBlackTree<Type, Summary> Crossing;
+    if (NewBoundary < Upper.Low)
+    {
+        Lower.Tree.SplitOffAbove(NewBoundary, Crossing);
+        Upper.Tree.Concatenate(Crossing);
+    }
+    else
+    {
+        Upper.Tree.SplitOffBelow(NewBoundary, Crossing);
+        Lower.Tree.Concatenate(Crossing);
+    }
+    Lower.High = Upper.Low = NewBoundary;
+
+    const std::vector<Type>* OldTable = Boundaries.load(std::memory_order_relaxed);
+    std::vector<Type>* NewTable = new std::vector<Type>(*OldTable);
+    (*NewTable)[BoundaryIndex] = NewBoundary;
+    Boundaries.store(NewTable);
+
+    //a thread that announced the old version may still hold the old table, and one that announced the new version may
+    //only have found the new table; boundary moves are serialized, so no thread is left in any earlier version
+    std::uint64_t OldVersion = TableVersion.load();
+    TableVersion.store(OldVersion + 1);
+    for (const ReaderSlot &Slot : Readers)
+    {
+        while (Slot.Active[OldVersion % 2].load() != 0)
+        {
+            std::this_thread::yield();
+        }
+    }
+    delete OldTable;
+}
+
+template<class Type, class Summary>
+bool ShardedRedBlackTree<Type, Summary>::MoveExcess(std::size_t BoundaryIndex, std::size_t Target, bool FromLower)
+{
+    ShardLock LowerGuard(Shards[BoundaryIndex].Lock);
+    ShardLock UpperGuard(Shards[BoundaryIndex + 1].Lock);
+
+    //a little slack keeps small fluctuations from moving boundaries back and forth
+    Shard &Source = Shards[FromLower ? BoundaryIndex : BoundaryIndex + 1];
+    std::size_t SourceSize = Source.Tree.GetSize();
+    if (Target == 0 || SourceSize <= Target + Target / 8)
+    {
+        return false;
+    }
+
+    //the new boundary is a key of the source shard other than its smallest, so it stays strictly inside the range
+    //the two shards cover between them; it is walked to in place, so both shards are not held for a copy of the source
+    Type NewBoundary = Source.Tree.KeyAt(FromLower ? Target : SourceSize - Target);
+
+    ShiftBoundary(BoundaryIndex, NewBoundary);
+    return true;
+}
+
+template<class Type, class Summary>
+std::size_t ShardedRedBlackTree<Type, Summary>::HomeSlot()
+{
+    static std::atomic<std::size_t> NextThread(0);
+    thread_local std::size_t Home = NextThread.fetch_add(1, std::memory_order_relaxed) % ReaderSlotCount;
+    return Home;
+}
+
+template<class Type, class Summary>
+ShardedRedBlackTree<Type, Summary>::RouteGuard::RouteGuard(const ShardedRedBlackTree &Tree)
+{
+    ReaderSlot &Slot = Tree.Readers[HomeSlot()];
+
+    //the version is read again after announcing it: if it moved on in between, the boundary move may already have
+    //checked this slot, so the announcement is withdrawn and made again in the new version
+    while (true)
+    {
+        std::uint64_t Current = Tree.TableVersion.load();
+        Counter = &Slot.Active[Current % 2];
+        Counter->fetch_add(1);
+        if (Tree.TableVersion.load() == Current)
+        {
+            break;
+        }
+        Counter->fetch_sub(1);
+    }
+    Table = Tree.Boundaries.load();
+}
+
+template<class Type, class Summary>
+ShardedRedBlackTree<Type, Summary>::RouteGuard::~RouteGuard()
+{
+    Counter->fetch_sub(1, std::memory_order_release);
+}
+
+template<class Type, class Summary>
+const std::vector<Type> &ShardedRedBlackTree<Type, Summary>::RouteGuard::GetTable() const
+{
+    return *Table;
+}
+
+#endif //REDBLACKTREE_SHARDEDREDBLACKTREE_H
@@ -0,0 +1,287 @@
+#ifndef REDBLACKTREE_STATICREDBLACKTREE_H
+#define REDBLACKTREE_STATICREDBLACKTREE_H
+
+#include <iostream>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <initializer_list>
+#include <stdexcept>
+#include <type_traits>
+#include "IndexedRedBlackAlgorithms.h"
+
+/**
+ * Container for a single node of a static red black tree
+ * Links are positions in the tree's node array, stored in the smallest unsigned type that can address it
+ */
+template<class Type, class IndexType>
+struct StaticNode
+{
+    enum NodeColour : std::uint8_t
+    {
+        Red, Black
+    };
+
+    Type Key{};
+    IndexType Parent = 0;
+    IndexType RChild = 0;
+    IndexType LChild = 0;
+    NodeColour Colour = NodeColour::Red;
+
+};  //end StaticNode definition
+
+
+/**
+ * Red black tree of at most N keys, with every node stored in an array inside the tree object itself
+ * The tree never allocates, and every operation is constexpr, so a lookup table can be built entirely at compile time
+ * and costs nothing at startup; nodes refer to each other by index, and with small capacities the indices shrink to
+ * one or two bytes, so a whole table often fits in a few cache lines
+ * The linking and rebalancing is done by IndexedRedBlackAlgorithms, shared with IndexedRedBlackTree, over a fixed
+ * array instead of a vector; freed nodes go on a free list and are reused
+ * Obeys the same five properties as RedBlackTree
+ *
+ * Assumes that any templated type is a literal type, is default constructible and has valid comparison operators
+ */
+template<class Type, std::size_t N>
+class StaticRedBlackTree
+{
+public:
+    /** Type of the node links: the smallest unsigned type with a spare value for NullIndex */
+    typedef typename std::conditional<(N < UINT8_MAX), std::uint8_t,
+            typename std::conditional<(N < UINT16_MAX), std::uint16_t, std::uint32_t>::type>::type IndexType;
+
+    static_assert(N < UINT32_MAX, "StaticRedBlackTree cannot address more than 2^32 - 1 nodes");
+
+    /** Index used for a missing child or parent, the same way RedBlackTree uses nullptr */
+    static constexpr IndexType NullIndex = static_cast<IndexType>(-1);
+
+    constexpr StaticRedBlackTree();
+
+    /**
+     * Builds a tree holding the given keys; duplicates are only stored once
+     * Throws std::length_error if there are more than N distinct keys, which fails compilation in a constant expression
+     * @param Keys The keys to insert, in any order
+     */
+    constexpr StaticRedBlackTree(std::initializer_list<Type> Keys);
+
+    /**
+     * Inserts the given key into the tree, if it is not already in the tree
+     * Throws std::length_error if the tree already holds N keys
+     * @param NewKey The new key to insert into the tree
+     */
+    constexpr void Insert(const Type NewKey);
+
+    /**
+     * Removes the given key from the tree, if it exists in the tree
+     * @param KeyToDelete The key to delete from the tree
+     */
+    constexpr void Delete(const Type KeyToDelete);
+
+    /**
+     * Finds the key passed as parameter in the tree, if it exists
+     * @param KeyToFind The key to search for in the tree
+     * @return true if key is in the tree, false otherwise
+     */
+    constexpr bool Find(const Type KeyToFind) const;
+
+    /**
+     * Finds the smallest key in the tree
+     * @return The smallest key in the tree
+     * @throws std::out_of_range if the tree is empty
+     */
+    constexpr Type FindMin() const;
+
+    /**
+     * Finds the largest key in the tree
+     * @return The largest key in the tree
+     * @throws std::out_of_range if the tree is empty
+     */
+    constexpr Type FindMax() const;
+
+    /**
+     * Copies the smallest keys of the tree, in sorted order, into a buffer provided by the caller
+     * @param Buffer Where to write the keys
+     * @param Capacity How many keys the buffer can hold
+     * @return The number of keys written; less than the size of the tree if the buffer is too small
+     */
+    constexpr std::size_t ExportTo(Type* Buffer, std::size_t Capacity) const;
+
+    /** Getter function to retrieve size of the tree */
+    constexpr std::size_t GetSize() const;
+
+    /** The most keys the tree can hold */
+    static constexpr std::size_t GetCapacity();
+
+    constexpr int GetHeight() const;
+    constexpr int GetBlackHeight() const;
+
+private:
+    typedef StaticNode<Type, IndexType> NodeType;
+    typedef NodeType NodeStore[N > 0 ? N : 1];
+    typedef IndexedRedBlackAlgorithms<NodeStore, IndexType> Algorithms;
+
+    /**
+     * Takes a node from the free list, or the next never used node, and stores the key in it
+     * @param NewKey Key of the new node
+     * @return Index of the new node, which is red and unlinked
+     */
+    constexpr IndexType NewNode(const Type NewKey);
+
+    /** Every node, linked into the tree, on the free list, or never used yet */
+    NodeStore Nodes;
+
+    /** Root node in the tree */
+    IndexType Root;
+
+    /** First node on the free list; free nodes are chained through their right child index */
+    IndexType FreeList;
+
+    /** The number of nodes ever taken from the array; nodes from here on have never been used */
+    std::size_t Used;
+
+    /** The current number of nodes stored in the tree */
+    std::size_t Size;
+
+};  //end StaticRedBlackTree definition
+
+
+
+template<class Type, std::size_t N>
+constexpr StaticRedBlackTree<Type, N>::StaticRedBlackTree() : Nodes{}, Root(NullIndex), FreeList(NullIndex), Used(0),
+                                                              Size(0)
+{
+}
+
+template<class Type, std::size_t N>
+constexpr StaticRedBlackTree<Type, N>::StaticRedBlackTree(std::initializer_list<Type> Keys) : StaticRedBlackTree()
+{
+    for (const Type &Key : Keys)
+    {
+        Insert(Key);
+    }
+}
+
+template<class Type, std::size_t N>
+constexpr void StaticRedBlackTree<Type, N>::Insert(const Type NewKey)
+{
+    IndexType Par = Algorithms::Find(Nodes, Root, NewKey);
+    if (Par != NullIndex && Nodes[Par].Key == NewKey)
+    {
+        return;
+    }
+
+    Algorithms::Link(Nodes, NewNode(NewKey), Par, Root);
+    Size++;
+}
+
+template<class Type, std::size_t N>
+constexpr void StaticRedBlackTree<Type, N>::Delete(const Type KeyToDelete)
+{
+    IndexType Z = Algorithms::Find(Nodes, Root, KeyToDelete);
+
+    //if the key doesn't exist in our tree, then just return
+    if (Z == NullIndex || Nodes[Z].Key != KeyToDelete)
+    {
+        return;
+    }
+
+    Algorithms::Erase(Nodes, Z, Root);
+    Algorithms::FreeNode(Nodes, Z, FreeList);
+    Size--;
+}
+
+template<class Type, std::size_t N>
+constexpr bool StaticRedBlackTree<Type, N>::Find(const Type KeyToFind) const
+{
+    if (Size == 0)
+    {
+        return false;
+    }
+
+    return Nodes[Algorithms::Find(Nodes, Root, KeyToFind)].Key == KeyToFind;
+}
+
+template<class Type, std::size_t N>
+constexpr Type StaticRedBlackTree<Type, N>::FindMin() const
+{
+    if (Root == NullIndex)
+    {
+        throw std::out_of_range("FindMin called on an empty StaticRedBlackTree");
+    }
+
+    return Nodes[Algorithms::Minimum(Nodes, Root)].Key;
+}
+
+template<class Type, std::size_t N>
+constexpr Type StaticRedBlackTree<Type, N>::FindMax() const
+{
+    if (Root == NullIndex)
+    {
+        throw std::out_of_range("FindMax called on an empty StaticRedBlackTree");
+    }
+
+    return Nodes[Algorithms::Maximum(Nodes, Root)].Key;
+}
+
+template<class Type, std::size_t N>
+constexpr std::size_t StaticRedBlackTree<Type, N>::ExportTo(Type* Buffer, std::size_t Capacity) const
+{
+    if (Root == NullIndex)
+    {
+        return 0;
+    }
+
+    //walk in order through the parent links, so that no stack is needed
+    std::size_t Written = 0;
+    for (IndexType CurrNode = Algorithms::Minimum(Nodes, Root); CurrNode != NullIndex && Written < Capacity;
+         CurrNode = Algorithms::Next(Nodes, CurrNode))
+    {
+        Buffer[Written++] = Nodes[CurrNode].Key;
+    }
+    return Written;
+}
+
+template<class Type, std::size_t N>
+constexpr std::size_t StaticRedBlackTree<Type, N>::GetSize() const
+{
+    return Size;
+}
+
+template<class Type, std::size_t N>
+constexpr std::size_t StaticRedBlackTree<Type, N>::GetCapacity()
+{
+    return N;
+}
+
+template<class Type, std::size_t N>
+constexpr int StaticRedBlackTree<Type, N>::GetHeight() const
+{
+    return Algorithms::Height(Nodes, Root);
+}
+
+template<class Type, std::size_t N>
+constexpr int StaticRedBlackTree<Type, N>::GetBlackHeight() const
+{
+    return Algorithms::BlackHeight(Nodes, Root);
+}
+
+template<class Type, std::size_t N>
+constexpr typename StaticRedBlackTree<Type, N>::IndexType StaticRedBlackTree<Type, N>::NewNode(const Type NewKey)
+{
+    IndexType NewIndex = Algorithms::TakeFreeNode(Nodes, FreeList);
+    if (NewIndex == NullIndex)
+    {
+        if (Used >= N)
+        {
+            throw std::length_error("StaticRedBlackTree is full");
+        }
+
+        NewIndex = static_cast<IndexType>(Used);
+        Used++;
+    }
+
+    Algorithms::InitNode(Nodes, NewIndex, NewKey);
+    return NewIndex;
+}
+
+#endif //REDBLACKTREE_STATICREDBLACKTREE_H
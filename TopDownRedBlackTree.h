@@ -0,0 +1,535 @@
+#ifndef REDBLACKTREE_TOPDOWNREDBLACKTREE_H
+#define REDBLACKTREE_TOPDOWNREDBLACKTREE_H
+
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+#include <cstddef>
+
+template<class Type>
+struct TopDownNode;
+
+/**
+ * The links of a node in a top down red black tree: its two children and its colour, but no parent
+ * Kept apart from the key so the tree can use one as a key-less dummy head above the root
+ */
+template<class Type>
+struct TopDownLinks
+{
+    enum NodeColour
+    {
+        Red, Black
+    };
+
+    TopDownLinks()
+    {
+        Child[0] = Child[1] = nullptr;
+        Colour = NodeColour::Red;
+    }
+
+    /** Tests to see if this node is red; null nodes are black */
+    static bool TestColourRed(const TopDownLinks* TestNode)
+    {
+        return TestNode && TestNode->Colour == NodeColour::Red;
+    }
+
+    /** Child[0] is the left child, Child[1] the right one, so the algorithms can pick a side with a comparison */
+    TopDownNode<Type>* Child[2];
+    NodeColour Colour;
+
+};  //end TopDownLinks definition
+
+
+/**
+ * Container for a single node of a top down red black tree, containing a key, its colour, and two children
+ */
+template<class Type>
+struct TopDownNode : public TopDownLinks<Type>
+{
+    TopDownNode(Type NodeKey)
+    {
+        Key = NodeKey;
+    }
+
+    ~TopDownNode()
+    {
+        delete this->Child[0];
+        delete this->Child[1];
+    }
+
+    Type Key;
+
+};  //end TopDownNode definition
+
+
+/**
+ * Red black tree without parent pointers, for when node size matters more than anything else
+ * Insertion and deletion each make a single pass from the root down, fixing the tree on the way so that no
+ * walk back up is needed; iterators keep the path to their node on a stack bounded by the maximum tree height
+ * Obeys the same five properties as RedBlackTree
+ */
+template<class Type>
+class TopDownRedBlackTree
+{
+public:
+    /** Longest root-to-leaf path a red black tree can have when its size fits in 64 bits */
+    static const int MaxHeight = 128;
+
+    /**
+     * In order iterator over the keys of the tree
+     * Invalidated by any insertion or deletion
+     */
+    class Iterator
+    {
+    public:
+        const Type &operator*() const;
+
+        Iterator &operator++();
+
+        bool operator==(const Iterator &Right) const;
+
+        bool operator!=(const Iterator &Right) const;
+
+    private:
+        friend class TopDownRedBlackTree;
+
+        Iterator();
+
+        /** Pushes the node passed as parameter and every node down its left spine */
+        void PushLeftSpine(TopDownNode<Type>* StartNode);
+
+        /** Nodes whose keys have not been visited yet, on the path from the root to the current node */
+        TopDownNode<Type>* Path[MaxHeight];
+
+        /** Number of nodes on the path; the current node is on top */
+        int Depth;
+    };
+
+    TopDownRedBlackTree();
+
+    ~TopDownRedBlackTree();
+
+    /**
+     * Inserts the given key into the tree, if it is not already in the tree
+     * @param NewKey The new key to insert into the tree
+     */
+    void Insert(const Type NewKey);
+
+    /**
+     * Removes the given key from the tree, if it exists in the tree
+     * @param KeyToDelete The key to delete from the tree
+     */
+    void Delete(const Type KeyToDelete);
+
+    /**
+     * Finds the key passed as parameter in the tree, if it exists
+     * @param KeyToFind The key to search for in the tree
+     * @return true if key is in the tree, false otherwise
+     */
+    bool Find(const Type KeyToFind) const;
+
+    /**
+     * Finds the smallest key in the tree
+     * @return The smallest key in the tree
+     * @throws std::out_of_range if the tree is empty
+     */
+    Type FindMin() const;
+
+    /**
+     * Finds the largest key in the tree
+     * @return The largest key in the tree
+     * @throws std::out_of_range if the tree is empty
+     */
+    Type FindMax() const;
+
+    /***
+     * Makes and returns a sorted array of all elements in the tree
+     * @return A pointer to the first element of the newly created array
+     */
+    Type* MakeArray() const;
+
+    /** Getter function to retrieve size of the tree */
+    std::size_t GetSize() const;
+
+    int GetHeight() const;
+
+    /** @return An iterator at the smallest key in the tree */
+    Iterator begin() const;
+
+    /** @return An iterator one past the largest key in the tree */
+    Iterator end() const;
+
+private:
+    /**
+     * Rotates the subtree rooted at X once, in the given direction, and recolours it
+     * @param X Root of the subtree to rotate
+     * @param Dir 0 to rotate left, 1 to rotate right
+     * @return The new root of the subtree
+     */
+    static TopDownNode<Type>* SingleRotation(TopDownNode<Type>* X, int Dir);
+
+    /**
+     * Rotates the child of X opposite to Dir the other way, then X in the given direction
+     * @param X Root of the subtree to rotate
+     * @param Dir 0 to rotate left, 1 to rotate right
+     * @return The new root of the subtree
+     */
+    static TopDownNode<Type>* DoubleRotation(TopDownNode<Type>* X, int Dir);
+
+    int GetHeightIntl(TopDownNode<Type>* Curr) const;
+
+    /** Dummy node above the root; the root is its right child, which saves special cases at the top of the tree */
+    TopDownLinks<Type> Head;
+
+    /** The current number of nodes stored in the tree */
+    std::size_t Size;
+
+};  //end TopDownRedBlackTree definition
+
+
+
+template<class Type>
+TopDownRedBlackTree<Type>::Iterator::Iterator()
+{
+    Depth = 0;
+}
+
+template<class Type>
+const Type &TopDownRedBlackTree<Type>::Iterator::operator*() const
+{
+    return Path[Depth - 1]->Key;
+}
+
+template<class Type>
+typename TopDownRedBlackTree<Type>::Iterator &TopDownRedBlackTree<Type>::Iterator::operator++()
+{
+    TopDownNode<Type>* Curr = Path[--Depth];
+    PushLeftSpine(Curr->Child[1]);
+    return *this;
+}
+
+template<class Type>
+bool TopDownRedBlackTree<Type>::Iterator::operator==(const Iterator &Right) const
+{
+    if (Depth == 0 || Right.Depth == 0)
+    {
+        return Depth == Right.Depth;
+    }
+    return Path[Depth - 1] == Right.Path[Right.Depth - 1];
+}
+
+template<class Type>
+bool TopDownRedBlackTree<Type>::Iterator::operator!=(const Iterator &Right) const
+{
+    return !(*this == Right);
+}
+
+template<class Type>
+void TopDownRedBlackTree<Type>::Iterator::PushLeftSpine(TopDownNode<Type>* StartNode)
+{
+    for (TopDownNode<Type>* CurrNode = StartNode; CurrNode; CurrNode = CurrNode->Child[0])
+    {
+        Path[Depth++] = CurrNode;
+    }
+}
+
+template<class Type>
+TopDownRedBlackTree<Type>::TopDownRedBlackTree()
+{
+    Head.Colour = TopDownLinks<Type>::NodeColour::Black;
+    Size = 0;
+}
+
+template<class Type>
+TopDownRedBlackTree<Type>::~TopDownRedBlackTree()
+{
+    delete Head.Child[1];
+}
+
+template<class Type>
+void TopDownRedBlackTree<Type>::Insert(const Type NewKey)
+{
+    //if the root node is null, then insert the key into the root and colour it black
+    if (!Head.Child[1])
+    {
+        Head.Child[1] = new TopDownNode<Type>(NewKey);
+        Head.Child[1]->Colour = TopDownLinks<Type>::NodeColour::Black;
+        Size++;
+        return;
+    }
+
+    //Great is the parent of Grand, which is the parent of Par, which is the parent of Curr
+    TopDownLinks<Type>* Great = &Head;
+    TopDownNode<Type>* Grand = nullptr;
+    TopDownNode<Type>* Par = nullptr;
+    TopDownNode<Type>* CurrNode = Head.Child[1];
+    int Dir = 0;
+    int LastDir = 0;
+
+    while (true)
+    {
+        if (!CurrNode)
+        {
+            CurrNode = new TopDownNode<Type>(NewKey);
+            Par->Child[Dir] = CurrNode;
+            Size++;
+        }
+        //split a node with two red children on the way down, so the insertion point never has a red sibling
+        else if (TopDownLinks<Type>::TestColourRed(CurrNode->Child[0]) &&
+                 TopDownLinks<Type>::TestColourRed(CurrNode->Child[1]))
+        {
+            CurrNode->Colour = TopDownLinks<Type>::NodeColour::Red;
+            CurrNode->Child[0]->Colour = TopDownLinks<Type>::NodeColour::Black;
+            CurrNode->Child[1]->Colour = TopDownLinks<Type>::NodeColour::Black;
+        }
+
+        //fix a red node under a red parent with a rotation at the grandparent
+        if (TopDownLinks<Type>::TestColourRed(CurrNode) && TopDownLinks<Type>::TestColourRed(Par))
+        {
+            int GreatDir = Great->Child[1] == Grand;
+            if (CurrNode == Par->Child[LastDir])
+            {
+                Great->Child[GreatDir] = SingleRotation(Grand, !LastDir);
+            }
+            else
+            {
+                Great->Child[GreatDir] = DoubleRotation(Grand, !LastDir);
+            }
+        }
+
+        if (CurrNode->Key == NewKey)
+        {
+            break;
+        }
+
+        LastDir = Dir;
+        Dir = CurrNode->Key < NewKey;
+
+        if (Grand)
+        {
+            Great = Grand;
+        }
+        Grand = Par;
+        Par = CurrNode;
+        CurrNode = CurrNode->Child[Dir];
+    }
+
+    Head.Child[1]->Colour = TopDownLinks<Type>::NodeColour::Black;
+}
+
+template<class Type>
+void TopDownRedBlackTree<Type>::Delete(const Type KeyToDelete)
+{
+    if (!Head.Child[1])
+    {
+        return;
+    }
+
+    TopDownLinks<Type>* Grand = nullptr;
+    TopDownLinks<Type>* Par = nullptr;
+    TopDownLinks<Type>* CurrLinks = &Head;
+    TopDownNode<Type>* CurrNode = nullptr;
+    TopDownNode<Type>* Found = nullptr;
+    int Dir = 1;
+
+    //walk down to the in order predecessor or successor of the key, pushing a red node down ahead of us
+    //so that the node finally removed is red and nothing needs fixing on the way back
+    while (CurrLinks->Child[Dir])
+    {
+        int LastDir = Dir;
+
+        Grand = Par;
+        Par = CurrLinks;
+        CurrNode = CurrLinks->Child[Dir];
+        CurrLinks = CurrNode;
+        Dir = CurrNode->Key < KeyToDelete;
+
+        if (CurrNode->Key == KeyToDelete)
+        {
+            Found = CurrNode;
+        }
+
+        if (!TopDownLinks<Type>::TestColourRed(CurrNode) &&
+            !TopDownLinks<Type>::TestColourRed(CurrNode->Child[Dir]))
+        {
+            //the red child is on the other side, so rotate it above us
+            if (TopDownLinks<Type>::TestColourRed(CurrNode->Child[!Dir]))
+            {
+                TopDownNode<Type>* Rotated = SingleRotation(CurrNode, Dir);
+                Par->Child[LastDir] = Rotated;
+                Par = Rotated;
+            }
+            else
+            {
+                TopDownNode<Type>* Sibling = Par->Child[!LastDir];
+                if (Sibling)
+                {
+                    //neither we nor our sibling have red children: recolour
+                    if (!TopDownLinks<Type>::TestColourRed(Sibling->Child[!LastDir]) &&
+                        !TopDownLinks<Type>::TestColourRed(Sibling->Child[LastDir]))
+                    {
+                        Par->Colour = TopDownLinks<Type>::NodeColour::Black;
+                        Sibling->Colour = TopDownLinks<Type>::NodeColour::Red;
+                        CurrNode->Colour = TopDownLinks<Type>::NodeColour::Red;
+                    }
+                    //otherwise borrow a red node from the sibling's side with a rotation at the parent
+                    else
+                    {
+                        TopDownNode<Type>* ParNode = static_cast<TopDownNode<Type>*>(Par);
+                        int GrandDir = Grand->Child[1] == ParNode;
+
+                        if (TopDownLinks<Type>::TestColourRed(Sibling->Child[LastDir]))
+                        {
+                            Grand->Child[GrandDir] = DoubleRotation(ParNode, LastDir);
+                        }
+                        else
+                        {
+                            Grand->Child[GrandDir] = SingleRotation(ParNode, LastDir);
+                        }
+
+                        TopDownNode<Type>* NewPar = Grand->Child[GrandDir];
+                        CurrNode->Colour = TopDownLinks<Type>::NodeColour::Red;
+                        NewPar->Colour = TopDownLinks<Type>::NodeColour::Red;
+                        NewPar->Child[0]->Colour = TopDownLinks<Type>::NodeColour::Black;
+                        NewPar->Child[1]->Colour = TopDownLinks<Type>::NodeColour::Black;
+                    }
+                }
+            }
+        }
+    }
+
+    //CurrNode is now the last node on the search path and is red (or the root); it takes the found key's place
+    if (Found)
+    {
+        Found->Key = CurrNode->Key;
+        Par->Child[Par->Child[1] == CurrNode] = CurrNode->Child[CurrNode->Child[0] == nullptr];
+
+        CurrNode->Child[0] = CurrNode->Child[1] = nullptr;
+        delete CurrNode;
+        Size--;
+    }
+
+    if (Head.Child[1])
+    {
+        Head.Child[1]->Colour = TopDownLinks<Type>::NodeColour::Black;
+    }
+}
+
+template<class Type>
+bool TopDownRedBlackTree<Type>::Find(const Type KeyToFind) const
+{
+    TopDownNode<Type>* CurrNode = Head.Child[1];
+    while (CurrNode)
+    {
+        if (CurrNode->Key == KeyToFind)
+        {
+            return true;
+        }
+        CurrNode = CurrNode->Child[CurrNode->Key < KeyToFind];
+    }
+    return false;
+}
+
+template<class Type>
+Type TopDownRedBlackTree<Type>::FindMin() const
+{
+    if (Size == 0)
+    {
+        throw std::out_of_range("FindMin called on an empty TopDownRedBlackTree");
+    }
+
+    TopDownNode<Type>* CurrNode = Head.Child[1];
+    while (CurrNode->Child[0])
+    {
+        CurrNode = CurrNode->Child[0];
+    }
+    return CurrNode->Key;
+}
+
+template<class Type>
+Type TopDownRedBlackTree<Type>::FindMax() const
+{
+    if (Size == 0)
+    {
+        throw std::out_of_range("FindMax called on an empty TopDownRedBlackTree");
+    }
+
+    TopDownNode<Type>* CurrNode = Head.Child[1];
+    while (CurrNode->Child[1])
+    {
+        CurrNode = CurrNode->Child[1];
+    }
+    return CurrNode->Key;
+}
+
+template<class Type>
+Type* TopDownRedBlackTree<Type>::MakeArray() const
+{
+    Type* Arr = new Type[this->Size];
+    std::size_t x = 0;
+    for (Iterator It = begin(); It != end(); ++It)
+    {
+        Arr[x++] = *It;
+    }
+    return Arr;
+}
+
+template<class Type>
+std::size_t TopDownRedBlackTree<Type>::GetSize() const
+{
+    return Size;
+}
+
+template<class Type>
+int TopDownRedBlackTree<Type>::GetHeight() const
+{
+    return GetHeightIntl(Head.Child[1]);
+}
+
+template<class Type>
+typename TopDownRedBlackTree<Type>::Iterator TopDownRedBlackTree<Type>::begin() const
+{
+    Iterator It;
+    It.PushLeftSpine(Head.Child[1]);
+    return It;
+}
+
+template<class Type>
+typename TopDownRedBlackTree<Type>::Iterator TopDownRedBlackTree<Type>::end() const
+{
+    return Iterator();
+}
+
+template<class Type>
+TopDownNode<Type>* TopDownRedBlackTree<Type>::SingleRotation(TopDownNode<Type>* X, int Dir)
+{
+    TopDownNode<Type>* Y = X->Child[!Dir];
+
+    X->Child[!Dir] = Y->Child[Dir];
+    Y->Child[Dir] = X;
+
+    X->Colour = TopDownLinks<Type>::NodeColour::Red;
+    Y->Colour = TopDownLinks<Type>::NodeColour::Black;
+
+    return Y;
+}
+
+template<class Type>
+TopDownNode<Type>* TopDownRedBlackTree<Type>::DoubleRotation(TopDownNode<Type>* X, int Dir)
+{
+    X->Child[!Dir] = SingleRotation(X->Child[!Dir], !Dir);
+    return SingleRotation(X, Dir);
+}
+
+template<class Type>
+int TopDownRedBlackTree<Type>::GetHeightIntl(TopDownNode<Type>* Curr) const
+{
+    if (!Curr)
+    {
+        return -1;
+    }
+
+    return std::max(GetHeightIntl(Curr->Child[0]), GetHeightIntl(Curr->Child[1])) + 1;
+}
+
+#endif //REDBLACKTREE_TOPDOWNREDBLACKTREE_H
@@ -3,16 +3,45 @@
 #include <cstdlib>
 #include <vector>
 #include <iomanip>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <utility>
+#include <mutex>
+#include <cmath>
+#include <algorithm>
+#include <optional>
+#include <set>
+#include <climits>
+#include <fstream>
+#include <cstdio>
+#include <memory_resource>
 #include "RedBlackTree.h"
+#include "TopDownRedBlackTree.h"
+#include "IndexedRedBlackTree.h"
+#include "StaticRedBlackTree.h"
+#include "BTree.h"
+#include "BucketedRedBlackTree.h"
+#include "LazyRedBlackTree.h"
+#include "BufferedRedBlackTree.h"
+#include "CachedRedBlackTree.h"
+#include "IntervalTree.h"
+#include "IntrusiveRedBlackTree.h"
+#include "CompressedSnapshot.h"
+#include "KeyFileLoader.h"
+#include "ConcurrentChromaticTree.h"
+#include "ShardedRedBlackTree.h"
+#include "FlatCombiningRedBlackTree.h"
 using namespace std;
 
 /**
- * Function that inserts a series of random numbers into a red black tree
+ * Function that inserts a series of random numbers into a tree
  * @param Tree The tree to insert the elements into
  * @param NumEntriesToAdd How many entries should we add to the tree?
  * @param RandRange The interval for which the numbers will be added; interval is [0, RandRange)
  * */
-void InsertIntoTree(RedBlackTree<int>& Tree, int NumEntriesToAdd, int RandRange)
+template<class TreeType>
+void InsertIntoTree(TreeType& Tree, int NumEntriesToAdd, int RandRange)
 {
     float start = clock();
     for (int i = 0; i < NumEntriesToAdd; i++)
@@ -25,10 +54,1280 @@ void InsertIntoTree(RedBlackTree<int>& Tree, int NumEntriesToAdd, int RandRange)
     cout << "Time for insertion to finish: " << (clock() - start) / CLOCKS_PER_SEC << endl;
 }
 
+/**
+ * Times inserting, finding and deleting the same keys in a tree, and reports the throughput of each
+ * @param Tree The tree to run the keys through; assumed to be empty
+ * @param Name Name of the tree to print with the results
+ * @param Keys The keys to insert, then find, then delete, in this order
+ * @param BytesPerKey Size of the node the tree allocates for each key
+ * */
+template<class TreeType, class KeyType>
+void BenchmarkTree(TreeType& Tree, const string& Name, const vector<KeyType>& Keys, size_t BytesPerKey)
+{
+    float start = clock();
+    for (const KeyType& Key : Keys)
+        Tree.Insert(Key);
+    float InsertTime = (clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    int Found = 0;
+    for (const KeyType& Key : Keys)
+        Found += Tree.Find(Key);
+    float FindTime = (clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (const KeyType& Key : Keys)
+        Tree.Delete(Key);
+    float DeleteTime = (clock() - start) / CLOCKS_PER_SEC;
+
+    cout << Name << ": " << BytesPerKey << " bytes per key, " << Found << " keys found" << endl;
+    cout << "    insert " << Keys.size() / InsertTime / 1e6 << " Mops/s, find " << Keys.size() / FindTime / 1e6
+         << " Mops/s, delete " << Keys.size() / DeleteTime / 1e6 << " Mops/s" << endl;
+}
+
+/**
+ * Compares the parent pointer tree against the top down tree, which has no parent pointers,
+ * the indexed tree, which links its nodes with 32 bit indices, the B-tree, which packs many keys per node,
+ * the bucketed tree, which keeps a small sorted array of keys in each red black node, and the lazy tree, which
+ * only marks deleted keys and compacts them away in bulk
+ * @param NumKeys How many random keys to run through each tree
+ * @param RandRange The interval for which the keys are drawn; interval is [0, RandRange)
+ * */
+void CompareTreeVariants(int NumKeys, int RandRange)
+{
+    vector<int> Keys(NumKeys);
+    for (int& Key : Keys)
+        Key = rand() % RandRange;
+
+    RedBlackTree<int> ParentTree;
+    BenchmarkTree(ParentTree, "RedBlackTree", Keys, sizeof(Node<int>));
+
+    TopDownRedBlackTree<int> TopDownTree;
+    BenchmarkTree(TopDownTree, "TopDownRedBlackTree", Keys, sizeof(TopDownNode<int>));
+
+    IndexedRedBlackTree<int> IndexedTree;
+    BenchmarkTree(IndexedTree, "IndexedRedBlackTree", Keys, sizeof(IndexedNode<int>));
+
+    //B-tree nodes hold many keys, so this is the cost per key of a full node
+    typedef BTreeNode<int, BTreeDefaultDegree<int>::Value> IntBTreeNode;
+    BTree<int> WideTree;
+    BenchmarkTree(WideTree, "BTree", Keys, sizeof(IntBTreeNode) / IntBTreeNode::MaxKeys);
+
+    BucketedRedBlackTree<int> BucketedTree;
+    BenchmarkTree(BucketedTree, "BucketedRedBlackTree", Keys, sizeof(BucketNode<int, 32>) / 32);
+
+    LazyRedBlackTree<int> LazyTree;
+    BenchmarkTree(LazyTree, "LazyRedBlackTree", Keys, sizeof(LazyNode<int>));
+}
+
+/**
+ * Removes a run of consecutive keys from the middle of a large tree three ways: with EraseRange, by deleting the keys
+ * one at a time, and by rebuilding the tree from the keys outside the run, checking that all three trees end up equal
+ * @param NumKeys How many random keys the trees start out with
+ * @param RangeKeys How many consecutive keys to remove
+ * */
+void BenchmarkEraseRange(int NumKeys, int RangeKeys)
+{
+    vector<int> Keys(NumKeys);
+    for (int& Key : Keys)
+        Key = rand();
+
+    //each tree is built in a pass of its own, so that no tree shares cache lines with another and warms it
+    RedBlackTree<int> RangeTree, DeleteTree, RebuildTree;
+    for (int Key : Keys)
+        RangeTree.Insert(Key);
+    for (int Key : Keys)
+        DeleteTree.Insert(Key);
+    for (int Key : Keys)
+        RebuildTree.Insert(Key);
+
+    sort(Keys.begin(), Keys.end());
+    Keys.erase(unique(Keys.begin(), Keys.end()), Keys.end());
+    size_t First = (Keys.size() - min<size_t>(RangeKeys, Keys.size())) / 2;
+    size_t Last = First + min<size_t>(RangeKeys, Keys.size()) - 1;
+    int Low = Keys[First], High = Keys[Last];
+
+    float start = clock();
+    size_t Erased = RangeTree.EraseRange(Low, High);
+    float RangeTime = (clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (size_t i = First; i <= Last; i++)
+        DeleteTree.Delete(Keys[i]);
+    float DeleteTime = (clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    int* Old = RebuildTree.MakeArray();
+    vector<int> Kept;
+    Kept.reserve(RebuildTree.GetSize());
+    for (size_t i = 0; i < RebuildTree.GetSize(); i++)
+    {
+        if (Old[i] < Low || High < Old[i])
+            Kept.push_back(Old[i]);
+    }
+    delete[] Old;
+    RebuildTree.AssignSorted(Kept.data(), Kept.size());
+    float RebuildTime = (clock() - start) / CLOCKS_PER_SEC;
+
+    int* RangeKeysLeft = RangeTree.MakeArray();
+    int* DeleteKeysLeft = DeleteTree.MakeArray();
+    bool Matches = Erased == Last - First + 1 && RangeTree.GetSize() == Kept.size() &&
+                   DeleteTree.GetSize() == Kept.size() && equal(Kept.begin(), Kept.end(), RangeKeysLeft) &&
+                   equal(Kept.begin(), Kept.end(), DeleteKeysLeft);
+    delete[] RangeKeysLeft;
+    delete[] DeleteKeysLeft;
+
+    cout << "Erasing " << Erased << " of " << Keys.size() << " keys: EraseRange " << RangeTime << " s, one by one "
+         << DeleteTime << " s, rebuild " << RebuildTime << " s, " << (Matches ? "all match" : "DO NOT MATCH") << endl;
+}
+
+/**
+ * Grows a large tree with random inserts, both directly and through the insertion buffer, then times random finds
+ * against both, showing what the buffer gains on ingest and what it costs reads
+ * @param TreeSize How many keys both trees start out with
+ * @param NumInserts How many random keys are then inserted into both
+ * @param RandRange The interval for which the keys are drawn; interval is [0, RandRange)
+ * */
+void BenchmarkBufferedIngest(int TreeSize, int NumInserts, int RandRange)
+{
+    RedBlackTree<int> DirectTree;
+    BufferedRedBlackTree<int> BufferedTree;
+    for (int i = 0; i < TreeSize; i++)
+    {
+        int Key = rand() % RandRange;
+        DirectTree.Insert(Key);
+        BufferedTree.Insert(Key);
+    }
+    BufferedTree.Flush();
+
+    vector<int> Keys(NumInserts);
+    for (int& Key : Keys)
+        Key = rand() % RandRange;
+
+    float start = clock();
+    for (int Key : Keys)
+        DirectTree.Insert(Key);
+    float DirectTime = (clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (int Key : Keys)
+        BufferedTree.Insert(Key);
+    BufferedTree.Flush();
+    float BufferedTime = (clock() - start) / CLOCKS_PER_SEC;
+
+    //fill the buffer halfway again, so that finds pay for a realistic buffer
+    for (int i = 0; i < (1 << 15); i++)
+        BufferedTree.Insert(rand() % RandRange);
+
+    //look the keys up in an order unrelated to the insertion order; otherwise the direct tree, whose nodes were
+    //allocated in exactly that order, gets every lookup's neighbouring nodes prefetched for free
+    vector<int> Queries(Keys);
+    for (size_t i = Queries.size(); i > 1; i--)
+        swap(Queries[i - 1], Queries[rand() % i]);
+
+    start = clock();
+    int Found = 0;
+    for (int Key : Queries)
+        Found += DirectTree.Find(Key);
+    float DirectFindTime = (clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (int Key : Queries)
+        Found += BufferedTree.Find(Key);
+    float BufferedFindTime = (clock() - start) / CLOCKS_PER_SEC;
+
+    cout << "Ingest into a " << TreeSize << " key tree: direct " << NumInserts / DirectTime / 1e6 << " Mops/s, buffered "
+         << NumInserts / BufferedTime / 1e6 << " Mops/s" << endl;
+    cout << "    find: direct " << NumInserts / DirectFindTime / 1e6 << " Mops/s, buffered "
+         << NumInserts / BufferedFindTime / 1e6 << " Mops/s, " << Found << " keys found" << endl;
+}
+
+/**
+ * Times finds drawn from a Zipfian distribution against the plain tree and the tree with a hot-key cache,
+ * and reports how many of them the cache answered
+ * @param NumKeys How many random keys both trees hold
+ * @param NumQueries How many finds to time
+ * @param Skew Exponent of the distribution; the key of popularity rank r is drawn with weight 1 / r^Skew,
+ *             so 0 is uniform and larger values concentrate the finds on fewer keys
+ * */
+void BenchmarkSkewedFinds(int NumKeys, int NumQueries, double Skew)
+{
+    RedBlackTree<int> PlainTree;
+    CachedRedBlackTree<int> CachedTree;
+    for (int i = 0; i < NumKeys; i++)
+    {
+        int Key = rand();
+        PlainTree.Insert(Key);
+        CachedTree.Insert(Key);
+    }
+
+    //popularity ranks are handed out to the keys in random order, so hot keys are scattered over the tree
+    int* Keys = PlainTree.MakeArray();
+    int NumUnique = PlainTree.GetSize();
+    for (int i = NumUnique - 1; i > 0; i--)
+        swap(Keys[i], Keys[rand() % (i + 1)]);
+
+    vector<double> Cumulative(NumUnique);
+    double Total = 0;
+    for (int Rank = 0; Rank < NumUnique; Rank++)
+    {
+        Total += 1.0 / pow(Rank + 1, Skew);
+        Cumulative[Rank] = Total;
+    }
+
+    vector<int> Queries(NumQueries);
+    for (int& Query : Queries)
+    {
+        double Target = (double) rand() / RAND_MAX * Total;
+        size_t Rank = lower_bound(Cumulative.begin(), Cumulative.end(), Target) - Cumulative.begin();
+        Query = Keys[min(Rank, (size_t) NumUnique - 1)];
+    }
+    delete[] Keys;
+
+    float start = clock();
+    int Found = 0;
+    for (int Query : Queries)
+        Found += PlainTree.Find(Query);
+    float PlainTime = (clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (int Query : Queries)
+        Found += CachedTree.Find(Query);
+    float CachedTime = (clock() - start) / CLOCKS_PER_SEC;
+
+    cout << "Zipfian finds, skew " << Skew << ": plain " << NumQueries / PlainTime / 1e6 << " Mops/s, cached "
+         << NumQueries / CachedTime / 1e6 << " Mops/s, cache hit rate "
+         << (double) CachedTree.GetCacheHits() / NumQueries * 100 << "%, " << Found << " keys found" << endl;
+}
+
+/**
+ * Uses the tree as a scheduler queue: every step takes the earliest deadline out and schedules a later one,
+ * once by finding the minimum and deleting it by key, and once with PopMin, which needs no search
+ * @param QueueSize How many deadlines are queued at any time
+ * @param NumSteps How many deadlines are taken out and rescheduled
+ * */
+void BenchmarkSchedulerQueue(int QueueSize, int NumSteps)
+{
+    RedBlackTree<int> SearchedQueue;
+    RedBlackTree<int> PoppedQueue;
+    for (int i = 0; i < QueueSize; i++)
+    {
+        int Deadline = rand() % QueueSize;
+        SearchedQueue.Insert(Deadline);
+        PoppedQueue.Insert(Deadline);
+    }
+
+    vector<int> Delays(NumSteps);
+    for (int& Delay : Delays)
+        Delay = rand() % QueueSize + 1;
+
+    float start = clock();
+    for (int Delay : Delays)
+    {
+        int Earliest = SearchedQueue.FindMin();
+        SearchedQueue.Delete(Earliest);
+        SearchedQueue.Insert(Earliest + Delay);
+    }
+    float SearchedTime = (clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (int Delay : Delays)
+    {
+        int Earliest = PoppedQueue.PopMin();
+        PoppedQueue.Insert(Earliest + Delay);
+    }
+    float PoppedTime = (clock() - start) / CLOCKS_PER_SEC;
+
+    cout << "Scheduler queue of " << QueueSize << ": FindMin and Delete " << NumSteps / SearchedTime / 1e6
+         << " Msteps/s, PopMin " << NumSteps / PoppedTime / 1e6 << " Msteps/s, "
+         << (SearchedQueue.FindMax() == PoppedQueue.FindMax() ? "same" : "DIFFERENT") << " final queue" << endl;
+}
+
+/**
+ * Snaps random timestamps to the nearest ticks of a tick series: down with Floor, up with Ceiling, and to the
+ * closest few with KNearest, checking Floor against a binary search over the sorted ticks and KNearest against a
+ * std::set, both on the ticks and on keys spread over the whole int range, whose gaps overflow an int
+ * @param NumTicks How many random tick timestamps the tree holds
+ * @param NumQueries How many timestamps to snap
+ * @param K How many neighbours KNearest returns
+ * */
+void BenchmarkNearestQueries(int NumTicks, int NumQueries, int K)
+{
+    RedBlackTree<int> Ticks;
+    for (int i = 0; i < NumTicks; i++)
+        Ticks.Insert(rand());
+
+    int* Sorted = Ticks.MakeArray();
+    vector<int> Queries(NumQueries);
+    for (int& Query : Queries)
+        Query = rand();
+
+    float start = clock();
+    bool Matches = true;
+    for (int Query : Queries)
+    {
+        optional<int> Snapped = Ticks.Floor(Query);
+        int* Expected = upper_bound(Sorted, Sorted + Ticks.GetSize(), Query);
+        Matches &= (Expected == Sorted) ? !Snapped : (Snapped && *Snapped == *(Expected - 1));
+    }
+    float FloorTime = (clock() - start) / CLOCKS_PER_SEC;
+    delete[] Sorted;
+
+    start = clock();
+    size_t Snapped = 0;
+    for (int Query : Queries)
+        Snapped += Ticks.Ceiling(Query).has_value();
+    float CeilingTime = (clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (int Query : Queries)
+        Snapped += Ticks.KNearest(Query, K).size();
+    float NearestTime = (clock() - start) / CLOCKS_PER_SEC;
+
+    //walk outwards from the query in a std::set, measuring distances in long long, where they cannot overflow
+    auto Nearest = [](const set<int>& Keys, int Query, int Count)
+    {
+        vector<int> Found;
+        set<int>::const_iterator Upper = Keys.upper_bound(Query);
+        set<int>::const_iterator Lower = Upper;
+        bool HasLower = Lower != Keys.begin();
+        if (HasLower)
+            --Lower;
+        while ((int) Found.size() < Count && (HasLower || Upper != Keys.end()))
+        {
+            if (Upper == Keys.end() || (HasLower && (long long) *Upper - Query >= (long long) Query - *Lower))
+            {
+                Found.push_back(*Lower);
+                HasLower = Lower != Keys.begin();
+                if (HasLower)
+                    --Lower;
+            }
+            else
+            {
+                Found.push_back(*Upper++);
+            }
+        }
+        return Found;
+    };
+
+    set<int> TickSet;
+    int* TickKeys = Ticks.MakeArray();
+    TickSet.insert(TickKeys, TickKeys + Ticks.GetSize());
+    delete[] TickKeys;
+    bool NearestMatches = true;
+    for (int i = 0; i < min(NumQueries, 10000); i++)
+        NearestMatches &= Ticks.KNearest(Queries[i], K) == Nearest(TickSet, Queries[i], K);
+
+    set<int> Spread = {INT_MIN, INT_MIN + 1, -2, 0, 3, INT_MAX - 1, INT_MAX};
+    RedBlackTree<int> SpreadTree;
+    for (int Key : Spread)
+        SpreadTree.Insert(Key);
+    for (int Query : {INT_MIN, -1000000000, -1, 0, 1, 1000000000, INT_MAX})
+        NearestMatches &= SpreadTree.KNearest(Query, Spread.size()) == Nearest(Spread, Query, Spread.size());
+
+    cout << "Snapping to " << NumTicks << " ticks: Floor " << NumQueries / FloorTime / 1e6 << " Mops/s ("
+         << (Matches ? "matches" : "DOES NOT MATCH") << " binary search), Ceiling " << NumQueries / CeilingTime / 1e6
+         << " Mops/s, KNearest(" << K << ") " << NumQueries / NearestTime / 1e6 << " Mops/s ("
+         << (NearestMatches ? "matches" : "DOES NOT MATCH") << " std::set), " << Snapped << " keys returned" << endl;
+}
+
+/** A session linked into two intrusive trees at once: one ordered by id, and one by expiry time */
+struct Session
+{
+    int Id;
+    long long Expiry;
+    RedBlackHook ById;
+    RedBlackHook ByExpiry;
+};
+
+/**
+ * Keeps sessions in two intrusive trees at once, expires the oldest half and drops random ones by id, then checks both
+ * trees against plain RedBlackTrees that replay the same operations on copies of the keys
+ * @param NumSessions How many sessions to create
+ * */
+void DemoIntrusiveTree(int NumSessions)
+{
+    //the session index in the low bits makes every expiry time distinct
+    vector<Session> Sessions(NumSessions);
+    for (int i = 0; i < NumSessions; i++)
+    {
+        Sessions[i].Id = rand();
+        Sessions[i].Expiry = (long long) rand() << 24 | i;
+    }
+
+    IntrusiveRedBlackTree<Session, int, &Session::Id, &Session::ById> SessionsById;
+    IntrusiveRedBlackTree<Session, long long, &Session::Expiry, &Session::ByExpiry> SessionsByExpiry;
+    RedBlackTree<int> Ids;
+    RedBlackTree<long long> Expiries;
+
+    float start = clock();
+    for (Session& NewSession : Sessions)
+    {
+        //a session whose id is already taken is left out of both trees
+        if (SessionsById.Insert(NewSession))
+            SessionsByExpiry.Insert(NewSession);
+    }
+    float IntrusiveTime = (clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (const Session& NewSession : Sessions)
+    {
+        size_t Before = Ids.GetSize();
+        Ids.Insert(NewSession.Id);
+        if (Ids.GetSize() != Before)
+            Expiries.Insert(NewSession.Expiry);
+    }
+    float CopiedTime = (clock() - start) / CLOCKS_PER_SEC;
+
+    //expire the oldest half; erasing through the hooks needs no search
+    bool Matches = true;
+    for (int i = 0; i < NumSessions / 2 && SessionsByExpiry.GetSize() > 0; i++)
+    {
+        Session* Oldest = SessionsByExpiry.FindMin();
+        SessionsByExpiry.Erase(*Oldest);
+        SessionsById.Erase(*Oldest);
+        Matches &= Expiries.PopMin() == Oldest->Expiry;
+        Ids.Delete(Oldest->Id);
+    }
+
+    //then drop random sessions by id
+    for (int i = 0; i < NumSessions / 4; i++)
+    {
+        int Id = Sessions[rand() % NumSessions].Id;
+        Session* Dropped = SessionsById.Delete(Id);
+        Matches &= (Dropped != nullptr) == Ids.Find(Id);
+        if (Dropped)
+        {
+            SessionsByExpiry.Erase(*Dropped);
+            Ids.Delete(Id);
+            Expiries.Delete(Dropped->Expiry);
+        }
+    }
+
+    Matches &= SessionsById.GetSize() == Ids.GetSize() && SessionsByExpiry.GetSize() == Expiries.GetSize();
+    if (Matches && Ids.GetSize() > 0)
+    {
+        Matches &= SessionsById.FindMin()->Id == Ids.FindMin() && SessionsById.FindMax()->Id == Ids.FindMax();
+        Matches &= SessionsByExpiry.FindMin()->Expiry == Expiries.FindMin() &&
+                   SessionsByExpiry.FindMax()->Expiry == Expiries.FindMax();
+
+        int* SortedIds = Ids.MakeArray();
+        for (size_t i = 0; i < Ids.GetSize(); i++)
+        {
+            Session* Found = SessionsById.Find(SortedIds[i]);
+            Matches &= Found && Found->Id == SortedIds[i] && SessionsByExpiry.Find(Found->Expiry) == Found;
+        }
+        delete[] SortedIds;
+    }
+
+    cout << "Intrusive trees of " << NumSessions << " sessions: linking into both " << NumSessions / IntrusiveTime / 1e6
+         << " Mops/s, copying keys into two RedBlackTrees " << NumSessions / CopiedTime / 1e6 << " Mops/s; "
+         << SessionsById.GetSize() << " sessions left, " << (Matches ? "matches" : "DOES NOT MATCH")
+         << " RedBlackTree" << endl;
+}
+
+/**
+ * Runs random overlap queries against an interval tree, checking every answer against a scan of the same intervals
+ * held in a plain RedBlackTree, then deletes half of the intervals and checks again
+ * @param NumIntervals How many random intervals to insert
+ * @param NumQueries How many random query windows to look up
+ * @param MaxLength The longest interval and query window; both are drawn from [0, MaxLength]
+ * */
+void BenchmarkIntervalQueries(int NumIntervals, int NumQueries, int MaxLength)
+{
+    IntervalTree<int> Intervals;
+    RedBlackTree<Interval<int>> Plain;
+    vector<Interval<int>> Inserted(NumIntervals);
+    for (Interval<int>& NewInterval : Inserted)
+    {
+        int Low = rand() % (RAND_MAX - MaxLength);
+        NewInterval = Interval<int>(Low, Low + rand() % (MaxLength + 1));
+        Intervals.Insert(NewInterval.Low, NewInterval.High);
+        Plain.Insert(NewInterval);
+    }
+
+    vector<pair<int, int>> Windows(NumQueries);
+    for (pair<int, int>& Window : Windows)
+    {
+        Window.first = rand() % (RAND_MAX - MaxLength);
+        Window.second = Window.first + rand() % (MaxLength + 1);
+    }
+
+    //a scan of the sorted intervals can stop at the first one starting after the window, but has to start at the
+    //very first interval, since any earlier one may be long enough to reach the window
+    Interval<int>* Sorted = Plain.MakeArray();
+    auto Scan = [&Plain, &Sorted](const pair<int, int>& Window)
+    {
+        vector<Interval<int>> Found;
+        for (size_t i = 0; i < Plain.GetSize() && !(Window.second < Sorted[i].Low); i++)
+        {
+            if (Sorted[i].Overlaps(Window.first, Window.second))
+                Found.push_back(Sorted[i]);
+        }
+        return Found;
+    };
+
+    bool Matches = true;
+    size_t Overlaps = 0;
+    float start = clock();
+    for (const pair<int, int>& Window : Windows)
+        Overlaps += Intervals.FindOverlapping(Window.first, Window.second).size();
+    float TreeTime = (clock() - start) / CLOCKS_PER_SEC;
+
+    //scanning is linear per query, so only check a sample of the windows against it
+    int Checked = min(NumQueries, 2000);
+    start = clock();
+    for (int i = 0; i < Checked; i++)
+        Matches &= Intervals.FindOverlapping(Windows[i].first, Windows[i].second) == Scan(Windows[i]);
+    float ScanTime = (clock() - start) / CLOCKS_PER_SEC;
+
+    for (int i = 0; i < NumIntervals; i += 2)
+    {
+        Intervals.Delete(Inserted[i].Low, Inserted[i].High);
+        Plain.Delete(Inserted[i]);
+    }
+    Matches &= Intervals.GetSize() == Plain.GetSize();
+    delete[] Sorted;
+    Sorted = Plain.MakeArray();
+    for (int i = 0; i < Checked; i++)
+        Matches &= Intervals.FindOverlapping(Windows[i].first, Windows[i].second) == Scan(Windows[i]);
+    delete[] Sorted;
+
+    cout << "Overlap queries on " << NumIntervals << " intervals: IntervalTree " << NumQueries / TreeTime / 1e3
+         << " Kqueries/s, scan " << Checked / ScanTime / 1e3 << " Kqueries/s, " << Overlaps << " overlaps, "
+         << (Matches ? "matches" : "DOES NOT MATCH") << " RedBlackTree scan" << endl;
+}
+
+/** Subtree summary holding the sum of the keys in a subtree, for range sums with Aggregate */
+struct KeySumSummary
+{
+    typedef long long Value;
+
+    static Value Identity()
+    {
+        return 0;
+    }
+
+    static Value Lift(const int &Key)
+    {
+        return Key;
+    }
+
+    static Value Combine(const Value &Left, const Value &Right)
+    {
+        return Left + Right;
+    }
+};
+
+/**
+ * Sums the keys in random windows with Aggregate on a tree that keeps subtree sums, checking every sum against
+ * adding up the same window of the sorted keys, then deletes half of the keys and checks again
+ * @param NumKeys How many random keys to insert
+ * @param NumQueries How many random windows to sum
+ * @param MaxWidth The widest window; widths are drawn from [0, MaxWidth]
+ * */
+void BenchmarkRangeSums(int NumKeys, int NumQueries, int MaxWidth)
+{
+    RedBlackTree<int, KeySumSummary> Tree;
+    vector<int> Inserted(NumKeys);
+    for (int& Key : Inserted)
+    {
+        Key = rand();
+        Tree.Insert(Key);
+    }
+
+    vector<pair<int, int>> Windows(NumQueries);
+    for (pair<int, int>& Window : Windows)
+    {
+        Window.first = rand() % (RAND_MAX - MaxWidth);
+        Window.second = Window.first + rand() % (MaxWidth + 1);
+    }
+
+    int* Sorted = Tree.MakeArray();
+    auto Recompute = [&Tree, &Sorted](const pair<int, int>& Window)
+    {
+        long long Sum = 0;
+        int* End = Sorted + Tree.GetSize();
+        for (int* Key = lower_bound(Sorted, End, Window.first); Key != End && *Key <= Window.second; Key++)
+            Sum += *Key;
+        return Sum;
+    };
+
+    vector<long long> Sums(NumQueries);
+    float start = clock();
+    for (int i = 0; i < NumQueries; i++)
+        Sums[i] = Tree.Aggregate(Windows[i].first, Windows[i].second);
+    float AggregateTime = (clock() - start) / CLOCKS_PER_SEC;
+
+    bool Matches = true;
+    start = clock();
+    for (int i = 0; i < NumQueries; i++)
+        Matches &= Sums[i] == Recompute(Windows[i]);
+    float RecomputeTime = (clock() - start) / CLOCKS_PER_SEC;
+
+    for (int i = 0; i < NumKeys; i += 2)
+        Tree.Delete(Inserted[i]);
+    delete[] Sorted;
+    Sorted = Tree.MakeArray();
+    for (const pair<int, int>& Window : Windows)
+        Matches &= Tree.Aggregate(Window.first, Window.second) == Recompute(Window);
+    delete[] Sorted;
+
+    cout << "Range sums over " << NumKeys << " keys: Aggregate " << NumQueries / AggregateTime / 1e6
+         << " Mqueries/s, sorted array recompute " << NumQueries / RecomputeTime / 1e6 << " Mqueries/s, "
+         << (Matches ? "matches" : "DOES NOT MATCH") << " recompute" << endl;
+}
+
+/**
+ * Times the ways of getting every key out of a tree in sorted order: MakeArray, exporting into a buffer the caller
+ * already has, streaming fixed-size chunks to a callback, and the parallel export at several thread counts
+ * @param Tree The tree to export
+ * @param ChunkSize How many keys each streamed chunk holds
+ * */
+void BenchmarkExport(const RedBlackTree<int>& Tree, size_t ChunkSize)
+{
+    size_t NumKeys = Tree.GetSize();
+    auto start = chrono::steady_clock::now();
+    int* Arr = Tree.MakeArray();
+    float MakeArrayTime = chrono::duration<float>(chrono::steady_clock::now() - start).count();
+
+    vector<int> Buffer(NumKeys);
+    start = chrono::steady_clock::now();
+    Tree.ExportTo(Buffer.data(), Buffer.size());
+    float ExportTime = chrono::duration<float>(chrono::steady_clock::now() - start).count();
+    bool Matches = equal(Buffer.begin(), Buffer.end(), Arr);
+    delete[] Arr;
+
+    //the chunks are only checked for order, the way a dump to disk would only ever hold one of them
+    start = chrono::steady_clock::now();
+    size_t Streamed = 0;
+    int Last = Buffer.empty() ? 0 : Buffer[0];
+    Tree.ExportChunks(ChunkSize, [&Streamed, &Last, &Matches](const int* Keys, size_t Count)
+    {
+        Matches &= Last <= Keys[0] && is_sorted(Keys, Keys + Count);
+        Last = Keys[Count - 1];
+        Streamed += Count;
+    });
+    float ChunkTime = chrono::duration<float>(chrono::steady_clock::now() - start).count();
+    Matches &= Streamed == NumKeys;
+
+    cout << "Exporting " << NumKeys << " keys: MakeArray " << NumKeys / MakeArrayTime / 1e6 << " Mkeys/s, ExportTo "
+         << NumKeys / ExportTime / 1e6 << " Mkeys/s, ExportChunks of " << ChunkSize << " "
+         << NumKeys / ChunkTime / 1e6 << " Mkeys/s" << endl;
+
+    for (unsigned Threads = 1; Threads <= 8; Threads *= 2)
+    {
+        vector<int> ParallelBuffer(NumKeys);
+        start = chrono::steady_clock::now();
+        Tree.ParallelExportTo(ParallelBuffer.data(), Threads);
+        float ParallelTime = chrono::duration<float>(chrono::steady_clock::now() - start).count();
+        Matches &= ParallelBuffer == Buffer;
+        cout << "    ParallelExportTo, " << Threads << " threads: " << NumKeys / ParallelTime / 1e6 << " Mkeys/s"
+             << endl;
+    }
+    cout << "    every export " << (Matches ? "matches" : "DOES NOT MATCH") << " MakeArray" << endl;
+}
+
+/**
+ * Reads integer keys stored as text, one per line, like RandNums.dat
+ * @param Path The file to read
+ * @return The keys in file order, or no keys if the file cannot be opened
+ * */
+vector<int> ReadKeyFile(const string& Path)
+{
+    vector<int> Keys;
+    ifstream In(Path);
+    int Key;
+    while (In >> Key)
+    {
+        Keys.push_back(Key);
+    }
+    return Keys;
+}
+
+/**
+ * Compares three ways of saving a tree to disk and loading it back: one key per line of text, the raw key array,
+ * and a compressed snapshot. Every write includes walking the tree for its keys; the binary formats are rebuilt in
+ * linear time with AssignSorted, the text one key by key
+ * @param Tree The tree to save
+ * @param Name What the tree holds, for the report
+ * */
+void BenchmarkSnapshots(const RedBlackTree<int>& Tree, const string& Name)
+{
+    size_t NumKeys = Tree.GetSize();
+    vector<int> Keys(NumKeys);
+    Tree.ExportTo(Keys.data(), Keys.size());
+
+    const string TextPath = "Snapshot.txt", RawPath = "Snapshot.raw", CompressedPath = "Snapshot.rbtz";
+    bool Matches = true;
+    auto Check = [&Matches, &Keys](const RedBlackTree<int>& Loaded)
+    {
+        vector<int> LoadedKeys(Loaded.GetSize());
+        Loaded.ExportTo(LoadedKeys.data(), LoadedKeys.size());
+        Matches &= LoadedKeys == Keys;
+    };
+
+    auto start = chrono::steady_clock::now();
+    {
+        ofstream Out(TextPath);
+        Tree.ExportChunks(1 << 16, [&Out](const int* Chunk, size_t Count)
+        {
+            for (size_t i = 0; i < Count; i++)
+            {
+                Out << Chunk[i] << '\n';
+            }
+        });
+    }
+    float TextWrite = chrono::duration<float>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    {
+        RedBlackTree<int> Loaded;
+        for (int Key : ReadKeyFile(TextPath))
+        {
+            Loaded.Insert(Key);
+        }
+        Check(Loaded);
+    }
+    float TextRead = chrono::duration<float>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    {
+        vector<int> RawKeys(NumKeys);
+        Tree.ExportTo(RawKeys.data(), RawKeys.size());
+        ofstream Out(RawPath, ios::binary);
+        Out.write((const char*) RawKeys.data(), NumKeys * sizeof(int));
+    }
+    float RawWrite = chrono::duration<float>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    {
+        ifstream In(RawPath, ios::binary);
+        vector<int> RawKeys(NumKeys);
+        In.read((char*) RawKeys.data(), NumKeys * sizeof(int));
+        RedBlackTree<int> Loaded;
+        Loaded.AssignSorted(RawKeys.data(), RawKeys.size());
+        Check(Loaded);
+    }
+    float RawRead = chrono::duration<float>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    {
+        ofstream Out(CompressedPath, ios::binary);
+        CompressedSnapshot<int>::Save(Tree, Out);
+    }
+    float CompressedWrite = chrono::duration<float>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    {
+        ifstream In(CompressedPath, ios::binary);
+        RedBlackTree<int> Loaded;
+        CompressedSnapshot<int>::Load(In, Loaded);
+        Check(Loaded);
+    }
+    float CompressedRead = chrono::duration<float>(chrono::steady_clock::now() - start).count();
+
+    auto FileSize = [](const string& Path)
+    {
+        ifstream In(Path, ios::binary | ios::ate);
+        return (long long) In.tellg();
+    };
+    long long TextBytes = FileSize(TextPath), RawBytes = FileSize(RawPath), CompressedBytes = FileSize(CompressedPath);
+    remove(TextPath.c_str());
+    remove(RawPath.c_str());
+    remove(CompressedPath.c_str());
+
+    cout << "Snapshots of " << NumKeys << " keys (" << Name << "):" << endl;
+    cout << "    text       " << TextBytes << " bytes, write " << TextWrite * 1000 << " ms, load "
+         << TextRead * 1000 << " ms" << endl;
+    cout << "    raw        " << RawBytes << " bytes, write " << RawWrite * 1000 << " ms, load "
+         << RawRead * 1000 << " ms" << endl;
+    cout << "    compressed " << CompressedBytes << " bytes (" << (double) TextBytes / CompressedBytes << "x smaller "
+         << "than text, " << (double) RawBytes / CompressedBytes << "x smaller than raw), write "
+         << CompressedWrite * 1000 << " ms, load " << CompressedRead * 1000 << " ms" << endl;
+    cout << "    every loaded tree " << (Matches ? "matches" : "DOES NOT MATCH") << " the original" << endl;
+}
+
+/**
+ * Writes random integer keys as text, one per line, in the format of RandNums.dat
+ * @param Path The file to write
+ * @param NumKeys How many keys to write
+ * @param RandRange Keys are drawn from [0, RandRange)
+ * */
+void WriteKeyFile(const string& Path, int NumKeys, int RandRange)
+{
+    ofstream Out(Path);
+    for (int i = 0; i < NumKeys; i++)
+    {
+        Out << rand() % RandRange << '\n';
+    }
+}
+
+/**
+ * Loads a key file into a tree twice: with iostreams and one Insert per key, then with KeyFileLoader
+ * @param Path The file to load
+ * */
+void BenchmarkKeyFileLoad(const string& Path)
+{
+    auto start = chrono::steady_clock::now();
+    RedBlackTree<int> StreamTree;
+    for (int Key : ReadKeyFile(Path))
+    {
+        StreamTree.Insert(Key);
+    }
+    float StreamTime = chrono::duration<float>(chrono::steady_clock::now() - start).count();
+
+    RedBlackTree<int> LoadedTree;
+    KeyFileLoadStats Stats = KeyFileLoader<int>::Load(Path, LoadedTree);
+    double LoadTime = Stats.ParseSeconds + Stats.SortSeconds + Stats.BuildSeconds;
+
+    vector<int> StreamKeys(StreamTree.GetSize()), LoadedKeys(LoadedTree.GetSize());
+    StreamTree.ExportTo(StreamKeys.data(), StreamKeys.size());
+    LoadedTree.ExportTo(LoadedKeys.data(), LoadedKeys.size());
+
+    cout << "Loading " << Path << " (" << Stats.Bytes << " bytes, " << Stats.KeysParsed << " keys, "
+         << Stats.UniqueKeys << " distinct):" << endl;
+    cout << "    iostreams and Insert: " << StreamTime * 1000 << " ms" << endl;
+    cout << "    KeyFileLoader: " << LoadTime * 1000 << " ms (" << StreamTime / LoadTime << "x faster); parse "
+         << Stats.Bytes / Stats.ParseSeconds / 1e6 << " MB/s = " << Stats.KeysParsed / Stats.ParseSeconds / 1e6
+         << " Mkeys/s, sort " << Stats.KeysParsed / Stats.SortSeconds / 1e6 << " Mkeys/s, build "
+         << Stats.UniqueKeys / Stats.BuildSeconds / 1e6 << " Mkeys/s" << endl;
+    cout << "    loaded tree " << (StreamKeys == LoadedKeys ? "matches" : "DOES NOT MATCH") << " the Insert one"
+         << endl;
+}
+
+/** Well known TCP ports, as a lookup table built entirely at compile time */
+constexpr StaticRedBlackTree<int, 16> WellKnownPorts{20, 21, 22, 23, 25, 53, 80, 110, 143, 389, 443, 465, 587, 636,
+                                                     993, 995};
+static_assert(WellKnownPorts.Find(443) && !WellKnownPorts.Find(8080), "the port table is built at compile time");
+
+/**
+ * Times lookups of random ports in the compile-time port table against a RedBlackTree holding the same ports
+ * @param NumQueries How many ports to look up
+ * */
+void BenchmarkStaticTable(int NumQueries)
+{
+    RedBlackTree<int> HeapTable;
+    int Ports[16] = {};
+    WellKnownPorts.ExportTo(Ports, 16);
+    for (int Port : Ports)
+    {
+        HeapTable.Insert(Port);
+    }
+
+    vector<int> Queries(NumQueries);
+    for (int& Query : Queries)
+    {
+        Query = rand() % 1024;
+    }
+
+    float start = clock();
+    int StaticHits = 0;
+    for (int Query : Queries)
+        StaticHits += WellKnownPorts.Find(Query);
+    float StaticTime = (clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    int HeapHits = 0;
+    for (int Query : Queries)
+        HeapHits += HeapTable.Find(Query);
+    float HeapTime = (clock() - start) / CLOCKS_PER_SEC;
+
+    cout << "Port table of " << WellKnownPorts.GetSize() << " keys: StaticRedBlackTree " << sizeof(WellKnownPorts)
+         << " bytes, no allocations, " << NumQueries / StaticTime / 1e6 << " Mops/s; RedBlackTree "
+         << HeapTable.GetMemoryUsage().TotalBytes() << " bytes on the heap, " << NumQueries / HeapTime / 1e6
+         << " Mops/s; hits " << (StaticHits == HeapHits ? "match" : "DO NOT MATCH") << endl;
+}
+
+/**
+ * Times building and tearing down many small, short-lived trees, the way a server would build one per request:
+ * nodes from the global heap, from a monotonic buffer that is released wholesale after each tree, and from a pool
+ * @param NumTrees How many trees to build
+ * @param KeysPerTree How many random keys each tree holds
+ * */
+void BenchmarkTreeAllocators(int NumTrees, int KeysPerTree)
+{
+    vector<int> Keys(KeysPerTree);
+    for (int& Key : Keys)
+    {
+        Key = rand();
+    }
+
+    typedef RedBlackTree<int, NoSummary, pmr::polymorphic_allocator<int>> PmrTree;
+    size_t Checksum[3] = {0, 0, 0};
+
+    float start = clock();
+    for (int i = 0; i < NumTrees; i++)
+    {
+        RedBlackTree<int> Tree;
+        for (int Key : Keys)
+            Tree.Insert(Key);
+        Checksum[0] += Tree.GetSize();
+    }
+    float HeapTime = (clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    vector<char> Buffer(KeysPerTree * 64);
+    for (int i = 0; i < NumTrees; i++)
+    {
+        pmr::monotonic_buffer_resource Arena(Buffer.data(), Buffer.size());
+        PmrTree Tree(&Arena);
+        for (int Key : Keys)
+            Tree.Insert(Key);
+        Checksum[1] += Tree.GetSize();
+    }
+    float ArenaTime = (clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    pmr::unsynchronized_pool_resource Pool;
+    for (int i = 0; i < NumTrees; i++)
+    {
+        PmrTree Tree(&Pool);
+        for (int Key : Keys)
+            Tree.Insert(Key);
+        Checksum[2] += Tree.GetSize();
+    }
+    float PoolTime = (clock() - start) / CLOCKS_PER_SEC;
+
+    cout << NumTrees << " short-lived trees of " << KeysPerTree << " keys: new/delete "
+         << NumTrees / HeapTime / 1e3 << " Ktrees/s, monotonic buffer " << NumTrees / ArenaTime / 1e3
+         << " Ktrees/s, pool " << NumTrees / PoolTime / 1e3 << " Ktrees/s; sizes "
+         << (Checksum[0] == Checksum[1] && Checksum[1] == Checksum[2] ? "match" : "DO NOT MATCH") << endl;
+}
+
+/**
+ * Runs long string keys through the tree, where every key copy is a heap allocation and a memcpy
+ * @param NumKeys How many random keys to run through the tree
+ * @param KeyLength Length of every key; the random part is padded on the left up to this length
+ * */
+void BenchmarkLargeKeys(int NumKeys, int KeyLength)
+{
+    vector<string> Keys(NumKeys);
+    for (string& Key : Keys)
+    {
+        string Digits = to_string(rand());
+        Key = string(KeyLength - Digits.size(), '0') + Digits;
+    }
+
+    RedBlackTree<string> Tree;
+    BenchmarkTree(Tree, "RedBlackTree<string> (" + to_string(KeyLength) + " byte keys)", Keys, sizeof(Node<string>));
+}
+
+
+/**
+ * Retires half of the keys of a tree of long string keys into an archive tree and then merges them back, once by
+ * copying every key (Find, Insert, Delete) and once by moving the nodes themselves (Extract, Insert and Merge)
+ * @param NumKeys How many random keys the live tree starts with
+ * @param KeyLength Length of every key; long enough that each key owns a heap buffer
+ * */
+void BenchmarkNodeHandles(int NumKeys, int KeyLength)
+{
+    vector<string> Keys(NumKeys);
+    for (string& Key : Keys)
+    {
+        string Digits = to_string(rand());
+        Key = string(KeyLength - Digits.size(), '0') + Digits;
+    }
+
+    RedBlackTree<string> CopyLive, CopyArchive, MoveLive, MoveArchive;
+    for (const string& Key : Keys)
+    {
+        CopyLive.Insert(Key);
+        MoveLive.Insert(Key);
+    }
+
+    float start = clock();
+    for (int i = 0; i < NumKeys; i += 2)
+    {
+        if (CopyLive.Find(Keys[i]))
+        {
+            CopyArchive.Insert(Keys[i]);
+            CopyLive.Delete(Keys[i]);
+        }
+    }
+    size_t CopyArchived = CopyArchive.GetSize();
+    for (int i = 0; i < NumKeys; i += 2)
+    {
+        if (CopyArchive.Find(Keys[i]))
+        {
+            CopyLive.Insert(Keys[i]);
+            CopyArchive.Delete(Keys[i]);
+        }
+    }
+    float CopyTime = (clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (int i = 0; i < NumKeys; i += 2)
+    {
+        RedBlackTree<string>::NodeHandle Handle = MoveLive.Extract(Keys[i]);
+        if (Handle)
+        {
+            MoveArchive.Insert(std::move(Handle));
+        }
+    }
+    size_t MoveArchived = MoveArchive.GetSize();
+    MoveLive.Merge(MoveArchive);
+    float MoveTime = (clock() - start) / CLOCKS_PER_SEC;
+
+    cout << "Retiring and restoring " << CopyArchived << " " << KeyLength << " byte keys: copying "
+         << CopyTime << " seconds, moving nodes " << MoveTime << " seconds (" << CopyTime / MoveTime
+         << "x faster); trees " << (CopyArchived == MoveArchived && CopyLive.GetSize() == MoveLive.GetSize() &&
+                                    MoveArchive.GetSize() == 0 ? "match" : "DO NOT MATCH") << endl;
+}
+
+/**
+ * Shows what a tree of string keys really holds compared to the usual sizeof(Node) estimate, then fills a tree
+ * under a memory budget until Insert refuses to grow it further
+ * @param NumKeys How many random keys to insert
+ * @param KeyLength Length of every key; long enough that each key owns a heap buffer
+ * @param BudgetBytes The memory budget of the second tree
+ * */
+void DemoMemoryAccounting(int NumKeys, int KeyLength, size_t BudgetBytes)
+{
+    auto RandomKey = [KeyLength]()
+    {
+        string Digits = to_string(rand());
+        return string(KeyLength - Digits.size(), '0') + Digits;
+    };
+
+    //drop the lower half of the keys again, which leaves freed nodes behind
+    RedBlackTree<string> Tree;
+    for (int i = 0; i < NumKeys; i++)
+    {
+        Tree.Insert(RandomKey());
+    }
+    Tree.EraseRange(string(KeyLength, '0'), string(KeyLength - 10, '0') + to_string(RAND_MAX / 2));
+
+    TreeMemoryUsage Usage = Tree.GetMemoryUsage();
+    cout << "Memory of " << Usage.Nodes << " " << KeyLength << " byte string keys: nodes " << Usage.NodeBytes
+         << " bytes, allocator overhead " << Usage.AllocatorOverheadBytes << ", key buffers " << Usage.KeyHeapBytes
+         << ", total " << Usage.TotalBytes() << " (" << (double) Usage.TotalBytes() / Usage.NodeBytes
+         << "x the sizeof(Node) estimate), plus " << Usage.FreedNodeBytes << " bytes of freed nodes" << endl;
+
+    RedBlackTree<string> Budgeted;
+    Budgeted.SetMemoryBudget(BudgetBytes);
+    try
+    {
+        while (true)
+        {
+            Budgeted.Insert(RandomKey());
+        }
+    }
+    catch (const length_error& Error)
+    {
+        cout << "    a " << BudgetBytes << " byte budget stopped Insert at " << Budgeted.GetSize() << " keys, "
+             << Budgeted.GetMemoryUsage().TotalBytes() << " bytes: " << Error.what() << endl;
+    }
+}
+
+/**
+ * Runs random inserts and deletes through the concurrent tree from several threads at once, then checks the result
+ * against a red black tree that replays the same operations on a single thread
+ * Every thread works on its own residue class of keys, so the final set does not depend on how the threads interleave
+ * @param NumThreads How many threads update the tree at once
+ * @param OpsPerThread How many inserts and deletes each thread runs
+ * @param RandRange The interval for which the keys are drawn; interval is [0, RandRange)
+ * */
+void StressConcurrentTree(int NumThreads, int OpsPerThread, int RandRange)
+{
+    //each operation is a key and whether to insert or delete it; two thirds are inserts so the tree grows
+    vector<vector<pair<int, bool>>> Ops(NumThreads, vector<pair<int, bool>>(OpsPerThread));
+    for (int t = 0; t < NumThreads; t++)
+        for (pair<int, bool>& Op : Ops[t])
+            Op = make_pair(rand() % RandRange / NumThreads * NumThreads + t, rand() % 3 != 0);
+
+    ConcurrentChromaticTree<int> Tree;
+    auto start = chrono::steady_clock::now();
+
+    vector<thread> Workers;
+    for (int t = 0; t < NumThreads; t++)
+    {
+        Workers.emplace_back([&Tree, &Ops, t]()
+        {
+            for (const pair<int, bool>& Op : Ops[t])
+            {
+                if (Op.second)
+                    Tree.Insert(Op.first);
+                else
+                    Tree.Delete(Op.first);
+            }
+        });
+    }
+    for (thread& Worker : Workers)
+        Worker.join();
+
+    float Seconds = chrono::duration<float>(chrono::steady_clock::now() - start).count();
+
+    RedBlackTree<int> Oracle;
+    for (int t = 0; t < NumThreads; t++)
+    {
+        for (const pair<int, bool>& Op : Ops[t])
+        {
+            if (Op.second)
+                Oracle.Insert(Op.first);
+            else
+                Oracle.Delete(Op.first);
+        }
+    }
+
+    bool Matches = Tree.GetSize() == Oracle.GetSize() && Tree.CountViolations() == 0;
+    if (Matches)
+    {
+        int* TreeKeys = Tree.MakeArray();
+        int* OracleKeys = Oracle.MakeArray();
+        Matches = equal(TreeKeys, TreeKeys + Tree.GetSize(), OracleKeys);
+        delete[] TreeKeys;
+        delete[] OracleKeys;
+    }
+
+    cout << "ConcurrentChromaticTree, " << NumThreads << " threads: "
+         << (double) NumThreads * OpsPerThread / Seconds / 1e6 << " Mops/s, height " << Tree.GetHeight() << ", "
+         << Tree.GetRetiredCount() << " replaced nodes awaiting reclamation, "
+         << (Matches ? "matches" : "DOES NOT MATCH") << " RedBlackTree" << endl;
+}
+
+
+/**
+ * Runs the same operations on a tree from several threads at once and reports the throughput
+ * @param NumThreads How many threads run operations at once
+ * @param Ops Each thread's operations: a key, and 0 to find, 1 to insert or 2 to delete it
+ * @param Apply Called as Apply(Key, Operation) to run one operation on the tree
+ * @return The number of seconds taken
+ * */
+template<class ApplyType>
+float TimeContendedOps(int NumThreads, const vector<vector<pair<int, int>>>& Ops, ApplyType Apply)
+{
+    auto start = chrono::steady_clock::now();
+    vector<thread> Workers;
+    for (int t = 0; t < NumThreads; t++)
+    {
+        Workers.emplace_back([&Ops, &Apply, t]()
+        {
+            for (const pair<int, int>& Op : Ops[t])
+                Apply(Op.first, Op.second);
+        });
+    }
+    for (thread& Worker : Workers)
+        Worker.join();
+    return chrono::duration<float>(chrono::steady_clock::now() - start).count();
+}
+
+
+/**
+ * Compares a red black tree behind one mutex against the flat combining tree, with every thread hammering the same
+ * small tree: half of the operations are finds and the rest are split evenly between inserts and deletes
+ * @param NumThreads How many threads run operations at once
+ * @param TotalOps How many operations all threads run between them
+ * @param RandRange The interval for which the keys are drawn; interval is [0, RandRange)
+ * */
+void BenchmarkContention(int NumThreads, int TotalOps, int RandRange)
+{
+    vector<vector<pair<int, int>>> Ops(NumThreads, vector<pair<int, int>>(TotalOps / NumThreads));
+    for (vector<pair<int, int>>& ThreadOps : Ops)
+        for (pair<int, int>& Op : ThreadOps)
+            Op = make_pair(rand() % RandRange, rand() % 4 == 0 ? 1 : rand() % 3 == 0 ? 2 : 0);
+
+    RedBlackTree<int> LockedTree;
+    FlatCombiningRedBlackTree<int> CombinedTree;
+    for (int i = 0; i < RandRange; i += 2)
+    {
+        LockedTree.Insert(i);
+        CombinedTree.Insert(i);
+    }
+
+    mutex TreeLock;
+    float MutexSeconds = TimeContendedOps(NumThreads, Ops, [&LockedTree, &TreeLock](int Key, int Op)
+    {
+        lock_guard<mutex> Guard(TreeLock);
+        if (Op == 1)
+            LockedTree.Insert(Key);
+        else if (Op == 2)
+            LockedTree.Delete(Key);
+        else
+            LockedTree.Find(Key);
+    });
+
+    float CombinedSeconds = TimeContendedOps(NumThreads, Ops, [&CombinedTree](int Key, int Op)
+    {
+        if (Op == 1)
+            CombinedTree.Insert(Key);
+        else if (Op == 2)
+            CombinedTree.Delete(Key);
+        else
+            CombinedTree.Find(Key);
+    });
+
+    cout << setw(2) << NumThreads << " threads: mutex " << TotalOps / MutexSeconds / 1e6 << " Mops/s, "
+         << "flat combining " << TotalOps / CombinedSeconds / 1e6 << " Mops/s, "
+         << CombinedTree.GetAverageBatchSize() << " operations per batch" << endl;
+}
+
+
+/**
+ * Prints how many keys each shard of a sharded tree holds
+ * @param Tree The tree to describe
+ * @param Label Printed before the shard sizes
+ * */
+void PrintShardSizes(const ShardedRedBlackTree<int>& Tree, const string& Label)
+{
+    cout << "    " << Label << ":";
+    for (size_t i = 0; i < Tree.GetShardCount(); i++)
+        cout << " " << Tree.GetShardSize(i);
+    cout << endl;
+}
+
+/**
+ * Inserts keys drawn from a growing range into a sharded tree from several threads, like the main workload,
+ * and shows RebalanceShards moving the boundaries after the keys as they drift upwards
+ * @param NumThreads How many threads insert at once
+ * @param NumShards How many shards the tree has; they start out splitting the first round's range evenly
+ * @param NumEntriesToAdd How many entries each round adds to the tree
+ * */
+void DemoShardedTree(int NumThreads, int NumShards, int NumEntriesToAdd)
+{
+    vector<int> Boundaries;
+    for (int i = 1; i < NumShards; i++)
+        Boundaries.push_back(10000000 / NumShards * i);
+    ShardedRedBlackTree<int> Tree(Boundaries);
+
+    for (int Round = 0; Round < 5; Round++)
+    {
+        int RandRange = 10000000 * (Round + 1);
+        vector<vector<int>> Keys(NumThreads, vector<int>(NumEntriesToAdd / NumThreads));
+        for (vector<int>& ThreadKeys : Keys)
+            for (int& Key : ThreadKeys)
+                Key = rand() % RandRange;
+
+        auto start = chrono::steady_clock::now();
+        vector<thread> Workers;
+        for (int t = 0; t < NumThreads; t++)
+        {
+            Workers.emplace_back([&Tree, &Keys, t]()
+            {
+                for (int Key : Keys[t])
+                    Tree.Insert(Key);
+            });
+        }
+        for (thread& Worker : Workers)
+            Worker.join();
+        float Seconds = chrono::duration<float>(chrono::steady_clock::now() - start).count();
+
+        cout << "ShardedRedBlackTree, " << NumThreads << " threads, keys in [0, " << RandRange << "): "
+             << NumEntriesToAdd / Seconds / 1e6 << " Mops/s" << endl;
+        PrintShardSizes(Tree, "shard sizes");
+
+        start = chrono::steady_clock::now();
+        Tree.RebalanceShards();
+        Seconds = chrono::duration<float>(chrono::steady_clock::now() - start).count();
+        PrintShardSizes(Tree, "after rebalancing in " + to_string(Seconds) + "s");
+    }
+}
+
 
 int main()
 {
-    srand(time(0));
+    unsigned int Seed = time(0);
+    srand(Seed);
 
     cout << fixed << setprecision(10);
 
@@ -43,5 +1342,70 @@ int main()
     cout << RBTree.GetSize() << endl;
     cout << RBTree.GetHeight() << " " << RBTree.GetBlackHeight() << endl;
 
+    BenchmarkExport(RBTree, 1 << 16);
+    BenchmarkSnapshots(RBTree, "random keys");
+
+    vector<int> FileKeys = ReadKeyFile("RandNums.dat");
+    if (FileKeys.empty())
+    {
+        cout << "RandNums.dat not found, skipping its snapshot" << endl;
+    }
+    else
+    {
+        RedBlackTree<int> FileTree;
+        for (int Key : FileKeys)
+        {
+            FileTree.Insert(Key);
+        }
+        BenchmarkSnapshots(FileTree, "RandNums.dat");
+    }
+
+    if (!FileKeys.empty())
+    {
+        BenchmarkKeyFileLoad("RandNums.dat");
+    }
+    WriteKeyFile("Keys.txt", 5000000, 1 << 30);
+    BenchmarkKeyFileLoad("Keys.txt");
+    remove("Keys.txt");
+
+    //run the same keys through the B-tree
+    srand(Seed);
+    BTree<int> WideTree;
+
+    for(int i = 0; i < 5; i++)
+        InsertIntoTree(WideTree, 1000000, 10000000 * (i + 1));
+
+    cout << "Minimum element: " << WideTree.FindMin() << endl;
+    cout << "Maximum element: " << WideTree.FindMax() << endl;
+
+    cout << WideTree.GetSize() << endl;
+    cout << WideTree.GetHeight() << endl;
+
+    CompareTreeVariants(1000000, 10000000);
+    BenchmarkEraseRange(1000000, 1000);
+    BenchmarkEraseRange(1000000, 100000);
+    BenchmarkLargeKeys(200000, 256);
+    BenchmarkNodeHandles(200000, 256);
+    DemoMemoryAccounting(200000, 256, 16 << 20);
+    BenchmarkStaticTable(10000000);
+    BenchmarkTreeAllocators(100000, 64);
+    BenchmarkBufferedIngest(2000000, 1000000, 1 << 30);
+    BenchmarkSkewedFinds(1000000, 2000000, 0);
+    BenchmarkSkewedFinds(1000000, 2000000, 0.99);
+    BenchmarkSkewedFinds(1000000, 2000000, 1.2);
+    BenchmarkSchedulerQueue(100000, 1000000);
+    BenchmarkNearestQueries(1000000, 1000000, 8);
+    BenchmarkIntervalQueries(200000, 200000, 1 << 20);
+    BenchmarkRangeSums(1000000, 200000, 1 << 26);
+    DemoIntrusiveTree(1000000);
+
+    for (int Threads = 1; Threads <= 8; Threads *= 2)
+        StressConcurrentTree(Threads, 1000000 / Threads, 10000000);
+
+    DemoShardedTree(4, 8, 1000000);
+
+    for (int Threads = 1; Threads <= 64; Threads *= 2)
+        BenchmarkContention(Threads, 1000000, 1 << 16);
+
     return 0;
 }
\ No newline at end of file